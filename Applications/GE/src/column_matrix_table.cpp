@@ -3,6 +3,7 @@
 #include <multiverso/multiverso.h>
 #include <multiverso/util/log.h>
 #include <multiverso/updater/updater.h>
+#include <multiverso/util/key_codec.h>
 #include <multiverso/io/io.h>
 #include "column_matrix_table.h"
 #include "util.h"
@@ -11,6 +12,51 @@ namespace graphembedding {
 
 enum class Op { GET, DOTPROD, ADJUST };
 
+// Set in the op slot when the id arrays are delta + varint encoded. Each
+// encoded array is prefixed by its size in bytes.
+const int kEncodedIds = 1 << 8;
+
+namespace {
+
+// Bytes taken by ids in a request, encoded is filled if encode is set
+size_t IdsSize(const std::vector<integer>& ids, bool encode, bool sorted,
+        std::vector<char>* encoded) {
+    if (!encode) return ids.size() * sizeof(integer);
+    encoded->resize(multiverso::key_codec::MaxEncodedSize<integer>(ids.size()));
+    encoded->resize(multiverso::key_codec::Encode(ids.data(), ids.size(),
+        sorted, encoded->data()));
+    return sizeof(integer) + encoded->size();
+}
+
+char* WriteIds(const std::vector<integer>& ids, bool encode,
+        const std::vector<char>& encoded, char* data) {
+    if (!encode) {
+        memcpy(data, ids.data(), ids.size() * sizeof(integer));
+        return data + ids.size() * sizeof(integer);
+    }
+    reinterpret_cast<integer*>(data)[0] = (integer)encoded.size();
+    data += sizeof(integer);
+    memcpy(data, encoded.data(), encoded.size());
+    return data + encoded.size();
+}
+
+// Points ids to count ids at data, decoding into buffer if needed
+char* ReadIds(char* data, int count, bool encode, bool sorted,
+        std::vector<integer>* buffer, integer** ids) {
+    if (!encode) {
+        *ids = reinterpret_cast<integer*>(data);
+        return data + count * sizeof(integer);
+    }
+    integer size = reinterpret_cast<integer*>(data)[0];
+    data += sizeof(integer);
+    buffer->resize(count);
+    multiverso::key_codec::Decode(data, count, sorted, buffer->data());
+    *ids = buffer->data();
+    return data + size;
+}
+
+}  // namespace
+
 template<typename T>
 ColumnMatrixWorkerTable<T>::ColumnMatrixWorkerTable(
         const ColumnMatrixTableOption<T>& option) : WorkerTable() {
@@ -18,6 +64,7 @@ ColumnMatrixWorkerTable<T>::ColumnMatrixWorkerTable(
     num_servers_ = multiverso::MV_NumServers();
     rank_ = multiverso::MV_Rank();
     worker_id_ = multiverso::MV_WorkerId();
+    encode_ids_ = option.encode_ids;
 }
 
 template<typename T>
@@ -29,24 +76,26 @@ DotProdResult* ColumnMatrixWorkerTable<T>::DotProd(DotProdParam* param) {
     assert(param->src.size() == param->dst.size());
     int num_edges = param->src.size();
 
-    Blob blob(sizeof(integer) * 2 + num_edges * sizeof(integer) * 2);
+    size_t blob_size = sizeof(integer) * 2;
+    blob_size += IdsSize(param->src, encode_ids_, false, &encoded_[0]);
+    blob_size += IdsSize(param->dst, encode_ids_, false, &encoded_[1]);
+    Blob blob(blob_size);
     char* data = blob.data();
     dotprod_result_ = new DotProdResult();
     dotprod_result_->scale.resize(num_edges, 0);
 
-    reinterpret_cast<integer*>(data)[0] = (int)Op::DOTPROD;
+    reinterpret_cast<integer*>(data)[0] = (int)Op::DOTPROD |
+        (encode_ids_ ? kEncodedIds : 0);
     data += sizeof(integer);
 
     reinterpret_cast<integer*>(data)[0] = num_edges;
     data += sizeof(integer);
 
-    memcpy(data, param->src.data(), num_edges * sizeof(integer));
-    data += num_edges * sizeof(integer);
-
-    memcpy(data, param->dst.data(), num_edges * sizeof(integer));
+    data = WriteIds(param->src, encode_ids_, encoded_[0], data);
+    data = WriteIds(param->dst, encode_ids_, encoded_[1], data);
 
     WorkerTable::Get(blob, NULL);
-    multiverso::Log::Debug("[DotProd] Rank %d (Worker = %d), num_edges = %d\n",
+    MV_LOG_DEBUG("[DotProd] Rank %d (Worker = %d), num_edges = %d\n",
         rank_, worker_id_, num_edges);
     return dotprod_result_;
 }
@@ -61,12 +110,16 @@ void ColumnMatrixWorkerTable<T>::Adjust(AdjustParam* param) {
     int num_dst_unique = param->dst_unique.size();
 
     size_t blob_size = sizeof(integer) * 4;
-    blob_size += (2 * sizeof(integer) + sizeof(real)) * num_edges;
-    blob_size += sizeof(integer) * (num_src_unique + num_dst_unique);
+    blob_size += IdsSize(param->src, encode_ids_, false, &encoded_[0]);
+    blob_size += IdsSize(param->dst, encode_ids_, false, &encoded_[1]);
+    blob_size += sizeof(real) * num_edges;
+    blob_size += IdsSize(param->src_unique, encode_ids_, true, &encoded_[2]);
+    blob_size += IdsSize(param->dst_unique, encode_ids_, true, &encoded_[3]);
     Blob blob(blob_size);
     char* data = blob.data();
 
-    reinterpret_cast<integer*>(data)[0] = (int)Op::ADJUST;
+    reinterpret_cast<integer*>(data)[0] = (int)Op::ADJUST |
+        (encode_ids_ ? kEncodedIds : 0);
     data += sizeof(integer);
 
     reinterpret_cast<integer*>(data)[0] = num_edges;
@@ -78,23 +131,17 @@ void ColumnMatrixWorkerTable<T>::Adjust(AdjustParam* param) {
     reinterpret_cast<integer*>(data)[0] = num_dst_unique;
     data += sizeof(integer);
 
-    memcpy(data, param->src.data(), num_edges * sizeof(integer));
-    data += num_edges * sizeof(integer);
-
-    memcpy(data, param->dst.data(), num_edges * sizeof(integer));
-    data += num_edges * sizeof(integer);
+    data = WriteIds(param->src, encode_ids_, encoded_[0], data);
+    data = WriteIds(param->dst, encode_ids_, encoded_[1], data);
 
     memcpy(data, param->scale.data(), num_edges * sizeof(real));
     data += num_edges * sizeof(real);
 
-    memcpy(data, param->src_unique.data(), num_src_unique * sizeof(integer));
-    data += num_src_unique * sizeof(integer);
-
-    memcpy(data, param->dst_unique.data(), num_dst_unique * sizeof(integer));
-    data += num_dst_unique * sizeof(integer);
+    data = WriteIds(param->src_unique, encode_ids_, encoded_[2], data);
+    data = WriteIds(param->dst_unique, encode_ids_, encoded_[3], data);
 
     WorkerTable::Get(blob, NULL);
-    multiverso::Log::Debug("[Adjust] Rank %d (Worker = %d), num_edges = %d\n",
+    MV_LOG_DEBUG("[Adjust] Rank %d (Worker = %d), num_edges = %d\n",
         rank_, worker_id_, num_edges);
 }
 
@@ -106,19 +153,21 @@ GetResult* ColumnMatrixWorkerTable<T>::Get(GetParam* param) {
     get_result_ = new GetResult();
     get_result_->W.resize(size_t(num_nodes) * num_cols_);
 
-    Blob blob( sizeof(integer) * 2 + num_nodes * sizeof(integer));
+    Blob blob(sizeof(integer) * 2 +
+        IdsSize(param->src, encode_ids_, false, &encoded_[0]));
     char* data = blob.data();
 
-    reinterpret_cast<integer*>(data)[0] = (int)Op::GET;
+    reinterpret_cast<integer*>(data)[0] = (int)Op::GET |
+        (encode_ids_ ? kEncodedIds : 0);
     data += sizeof(integer);
 
     reinterpret_cast<integer*>(data)[0] = num_nodes;
     data += sizeof(integer);
 
-    memcpy(data, param->src.data(), num_nodes * sizeof(integer));
+    WriteIds(param->src, encode_ids_, encoded_[0], data);
     
     WorkerTable::Get(blob, NULL);
-    multiverso::Log::Debug("[Get] Rank %d (Worker = %d), num_nodes = %d\n",
+    MV_LOG_DEBUG("[Get] Rank %d (Worker = %d), num_nodes = %d\n",
         rank_, worker_id_, num_nodes);
 
     return get_result_;
@@ -151,10 +200,10 @@ void ColumnMatrixWorkerTable<T>::ProcessReplyGet(std::vector<Blob>& reply_data)
     if (type == (int)Op::DOTPROD) {
         real* scale = reinterpret_cast<real*>(data);
         for (int i = 0; i < num_edges; ++ i) dotprod_result_->scale[i] += scale[i]; 
-        multiverso::Log::Debug("[ProcessDotProd] Rank %d (Worker %d), "
+        MV_LOG_DEBUG("[ProcessDotProd] Rank %d (Worker %d), "
             "#num_edges = %lld\n", rank_, worker_id_, num_edges);
     } else if (type == (int)Op::ADJUST) {
-        multiverso::Log::Debug("[ProcessAdjust] Rank %d (Worker %d), "
+        MV_LOG_DEBUG("[ProcessAdjust] Rank %d (Worker %d), "
             "#num_edges = %lld\n", rank_, worker_id_, num_edges);
     } else if (type == (int)Op::GET) {
         int server_offset = reinterpret_cast<int*>(data)[0];
@@ -170,7 +219,7 @@ void ColumnMatrixWorkerTable<T>::ProcessReplyGet(std::vector<Blob>& reply_data)
             size_t dst_offset = i * num_cols_ + server_offset;
             memcpy(W1 + dst_offset, W2 + src_offset, server_cols * sizeof(real));
         }
-        multiverso::Log::Debug("[ProcessGet] Rank %d (Worker %d), "
+        MV_LOG_DEBUG("[ProcessGet] Rank %d (Worker %d), "
             "#num_nodes = %lld\n", rank_, worker_id_, num_edges);
     }
 }
@@ -224,14 +273,16 @@ void ColumnMatrixServerTable<T>::ProcessGet(
 
     int type = reinterpret_cast<integer*>(data)[0];
     data += sizeof(integer);
+    bool encoded = (type & kEncodedIds) != 0;
+    type &= ~kEncodedIds;
 
     int num_edges = reinterpret_cast<integer*>(data)[0];
     data += sizeof(integer);
 
     if (type == (int)Op::DOTPROD) {
-        integer* src = reinterpret_cast<integer*>(data);
-        data += num_edges * sizeof(integer);
-        integer* dst = reinterpret_cast<integer*>(data);
+        integer *src, *dst;
+        data = ReadIds(data, num_edges, encoded, false, &ids_[0], &src);
+        data = ReadIds(data, num_edges, encoded, false, &ids_[1], &dst);
         
         result->push_back(Blob(2 * sizeof(integer) + num_edges * sizeof(real)));
         char* result_data = result->at(0).data();
@@ -252,7 +303,7 @@ void ColumnMatrixServerTable<T>::ProcessGet(
                scale[i] += W_IN_[src_offset + j] * W_OUT_[dst_offset + j];
             }
         }
-        multiverso::Log::Debug("[ProcessDotProd] Rank %d (Server %d), #num_edges=%d\n",
+        MV_LOG_DEBUG("[ProcessDotProd] Rank %d (Server %d), #num_edges=%d\n",
             rank_, server_id_, num_edges);
     } else if (type == (int)Op::ADJUST) {
         int num_src_unique = reinterpret_cast<integer*>(data)[0];
@@ -261,20 +312,15 @@ void ColumnMatrixServerTable<T>::ProcessGet(
         int num_dst_unique = reinterpret_cast<integer*>(data)[0];
         data += sizeof(int);
 
-        integer* src = reinterpret_cast<integer*>(data);
-        data += num_edges * sizeof(integer);
-
-        integer* dst = reinterpret_cast<integer*>(data);
-        data += num_edges * sizeof(integer);
+        integer *src, *dst, *src_unique, *dst_unique;
+        data = ReadIds(data, num_edges, encoded, false, &ids_[0], &src);
+        data = ReadIds(data, num_edges, encoded, false, &ids_[1], &dst);
 
         real* scale = reinterpret_cast<real*>(data);
         data += num_edges * sizeof(real);
 
-        integer* src_unique = reinterpret_cast<integer*>(data);
-        data += num_src_unique * sizeof(integer);
-
-        integer* dst_unique = reinterpret_cast<integer*>(data);
-        data += num_dst_unique * sizeof(integer);
+        data = ReadIds(data, num_src_unique, encoded, true, &ids_[2], &src_unique);
+        data = ReadIds(data, num_dst_unique, encoded, true, &ids_[3], &dst_unique);
 
         #pragma omp parallel for num_threads(num_threads_)
         for (int i = 0; i < num_edges; ++ i) {
@@ -308,7 +354,7 @@ void ColumnMatrixServerTable<T>::ProcessGet(
         void* result_data = result->at(0).data();
         reinterpret_cast<integer*>(result_data)[0] = (int)Op::ADJUST;
         reinterpret_cast<integer*>(result_data)[1] = num_edges;
-        multiverso::Log::Debug("[ProcessAdjust] Rank %d (Server %d), #num_edges=%d\n",
+        MV_LOG_DEBUG("[ProcessAdjust] Rank %d (Server %d), #num_edges=%d\n",
             rank_, server_id_, num_edges);
     } else if (type == (int)Op::GET) {
         result->push_back(Blob(4 * sizeof(integer) + sizeof(real) * num_edges * num_cols_local_));
@@ -326,7 +372,8 @@ void ColumnMatrixServerTable<T>::ProcessGet(
         reinterpret_cast<integer*>(result_data)[0] = num_cols_local_;
         result_data += sizeof(integer);
 
-        integer* src = reinterpret_cast<integer*>(data);
+        integer* src;
+        ReadIds(data, num_edges, encoded, false, &ids_[0], &src);
         real* W_dst = reinterpret_cast<real*>(result_data);
         real* W_src = reinterpret_cast<real*>(W_IN_.data());
         #pragma omp parallel for num_threads(num_threads_)
@@ -64,6 +64,8 @@ private:
     int num_cols_;
     DotProdResult* dotprod_result_;
     GetResult* get_result_;
+    bool encode_ids_;
+    std::vector<char> encoded_[4];
 };
 
 template<typename T>
@@ -90,6 +92,7 @@ private:
     int num_servers_, rank_, server_id_, num_threads_;
     std::vector<T> W_IN_, W_OUT_;
     std::vector<T> DW_IN_, DW_OUT_;
+    std::vector<integer> ids_[4];  // decoded ids of requests
 };
 
 template<typename T>
@@ -98,8 +101,11 @@ struct ColumnMatrixTableOption {
     int num_cols;
     T min_val, max_val;
     int threads;
-    ColumnMatrixTableOption(integer r, int c, T min_v, T max_v, int t)
-        : num_rows(r), num_cols(c), min_val(min_v), max_val(max_v), threads(t) {}
+    bool encode_ids;  // delta + varint encode id arrays on the wire
+    ColumnMatrixTableOption(integer r, int c, T min_v, T max_v, int t,
+        bool encode = false)
+        : num_rows(r), num_cols(c), min_val(min_v), max_val(max_v), threads(t),
+          encode_ids(encode) {}
     DEFINE_TABLE_TYPE(T, ColumnMatrixWorkerTable, ColumnMatrixServerTable);
 };
 
@@ -49,7 +49,8 @@ void Model::Init() {
     int col = option_->embedding_size;
     int num_threads = option_->server_threads;
     table_ = multiverso::MV_CreateTable(ColumnMatrixTableOption<real>(
-                row, col, (real)-.5 / col, (real).5 / col, num_threads));
+                row, col, (real)-.5 / col, (real).5 / col, num_threads,
+                option_->encode_ids));
     if (worker_id_ != -1) {
         graph_partition_ = new (std::nothrow)GraphPartition(option_);
         assert(graph_partition_ != NULL);
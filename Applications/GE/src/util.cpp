@@ -24,6 +24,7 @@ Option::Option() {
     display_iter = 1;
     server_threads = 1;
     debug = false;
+    encode_ids = false;
 }
 
 void Option::ParseArgs(int argc, char* argv[]) {
@@ -44,6 +45,7 @@ void Option::ParseArgs(int argc, char* argv[]) {
         if (strcmp(argv[i], "-display_iter") == 0) display_iter = atof(argv[i + 1]);
         if (strcmp(argv[i], "-server_threads") == 0) server_threads = atoi(argv[i + 1]);
         if (strcmp(argv[i], "-debug") == 0) debug = atoi(argv[i + 1]);
+        if (strcmp(argv[i], "-encode_ids") == 0) encode_ids = atoi(argv[i + 1]);
     }
 }
 
@@ -62,6 +64,7 @@ void Option::PrintUsage() {
     puts("-display_iter: display iteration");
     puts("-server_threads: number of computation threads in server");
     puts("-debug: open debug log when setting this nonzero");
+    puts("-encode_ids: delta + varint encode node ids sent to servers when setting this nonzero");
 }
 
 void Option::PrintArgs() {
@@ -79,6 +82,7 @@ void Option::PrintArgs() {
     multiverso::Log::Info("\tdisplay_iter: %f\n", display_iter);
     multiverso::Log::Info("\tserver_threads: %d\n", server_threads);
     multiverso::Log::Info("\tdebug: %d\n", debug);
+    multiverso::Log::Info("\tencode_ids: %d\n", encode_ids);
 }
 
 AliasMethod::AliasMethod(const std::vector<real>& weight) {
@@ -20,7 +20,7 @@ struct Option {
     integerL sample_edges, block_num_edges;
     real init_learning_rate;
     int display_iter, server_threads;
-    bool debug;
+    bool debug, encode_ids;
 
     Option();
     void ParseArgs(int argc, char* argv[]);
@@ -66,7 +66,7 @@ void SortEraseDuplicate(std::vector<T>& array);
             start_##name.tv_sec;                        \
     time_##name += (end_##name.tv_nsec -                \
             start_##name.tv_nsec) / 1e9f;               \
-    multiverso::Log::Debug("Rank %d run %s time %lf\n", \
+    MV_LOG_DEBUG("Rank %d run %s time %lf\n", \
         multiverso::MV_Rank(), msg, time_##name);
 
 }
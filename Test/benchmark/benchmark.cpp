@@ -0,0 +1,408 @@
+// Throughput benchmark of the parameter server tables. Each worker sends
+// pairs of Get and Add of random keys to a table, for every point of the
+// grid tables x rows x cols x keys x updaters given by the comma separated
+// bench_* flags. Rank 0 writes the ops/s, GB/s and latency percentiles of
+// the Gets and Adds of all the workers as JSON to bench_output. The workers
+// and servers are those of the mpirun, see -ps_role, and -sync selects the
+// sync server. run_grid.sh runs a grid of them on a single node.
+//
+// Usage:
+//   mpirun -np 2 multiverso.bench -bench_tables=matrix,kv -bench_keys=100,10000
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <multiverso/multiverso.h>
+#include <multiverso/dashboard.h>
+#include <multiverso/table/array_table.h>
+#include <multiverso/table/kv_embedding_table.h>
+#include <multiverso/table/kv_table.h>
+#include <multiverso/table/matrix.h>
+#include <multiverso/table/matrix_table.h>
+#include <multiverso/updater/updater.h>
+#include <multiverso/util/configure.h>
+#include <multiverso/util/log.h>
+#include <multiverso/util/timer.h>
+
+// written by CMake at each build, the commit the benchmark is built from
+#ifdef MULTIVERSO_BENCH_GIT_HASH
+#include "git_hash.h"
+#endif
+#ifndef MULTIVERSO_GIT_HASH
+#define MULTIVERSO_GIT_HASH "unknown"
+#endif
+
+namespace multiverso {
+
+MV_DEFINE_string(bench_tables, "array,matrix,sparse,kv,embedding",
+                 "tables to benchmark");
+MV_DEFINE_string(bench_rows, "100000",
+                 "rows of the tables, the key range of the kv tables");
+MV_DEFINE_string(bench_cols, "50",
+                 "columns of the tables, the dimension of the embeddings");
+MV_DEFINE_string(bench_keys, "1000", "rows or keys per request, the array "
+                 "tables get and add the whole table");
+MV_DEFINE_string(bench_updaters, "default", "updater_type of the servers");
+MV_DEFINE_int(bench_iterations, 100, "timed Get and Add pairs per worker");
+MV_DEFINE_int(bench_warmup, 10, "untimed Get and Add pairs per worker");
+MV_DEFINE_string(bench_output, "multiverso_bench.json",
+                 "file of the JSON results");
+MV_DECLARE_bool(sync);
+
+namespace bench {
+
+namespace {
+
+// requests cycle through this many sets of keys
+const int kRequestSets = 16;
+
+std::vector<std::string> Split(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) items.push_back(item);
+  }
+  return items;
+}
+
+std::vector<size_t> SplitSizes(const std::string& list) {
+  std::vector<size_t> sizes;
+  for (auto& item : Split(list)) sizes.push_back(std::stoull(item));
+  return sizes;
+}
+
+// kRequestSets sets of num_keys distinct keys in [0, range)
+template <typename Key>
+std::vector<std::vector<Key>> RandomKeys(size_t range, size_t num_keys) {
+  std::mt19937_64 gen(MV_WorkerId());
+  std::vector<Key> all(range);
+  std::iota(all.begin(), all.end(), Key(0));
+  std::vector<std::vector<Key>> sets(kRequestSets);
+  for (auto& set : sets) {
+    // partial Fisher-Yates shuffle
+    for (size_t i = 0; i < num_keys; ++i) {
+      std::uniform_int_distribution<size_t> dist(i, range - 1);
+      std::swap(all[i], all[dist(gen)]);
+    }
+    set.assign(all.begin(), all.begin() + num_keys);
+  }
+  return sets;
+}
+
+// Owns the worker table of a workload, deleted along with its last copy
+template <typename Table>
+std::shared_ptr<Table> Own(Table* table) {
+  return std::shared_ptr<Table>(table);
+}
+
+// Requests of a worker to one table, for the iteration-th pair
+struct Workload {
+  std::function<void(int iteration)> get;
+  std::function<void(int iteration)> add;
+  // keys and values of a request
+  size_t bytes;
+};
+
+Workload ArrayWorkload(size_t rows, size_t cols) {
+  size_t size = rows * cols;
+  auto table = Own(MV_CreateTable(ArrayTableOption<float>(size)));
+  auto data = std::make_shared<std::vector<float>>(size);
+  auto delta = std::make_shared<std::vector<float>>(size, 0.001f);
+  // the stateful updaters read the learning rate of the option
+  auto option = std::make_shared<AddOption>();
+  Workload workload;
+  workload.get = [=](int) { table->Get(data->data(), size); };
+  workload.add = [=](int) {
+    table->Add(delta->data(), size, option.get());
+  };
+  workload.bytes = size * sizeof(float);
+  return workload;
+}
+
+Workload MatrixWorkload(size_t rows, size_t cols, size_t keys) {
+  auto table = Own(MV_CreateTable(MatrixTableOption<float>(
+    static_cast<integer_t>(rows), static_cast<integer_t>(cols))));
+  auto ids = std::make_shared<std::vector<std::vector<integer_t>>>(
+    RandomKeys<integer_t>(rows, keys));
+  auto data = std::make_shared<std::vector<float>>(keys * cols);
+  auto delta = std::make_shared<std::vector<float>>(keys * cols, 0.001f);
+  auto option = std::make_shared<AddOption>();
+  Workload workload;
+  workload.get = [=](int iteration) {
+    auto& request = (*ids)[iteration % kRequestSets];
+    table->Get(data->data(), data->size(), request.data(),
+               static_cast<integer_t>(request.size()));
+  };
+  workload.add = [=](int iteration) {
+    auto& request = (*ids)[iteration % kRequestSets];
+    table->Add(delta->data(), delta->size(), request.data(),
+               static_cast<integer_t>(request.size()), option.get());
+  };
+  workload.bytes = keys * (sizeof(integer_t) + cols * sizeof(float));
+  return workload;
+}
+
+Workload SparseWorkload(size_t rows, size_t cols, size_t keys) {
+  MatrixOption<float> table_option;
+  table_option.num_row = static_cast<integer_t>(rows);
+  table_option.num_col = static_cast<integer_t>(cols);
+  table_option.is_sparse = true;
+  table_option.is_pipeline = false;
+  auto table = Own(MV_CreateTable(table_option));
+  auto ids = std::make_shared<std::vector<std::vector<integer_t>>>(
+    RandomKeys<integer_t>(rows, keys));
+  auto data = std::make_shared<std::vector<float>>(keys * cols);
+  auto delta = std::make_shared<std::vector<float>>(keys * cols, 0.001f);
+  auto option = std::make_shared<AddOption>();
+  Workload workload;
+  workload.get = [=](int iteration) {
+    auto& request = (*ids)[iteration % kRequestSets];
+    table->Get(data->data(), data->size(), request.data(),
+               static_cast<integer_t>(request.size()));
+  };
+  workload.add = [=](int iteration) {
+    auto& request = (*ids)[iteration % kRequestSets];
+    table->Add(delta->data(), delta->size(), request.data(),
+               static_cast<integer_t>(request.size()), option.get());
+  };
+  workload.bytes = keys * (sizeof(integer_t) + cols * sizeof(float));
+  return workload;
+}
+
+Workload KVWorkload(size_t rows, size_t keys) {
+  auto table = Own(MV_CreateTable(KVTableOption<int64_t, float>()));
+  auto sets = std::make_shared<std::vector<std::vector<int64_t>>>(
+    RandomKeys<int64_t>(rows, keys));
+  auto vals = std::make_shared<std::vector<float>>(keys, 0.001f);
+  Workload workload;
+  workload.get = [=](int iteration) {
+    table->Get((*sets)[iteration % kRequestSets]);
+  };
+  workload.add = [=](int iteration) {
+    table->Add((*sets)[iteration % kRequestSets], *vals);
+  };
+  workload.bytes = keys * (sizeof(int64_t) + sizeof(float));
+  return workload;
+}
+
+Workload EmbeddingWorkload(size_t rows, size_t cols, size_t keys) {
+  auto table = Own(MV_CreateTable(
+    KVEmbeddingTableOption<int64_t, float>(cols)));
+  auto sets = std::make_shared<std::vector<std::vector<int64_t>>>(
+    RandomKeys<int64_t>(rows, keys));
+  auto data = std::make_shared<std::vector<float>>(keys * cols);
+  auto delta = std::make_shared<std::vector<float>>(keys * cols, 0.001f);
+  auto option = std::make_shared<AddOption>();
+  Workload workload;
+  workload.get = [=](int iteration) {
+    table->Get((*sets)[iteration % kRequestSets], data->data());
+  };
+  workload.add = [=](int iteration) {
+    table->Add((*sets)[iteration % kRequestSets], delta->data(),
+               option.get());
+  };
+  workload.bytes = keys * (sizeof(int64_t) + cols * sizeof(float));
+  return workload;
+}
+
+Workload NewWorkload(const std::string& table, size_t rows, size_t cols,
+                     size_t keys) {
+  if (table == "array") return ArrayWorkload(rows, cols);
+  if (table == "matrix") return MatrixWorkload(rows, cols, keys);
+  if (table == "sparse") return SparseWorkload(rows, cols, keys);
+  if (table == "kv") return KVWorkload(rows, keys);
+  if (table == "embedding") return EmbeddingWorkload(rows, cols, keys);
+  Log::Fatal("Unknown table %s to benchmark\n", table.c_str());
+  return Workload();
+}
+
+// Statistics of the Gets or the Adds of all the workers
+struct OpResult {
+  // sum over the workers of the requests per second of the time they spent
+  // in the requests
+  double ops_per_sec;
+  double gb_per_sec;
+  Histogram latency;
+};
+
+struct Result {
+  std::string table;
+  size_t rows;
+  size_t cols;
+  size_t keys;
+  std::string updater;
+  // Get and Add pairs per second of all the workers
+  double pairs_per_sec;
+  OpResult get;
+  OpResult add;
+};
+
+// Runs workload on the workers, all the ranks call it
+Result Measure(const Workload& workload) {
+  bool is_worker = MV_WorkerId() >= 0;
+  int iterations = MV_CONFIG_bench_iterations;
+  std::vector<uint64_t> latencies[2];
+  if (is_worker) {
+    for (int i = 0; i < MV_CONFIG_bench_warmup; ++i) {
+      workload.get(i);
+      workload.add(i);
+    }
+  }
+  MV_Barrier();
+  Timer total;
+  if (is_worker) {
+    Timer timer;
+    for (int i = 0; i < iterations; ++i) {
+      timer.Start();
+      workload.get(i);
+      latencies[0].push_back(static_cast<uint64_t>(timer.elapse() * 1e6));
+      timer.Start();
+      workload.add(i);
+      latencies[1].push_back(static_cast<uint64_t>(timer.elapse() * 1e6));
+    }
+  }
+  double seconds = total.elapse() / 1000;
+  MV_Barrier();
+
+  // per worker rates and latency buckets, summed over the ranks
+  const int kBuckets = Histogram::kNumBuckets;
+  std::vector<double> sums(3 + 2 * kBuckets, 0.0);
+  if (is_worker && iterations > 0) {
+    sums[0] = iterations / seconds;
+    for (int op = 0; op < 2; ++op) {
+      uint64_t busy = 0;
+      for (uint64_t latency : latencies[op]) {
+        busy += latency;
+        sums[3 + op * kBuckets + Histogram::Bucket(latency)] += 1;
+      }
+      sums[1 + op] = busy > 0 ? iterations / (busy / 1e9) : 0;
+    }
+  }
+  MV_Aggregate(sums.data(), static_cast<int>(sums.size()));
+
+  Result result;
+  result.pairs_per_sec = sums[0];
+  OpResult* ops[2] = { &result.get, &result.add };
+  for (int op = 0; op < 2; ++op) {
+    ops[op]->ops_per_sec = sums[1 + op];
+    ops[op]->gb_per_sec = sums[1 + op] * workload.bytes / 1e9;
+    for (int bucket = 0; bucket < kBuckets; ++bucket) {
+      uint64_t count = static_cast<uint64_t>(sums[3 + op * kBuckets + bucket]);
+      if (count > 0) ops[op]->latency.Add(bucket, count);
+    }
+  }
+  return result;
+}
+
+void WriteOp(const char* name, const OpResult& op, std::ostream* out) {
+  *out << "\"" << name << "\": {\"ops_per_sec\": " << op.ops_per_sec
+       << ", \"gb_per_sec\": " << op.gb_per_sec << ", \"latency_ms\": {";
+  const char* names[] = { "p50", "p90", "p99", "p999" };
+  for (int i = 0; i < DashboardSnapshot::kNumQuantiles; ++i) {
+    *out << (i > 0 ? ", " : "") << "\"" << names[i] << "\": "
+         << op.latency.Quantile(DashboardSnapshot::kQuantiles[i]) / 1e6;
+  }
+  *out << "}}";
+}
+
+void WriteJSON(const std::vector<Result>& results, std::ostream* out) {
+  *out << "{\"git\": \"" << MULTIVERSO_GIT_HASH << "\""
+       << ", \"time\": " << static_cast<int64_t>(time(nullptr))
+       << ", \"ranks\": " << MV_Size()
+       << ", \"workers\": " << MV_NumWorkers()
+       << ", \"servers\": " << MV_NumServers()
+       << ", \"sync\": " << (MV_CONFIG_sync ? "true" : "false")
+       << ", \"iterations\": " << MV_CONFIG_bench_iterations
+       << ", \"warmup\": " << MV_CONFIG_bench_warmup
+       << ",\n \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& result = results[i];
+    *out << (i > 0 ? ",\n  " : "\n  ")
+         << "{\"table\": \"" << result.table << "\""
+         << ", \"rows\": " << result.rows
+         << ", \"cols\": " << result.cols
+         << ", \"keys\": " << result.keys
+         << ", \"updater\": \"" << result.updater << "\""
+         << ", \"pairs_per_sec\": " << result.pairs_per_sec << ", ";
+    WriteOp("get", result.get, out);
+    *out << ", ";
+    WriteOp("add", result.add, out);
+    *out << "}";
+  }
+  *out << "\n]}\n";
+}
+
+}  // namespace
+
+void Run() {
+  std::vector<Result> results;
+  std::vector<size_t> all_rows = SplitSizes(MV_CONFIG_bench_rows);
+  std::vector<size_t> all_cols = SplitSizes(MV_CONFIG_bench_cols);
+  std::vector<size_t> all_keys = SplitSizes(MV_CONFIG_bench_keys);
+  std::vector<std::string> updaters = Split(MV_CONFIG_bench_updaters);
+  for (auto& table : Split(MV_CONFIG_bench_tables)) {
+    // the parameters a table ignores are not varied
+    bool whole = table == "array", scalar = table == "kv";
+    for (size_t rows : all_rows) {
+      for (size_t c = 0; c < (scalar ? 1 : all_cols.size()); ++c) {
+        for (size_t k = 0; k < (whole ? 1 : all_keys.size()); ++k) {
+          for (size_t u = 0; u < (scalar ? 1 : updaters.size()); ++u) {
+            size_t cols = scalar ? 1 : all_cols[c];
+            size_t keys = whole ? rows : std::min(all_keys[k], rows);
+            MV_SetFlag("updater_type", updaters[u]);
+            Result result = Measure(NewWorkload(table, rows, cols, keys));
+            // the worker table is gone with the workload, restart to free
+            // the server tables before the next point
+            MV_ShutDown(false);
+            MV_Init();
+            result.table = table;
+            result.rows = rows;
+            result.cols = cols;
+            result.keys = keys;
+            result.updater = scalar ? "none" : updaters[u];
+            if (MV_Rank() != 0) {
+              results.push_back(result);
+              continue;
+            }
+            Log::Info("%s rows = %zu cols = %zu keys = %zu updater = %s: "
+              "get %.1f ops/s %.3f GB/s p99 %.3f ms, add %.1f ops/s "
+              "%.3f GB/s p99 %.3f ms\n", table.c_str(), rows, cols, keys,
+              result.updater.c_str(), result.get.ops_per_sec,
+              result.get.gb_per_sec, result.get.latency.Quantile(0.99) / 1e6,
+              result.add.ops_per_sec, result.add.gb_per_sec,
+              result.add.latency.Quantile(0.99) / 1e6);
+            results.push_back(result);
+          }
+        }
+      }
+    }
+  }
+  if (MV_Rank() == 0) {
+    std::ofstream out(MV_CONFIG_bench_output);
+    CHECK(out.good());
+    WriteJSON(results, &out);
+    Log::Info("Benchmark results written to %s\n",
+              MV_CONFIG_bench_output.c_str());
+  }
+}
+
+}  // namespace bench
+}  // namespace multiverso
+
+int main(int argc, char* argv[]) {
+  multiverso::Log::ResetLogLevel(multiverso::LogLevel::Info);
+  multiverso::MV_Init(&argc, argv);
+  multiverso::bench::Run();
+  multiverso::MV_ShutDown();
+  return 0;
+}
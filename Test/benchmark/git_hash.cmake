@@ -0,0 +1,17 @@
+# Writes OUTPUT defining MULTIVERSO_GIT_HASH as the commit of MULTIVERSO_DIR.
+# The file is only touched when the commit changes, so the benchmark is not
+# rebuilt at each build.
+EXECUTE_PROCESS(COMMAND git rev-parse --short HEAD
+    WORKING_DIRECTORY ${MULTIVERSO_DIR}
+    OUTPUT_VARIABLE MULTIVERSO_GIT_HASH
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET)
+if(NOT MULTIVERSO_GIT_HASH)
+    SET(MULTIVERSO_GIT_HASH unknown)
+endif(NOT MULTIVERSO_GIT_HASH)
+
+FILE(WRITE ${OUTPUT}.tmp
+    "#define MULTIVERSO_GIT_HASH \"${MULTIVERSO_GIT_HASH}\"\n")
+EXECUTE_PROCESS(COMMAND ${CMAKE_COMMAND} -E copy_if_different
+    ${OUTPUT}.tmp ${OUTPUT})
+FILE(REMOVE ${OUTPUT}.tmp)
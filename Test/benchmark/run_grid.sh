@@ -0,0 +1,12 @@
+#!/bin/sh
+# Runs multiverso.bench on this node for each number of processes and server
+# mode, writing bench_np<N>_sync<S>.json. Other arguments are passed to the
+# benchmark, e.g.
+#   NPS="1 2 4" ./run_grid.sh -bench_tables=matrix,kv -bench_keys=100,10000
+BENCH=${BENCH:-./multiverso.bench}
+for np in ${NPS:-1 2 4}; do
+  for sync in false true; do
+    mpirun -np $np $BENCH -sync=$sync \
+      -bench_output=bench_np${np}_sync${sync}.json "$@" || exit 1
+  done
+done
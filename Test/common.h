@@ -8,12 +8,22 @@ void TestAllreduce(int argc, char* argv[]);
 
 void TestArray(int argc, char* argv[]);
 
+void TestCodec(int argc, char* argv[]);
+
 void TestKV(int argc, char* argv[]);
 
+void TestKVPerf(int argc, char* argv[]);
+
 void TestMatrix(int argc, char* argv[]);
 
 void TestNet(int argc, char* argv[]);
 
+void TestServerPerf(int argc, char* argv[]);
+
+void TestTextPerf(int argc, char* argv[]);
+
+void TestUpdater(int argc, char* argv[]);
+
 }  // namespace test
 }  // namespace multiverso
 
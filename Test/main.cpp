@@ -6,7 +6,7 @@
 using namespace multiverso::test;
 
 void PrintUsage() {
-  printf("Usage: multiverso.test kv|array|net|matrix|allreduce\n");
+  printf("Usage: multiverso.test kv|array|net|matrix|allreduce|codec|updater|server|kv_perf|text_perf\n");
 }
 
 int main(int argc, char* argv[]) {
@@ -17,6 +17,11 @@ int main(int argc, char* argv[]) {
     else if (strcmp(argv[1], "net") == 0) TestNet(argc, argv);
     else if (strcmp(argv[1], "matrix") == 0) TestMatrix(argc, argv);
     else if (strcmp(argv[1], "allreduce") == 0) TestAllreduce(argc, argv);
+    else if (strcmp(argv[1], "codec") == 0) TestCodec(argc, argv);
+    else if (strcmp(argv[1], "updater") == 0) TestUpdater(argc, argv);
+    else if (strcmp(argv[1], "server") == 0) TestServerPerf(argc, argv);
+    else if (strcmp(argv[1], "kv_perf") == 0) TestKVPerf(argc, argv);
+    else if (strcmp(argv[1], "text_perf") == 0) TestTextPerf(argc, argv);
     else {
       PrintUsage();
     }
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <multiverso/util/key_codec.h>
+#include <multiverso/util/log.h>
+#include <multiverso/util/quantization_util.h>
+#include <multiverso/util/timer.h>
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+// Encodes and decodes ids for a number of rounds, report the size and speed
+void BenchCodec(const char* name, const std::vector<integer_t>& ids,
+                bool sorted) {
+  const int kRounds = 20;
+  std::vector<char> encoded(key_codec::MaxEncodedSize<integer_t>(ids.size()));
+  std::vector<integer_t> decoded(ids.size());
+  size_t size = 0;
+
+  Timer timer;
+  for (int i = 0; i < kRounds; ++i) {
+    size = key_codec::Encode(ids.data(), ids.size(), sorted, encoded.data());
+  }
+  double encode_ms = timer.elapse();
+
+  timer.Start();
+  for (int i = 0; i < kRounds; ++i) {
+    key_codec::Decode(encoded.data(), ids.size(), sorted, decoded.data());
+  }
+  double decode_ms = timer.elapse();
+  CHECK(decoded == ids);
+
+  double raw = static_cast<double>(ids.size() * sizeof(integer_t));
+  double gb = raw * kRounds / 1e9;
+  Log::Info("%-16s ids = %zu, raw = %.0f bytes, encoded = %zu bytes "
+    "(%.1f%% saved), encode %.2f GB/s, decode %.2f GB/s\n",
+    name, ids.size(), raw, size, 100.0 * (1 - size / raw),
+    gb / (encode_ms / 1e3), gb / (decode_ms / 1e3));
+}
+
+// Filters rows of sparse matrix Adds with the given density of non zeros,
+// with both wire formats of SparseFilter
+void BenchSparseFilter(double density) {
+  const int kRounds = 20;
+  const size_t kNumRows = 1000, kNumCol = 1000;
+  std::mt19937 gen(0);
+  std::bernoulli_distribution non_zero(density);
+  std::vector<integer_t> keys(kNumRows);
+  std::vector<float> values(kNumRows * kNumCol);
+  for (auto& v : values) v = non_zero(gen) ? 0.5f : 0.0f;
+  std::vector<Blob> blobs = { Blob(keys.data(), keys.size() * sizeof(integer_t)),
+    Blob(values.data(), values.size() * sizeof(float)) };
+
+  for (int version : { 1, 2 }) {
+    SparseFilter<float, int32_t> filter(0, false, version);
+    std::vector<Blob> encoded, decoded;
+    Timer timer;
+    for (int i = 0; i < kRounds; ++i) filter.FilterIn(blobs, &encoded);
+    double encode_ms = timer.elapse();
+    timer.Start();
+    for (int i = 0; i < kRounds; ++i) filter.FilterOut(encoded, &decoded);
+    double decode_ms = timer.elapse();
+    CHECK(memcmp(decoded[1].data(), values.data(), blobs[1].size()) == 0);
+
+    double gb = static_cast<double>(blobs[1].size()) * kRounds / 1e9;
+    Log::Info("sparse filter v%d density = %.3f, raw = %zu bytes, "
+      "encoded = %zu bytes, encode %.2f GB/s, decode %.2f GB/s\n", version,
+      density, blobs[1].size(), encoded[2].size(),
+      gb / (encode_ms / 1e3), gb / (decode_ms / 1e3));
+  }
+}
+
+}  // namespace
+
+void TestCodec(int, char*[]) {
+  Log::ResetLogLevel(LogLevel::Info);
+  Log::Info("Test key codec and sparse filter\n");
+
+  const int kNumRows = 1000000;
+  const size_t kNumKeys = 1000000;
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<integer_t> dist(0, kNumRows - 1);
+
+  // dense rows of a partition, as sent by a whole row range Get/Add
+  std::vector<integer_t> dense(kNumKeys);
+  for (size_t i = 0; i < kNumKeys; ++i) dense[i] = static_cast<integer_t>(i);
+  BenchCodec("dense", dense, true);
+
+  // sampled rows after sort and dedup, as sent by matrix tables
+  std::vector<integer_t> sparse(kNumKeys / 10);
+  for (auto& id : sparse) id = dist(gen);
+  std::sort(sparse.begin(), sparse.end());
+  sparse.erase(std::unique(sparse.begin(), sparse.end()), sparse.end());
+  BenchCodec("sorted sparse", sparse, true);
+
+  // random ids in arrival order, as the edge lists of GE
+  std::vector<integer_t> random(kNumKeys);
+  for (auto& id : random) id = dist(gen);
+  BenchCodec("unsorted", random, false);
+
+  for (double density : { 0.001, 0.01, 0.1, 0.4 }) BenchSparseFilter(density);
+}
+
+}  // namespace test
+}  // namespace multiverso
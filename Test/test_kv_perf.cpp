@@ -0,0 +1,76 @@
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <multiverso/multiverso.h>
+#include <multiverso/blob.h>
+#include <multiverso/table/kv_table.h>
+#include <multiverso/util/log.h>
+#include <multiverso/util/timer.h>
+
+namespace multiverso {
+namespace test {
+
+// Throughput of the KV tables for a million keys, without the net: the
+// worker Partition and the server Add and Get, against std::unordered_map
+void TestKVPerf(int argc, char* argv[]) {
+  Log::ResetLogLevel(LogLevel::Info);
+  Log::Info("Test KV table throughput\n");
+  MV_Init(&argc, argv);
+
+  const size_t kNumKeys = 1000000;
+  std::mt19937_64 gen(0);
+  std::vector<int64_t> keys(kNumKeys);
+  for (auto& key : keys) key = static_cast<int64_t>(gen() >> 1);
+  std::vector<float> vals(kNumKeys, 1.0f);
+  std::vector<Blob> add = { Blob(keys.data(), kNumKeys * sizeof(int64_t)),
+    Blob(vals.data(), kNumKeys * sizeof(float)) };
+  std::vector<Blob> get = { add[0] };
+
+  KVTableOption<int64_t, float> option;
+  KVWorkerTable<int64_t, float> worker(option);
+  KVServerTable<int64_t, float> server(option);
+
+  Timer timer;
+  std::unordered_map<int, std::vector<Blob>> partitioned;
+  worker.Partition(add, MsgType::Request_Add, &partitioned);
+  double partition_ms = timer.elapse();
+
+  timer.Start();
+  server.ProcessAdd(add);  // inserts
+  double insert_ms = timer.elapse();
+  timer.Start();
+  server.ProcessAdd(add);  // updates
+  double update_ms = timer.elapse();
+  timer.Start();
+  std::vector<Blob> result;
+  server.ProcessGet(get, &result);
+  double get_ms = timer.elapse();
+  CHECK(result[1].As<float>(kNumKeys - 1) == 2.0f);
+
+  std::unordered_map<int64_t, float> reference;
+  timer.Start();
+  for (size_t i = 0; i < kNumKeys; ++i) reference[keys[i]] += vals[i];
+  double ref_insert_ms = timer.elapse();
+  timer.Start();
+  for (size_t i = 0; i < kNumKeys; ++i) reference[keys[i]] += vals[i];
+  double ref_update_ms = timer.elapse();
+  timer.Start();
+  float sum = 0;
+  for (size_t i = 0; i < kNumKeys; ++i) sum += reference[keys[i]];
+  double ref_get_ms = timer.elapse();
+  CHECK(sum == 2.0f * kNumKeys);
+
+  auto rate = [kNumKeys](double ms) { return 1e-3 * kNumKeys / ms; };
+  Log::Info("partition %.1f M keys/s\n", rate(partition_ms));
+  Log::Info("flat hash map:      insert %.1f M keys/s, update %.1f M keys/s, "
+    "get %.1f M keys/s\n", rate(insert_ms), rate(update_ms), rate(get_ms));
+  Log::Info("std::unordered_map: insert %.1f M keys/s, update %.1f M keys/s, "
+    "get %.1f M keys/s\n", rate(ref_insert_ms), rate(ref_update_ms),
+    rate(ref_get_ms));
+
+  MV_ShutDown();
+}
+
+}  // namespace test
+}  // namespace multiverso
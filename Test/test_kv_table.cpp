@@ -16,7 +16,7 @@ void TestKV(int argc, char* argv[]) {
 
   // 3. User program
   // access the local cache
-  std::unordered_map<int, int>& kv = dht->raw();
+  auto& kv = dht->raw();
 
   // Get from the server
   dht->Get(0);
@@ -0,0 +1,113 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include <multiverso/multiverso.h>
+#include <multiverso/blob.h>
+#include <multiverso/table/matrix_table.h>
+#include <multiverso/table/stale_rows.h>
+#include <multiverso/updater/updater.h>
+#include <multiverso/util/log.h>
+#include <multiverso/util/timer.h>
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+// Cost of the stale rows tracking of sparse matrix servers for growing
+// numbers of workers, against the former bool per row per worker arrays
+void BenchStaleRows() {
+  const size_t kNumRow = 100000, kKeys = 1000;
+  const int kRounds = 200;
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<size_t> dist(0, kNumRow - 1);
+  std::vector<size_t> keys(kKeys);
+
+  for (int workers : { 8, 32, 64, 128, 256 }) {
+    StaleRows stale(kNumRow, workers);
+    std::vector<std::vector<bool>> up_to_date(workers,
+      std::vector<bool>(kNumRow, false));
+    double bits_ms = 0, bools_ms = 0;
+    size_t fetched = 0, reference = 0;
+    for (int r = 0; r < kRounds; ++r) {
+      for (auto& key : keys) key = dist(gen);
+      int worker = r % workers;
+
+      Timer timer;
+      for (size_t key : keys) stale.Added(key, worker);
+      for (size_t key : keys) fetched += stale.Fetch(key, (worker + 1) % workers);
+      bits_ms += timer.elapse();
+
+      timer.Start();
+      for (int id = 0; id < workers; ++id) {
+        if (id == worker) continue;
+        for (size_t key : keys) up_to_date[id][key] = false;
+      }
+      for (size_t key : keys) {
+        std::vector<bool>::reference fresh = up_to_date[(worker + 1) % workers][key];
+        if (!fresh) { fresh = true; ++reference; }
+      }
+      bools_ms += timer.elapse();
+    }
+    CHECK(fetched == reference);
+    Log::Info("stale rows, workers = %3d: bitset %.1f ns/key, %.2f bits/row/"
+      "worker, per worker arrays %.1f ns/key\n", workers,
+      1e6 * bits_ms / (2.0 * kRounds * kKeys),
+      8.0 * stale.bytes() / (kNumRow * workers),
+      1e6 * bools_ms / (2.0 * kRounds * kKeys));
+  }
+}
+
+}  // namespace
+
+// Throughput of the server side of a matrix table, without the net, for
+// requests of growing sizes and matrix_server_threads, after the stale rows
+// tracking of sparse matrix servers
+void TestServerPerf(int argc, char* argv[]) {
+  Log::ResetLogLevel(LogLevel::Info);
+  Log::Info("Test matrix server throughput\n");
+  MV_Init(&argc, argv);
+  BenchStaleRows();
+
+  const int kNumRow = 200000, kNumCol = 100;
+  const int kRounds = 10;
+  MatrixServerTable<float> table(kNumRow, kNumCol);
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<integer_t> dist(0, kNumRow - 1);
+  AddOption option;
+
+  for (int num_rows : { 100, 10000, 100000 }) {
+    std::vector<integer_t> keys(num_rows);
+    for (auto& key : keys) key = dist(gen);
+    std::vector<float> delta(static_cast<size_t>(num_rows) * kNumCol, 0.1f);
+    std::vector<Blob> add = { Blob(keys.data(), keys.size() * sizeof(integer_t)),
+      Blob(delta.data(), delta.size() * sizeof(float)),
+      Blob(option.data(), option.size()) };
+    std::vector<Blob> get = { add[0] };
+
+    for (int threads : { 1, 2, 4 }) {
+      MV_SetFlag("matrix_server_threads", threads);
+      Timer timer;
+      for (int i = 0; i < kRounds; ++i) table.ProcessAdd(add);
+      double add_ms = timer.elapse();
+
+      timer.Start();
+      for (int i = 0; i < kRounds; ++i) {
+        std::vector<Blob> result;
+        table.ProcessGet(get, &result);
+      }
+      double get_ms = timer.elapse();
+
+      Log::Info("rows = %6d, threads = %d: add %.2f M rows/s, "
+        "get %.2f M rows/s\n", num_rows, threads,
+        1e-3 * kRounds * num_rows / add_ms,
+        1e-3 * kRounds * num_rows / get_ms);
+    }
+  }
+
+  MV_ShutDown();
+}
+
+}  // namespace test
+}  // namespace multiverso
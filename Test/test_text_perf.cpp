@@ -0,0 +1,114 @@
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <multiverso/multiverso.h>
+#include <multiverso/io/chunked_text_reader.h>
+#include <multiverso/io/io.h>
+#include <multiverso/util/log.h>
+#include <multiverso/util/timer.h>
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+// leading integer of a line, as the loaders read a label or an id
+int64_t ParseLabel(const char* data, size_t size) {
+  int64_t value = 0;
+  for (size_t i = 0; i < size && data[i] >= '0' && data[i] <= '9'; ++i) {
+    value = value * 10 + (data[i] - '0');
+  }
+  return value;
+}
+
+}  // namespace
+
+// Throughput of reading and parsing a 2 GB text file of libsvm like lines
+// with TextReader::GetLine and with ChunkedTextReader, on one thread and on
+// all the cores. The file is read from the page cache after being written.
+void TestTextPerf(int argc, char* argv[]) {
+  Log::ResetLogLevel(LogLevel::Info);
+  Log::Info("Test text reader throughput\n");
+  MV_Init(&argc, argv);
+
+  const std::string kPath = "text_perf.txt";
+  const size_t kBlockSize = 4 << 20, kNumBlocks = 512;
+  std::mt19937 gen(0);
+  std::string block;
+  while (block.size() < kBlockSize) {
+    std::string line = std::to_string(gen() % 2);
+    for (int i = 0; i < 10; ++i) {
+      line += " " + std::to_string(gen() % 1000000) + ":0." +
+        std::to_string(gen() % 1000);
+    }
+    block += line + "\n";
+  }
+  size_t lines_per_block = 0;
+  for (char c : block) lines_per_block += c == '\n';
+  {
+    std::unique_ptr<Stream> stream(StreamFactory::GetStream(URI(kPath),
+      FileOpenMode::BinaryWrite));
+    for (size_t i = 0; i < kNumBlocks; ++i) {
+      stream->Write(block.data(), block.size());
+    }
+  }
+  const size_t kLines = lines_per_block * kNumBlocks;
+  const double kGB = 1e-9 * block.size() * kNumBlocks;
+  Log::Info("%.2f GB, %zu lines\n", kGB, kLines);
+
+  Timer timer;
+  size_t lines = 0;
+  int64_t sum = 0;
+  {
+    TextReader reader(URI(kPath), 1 << 20);
+    std::string line;
+    while (reader.GetLine(line) > 0) {
+      ++lines;
+      sum += ParseLabel(line.data(), line.size());
+    }
+  }
+  CHECK(lines == kLines);
+  Log::Info("TextReader::GetLine:             %.2f GB/s\n",
+    kGB * 1000 / timer.elapse());
+
+  timer.Start();
+  lines = 0;
+  int64_t chunk_sum = 0;
+  {
+    ChunkedTextReader reader((URI(kPath)));
+    while (std::unique_ptr<TextChunk> chunk = reader.NextChunk()) {
+      lines += chunk->num_lines();
+      for (auto& line : chunk->lines()) {
+        chunk_sum += ParseLabel(line.data, line.size);
+      }
+    }
+  }
+  CHECK(lines == kLines && chunk_sum == sum);
+  Log::Info("ChunkedTextReader::NextChunk:    %.2f GB/s\n",
+    kGB * 1000 / timer.elapse());
+
+  timer.Start();
+  std::atomic<size_t> parallel_lines(0);
+  std::atomic<int64_t> parallel_sum(0);
+  {
+    ChunkedTextReader reader((URI(kPath)));
+    reader.ForEachChunk([&](const TextChunk& chunk) {
+      int64_t local = 0;
+      for (auto& line : chunk.lines()) local += ParseLabel(line.data, line.size);
+      parallel_lines += chunk.num_lines();
+      parallel_sum += local;
+    });
+  }
+  CHECK(parallel_lines == kLines && parallel_sum == sum);
+  Log::Info("ChunkedTextReader::ForEachChunk: %.2f GB/s\n",
+    kGB * 1000 / timer.elapse());
+
+  std::remove(kPath.c_str());
+  MV_ShutDown();
+}
+
+}  // namespace test
+}  // namespace multiverso
@@ -0,0 +1,65 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <multiverso/multiverso.h>
+#include <multiverso/updater/updater.h>
+#include <multiverso/util/log.h>
+#include <multiverso/util/timer.h>
+
+namespace multiverso {
+namespace test {
+
+void TestUpdater(int argc, char* argv[]) {
+  Log::ResetLogLevel(LogLevel::Info);
+  Log::Info("Test updaters\n");
+  MV_Init(&argc, argv);
+
+  const int kNumRow = 100000, kNumCol = 50;
+  const size_t size = static_cast<size_t>(kNumRow) * kNumCol;
+  const int kDenseRounds = 10, kSparseRows = 200000;
+  std::vector<float> data(size), delta(size);
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> value(-1, 1);
+  for (auto& d : delta) d = value(gen) * 0.01f;
+  std::uniform_int_distribution<int> row(0, kNumRow - 1);
+  std::vector<int> rows(kSparseRows);
+  for (auto& r : rows) r = row(gen);
+
+  AddOption option;
+  const char* types[] = { "default", "sgd", "momentum_sgd", "adagrad",
+                          "adam", "ftrl" };
+  for (auto type : types) {
+    MV_SetFlag("updater_type", std::string(type));
+    std::fill(data.begin(), data.end(), 0.0f);
+
+    // sparse row Adds first, state is allocated for the touched rows only
+    std::unique_ptr<Updater<float>> updater(
+      Updater<float>::GetUpdater(size, kNumCol));
+    Timer timer;
+    for (int r : rows) {
+      updater->Update(kNumCol, data.data(), delta.data() + r * kNumCol,
+                      &option, static_cast<size_t>(r) * kNumCol);
+    }
+    double sparse_ms = timer.elapse();
+    size_t sparse_bytes = updater->state_bytes();
+
+    timer.Start();
+    for (int i = 0; i < kDenseRounds; ++i) {
+      updater->Update(size, data.data(), delta.data(), &option);
+    }
+    double dense_ms = timer.elapse();
+
+    Log::Info("%-12s sparse %.1f M params/s, dense %.1f M params/s, "
+      "state %.2f bytes/param after sparse Adds, %.2f after dense\n", type,
+      1e-3 * kSparseRows * kNumCol / sparse_ms,
+      1e-3 * kDenseRounds * size / dense_ms,
+      static_cast<double>(sparse_bytes) / size,
+      static_cast<double>(updater->state_bytes()) / size);
+  }
+
+  MV_ShutDown();
+}
+
+}  // namespace test
+}  // namespace multiverso
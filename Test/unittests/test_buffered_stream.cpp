@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/io/io.h>
+
+namespace multiverso {
+namespace test {
+
+BOOST_AUTO_TEST_SUITE(buffered_stream)
+
+BOOST_AUTO_TEST_CASE(uri_options) {
+  URI uri("hdfs://host/data/part?buffer=4M&async=false");
+  BOOST_CHECK_EQUAL(uri.scheme, "hdfs");
+  BOOST_CHECK_EQUAL(uri.host, "host");
+  BOOST_CHECK_EQUAL(uri.name, "/data/part");
+  BOOST_CHECK_EQUAL(uri.options["buffer"], "4M");
+  BOOST_CHECK_EQUAL(uri.options["async"], "false");
+
+  URI local("model.bin");
+  BOOST_CHECK_EQUAL(local.path, "model.bin");
+  BOOST_CHECK(local.options.empty());
+}
+
+BOOST_AUTO_TEST_CASE(write_read) {
+  const std::string kPath = "test_buffered_stream.bin";
+  std::mt19937 gen(0);
+  std::vector<char> data(100000);
+  for (auto& c : data) c = static_cast<char>(gen());
+
+  for (std::string options : { "?buffer=1000", "?buffer=1K&async=false",
+                               "?buffer=1M", "" }) {
+    std::uniform_int_distribution<size_t> sizes(0, 3000);
+    {
+      std::unique_ptr<Stream> stream(StreamFactory::GetStream(
+        URI(kPath + options), FileOpenMode::BinaryWrite));
+      for (size_t pos = 0; pos < data.size(); ) {
+        size_t size = std::min(sizes(gen), data.size() - pos);
+        stream->Write(data.data() + pos, size);
+        pos += size;
+      }
+    }
+    std::unique_ptr<Stream> stream(StreamFactory::GetStream(
+      URI(kPath + options), FileOpenMode::BinaryRead));
+    std::vector<char> read(data.size() + 10);
+    size_t pos = 0;
+    while (true) {
+      size_t size = stream->Read(read.data() + pos,
+        std::min(sizes(gen) + 1, read.size() - pos));
+      if (size == 0) break;
+      pos += size;
+    }
+    read.resize(pos);
+    BOOST_CHECK(read == data);
+    BOOST_CHECK_EQUAL(stream->Read(read.data(), 1), 0);
+  }
+  std::remove(kPath.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
@@ -0,0 +1,89 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/dashboard.h>
+#include <multiverso/util/metrics_reporter.h>
+
+namespace multiverso {
+namespace test {
+
+BOOST_AUTO_TEST_SUITE(dashboard_test)
+
+BOOST_AUTO_TEST_CASE(histogram_buckets) {
+  uint64_t previous = 0;
+  for (int bucket = 0; bucket < Histogram::kNumBuckets; ++bucket) {
+    // the buckets tile the values
+    BOOST_CHECK_EQUAL(Histogram::Lower(bucket), previous);
+    BOOST_CHECK_EQUAL(Histogram::Bucket(Histogram::Lower(bucket)), bucket);
+    BOOST_CHECK_EQUAL(Histogram::Bucket(Histogram::Upper(bucket) - 1), bucket);
+    previous = Histogram::Upper(bucket);
+  }
+  BOOST_CHECK_EQUAL(Histogram::Bucket(~uint64_t(0)), Histogram::kNumBuckets - 1);
+}
+
+BOOST_AUTO_TEST_CASE(histogram_quantiles) {
+  Histogram histogram;
+  for (uint64_t value = 1; value <= 100000; ++value) {
+    histogram.Add(Histogram::Bucket(value), 1);
+  }
+  for (double q : { 0.5, 0.9, 0.99, 0.999 }) {
+    BOOST_CHECK_CLOSE(histogram.Quantile(q), q * 100000, 12.5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(monitor_threads) {
+  Monitor monitor("dashboard_test_monitor");
+  Counter counter("dashboard_test_counter");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < 1000; ++i) {
+        monitor.Record(1.0);
+        counter.Add(10);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  BOOST_CHECK_EQUAL(monitor.count(), 4000);
+  BOOST_CHECK_CLOSE(monitor.elapse(), 4000.0, 1e-6);
+  BOOST_CHECK_CLOSE(monitor.quantile(0.99), 1.0, 12.5);
+  BOOST_CHECK_EQUAL(counter.count(), 4000);
+  BOOST_CHECK_EQUAL(counter.sum(), 40000);
+  counter.Sample();
+  BOOST_CHECK(counter.count_rate(60) > 0);
+  Dashboard::RemoveMonitor("dashboard_test_monitor");
+}
+
+BOOST_AUTO_TEST_CASE(metrics_export) {
+  Dashboard::GetCounter("dashboard_test_export")->Add(42);
+  Dashboard::GetGauge("dashboard_test_gauge")->Set(-3);
+  std::string path = "dashboard_test_metrics";
+  for (auto format : { MetricsReporter::kJsonLines,
+                       MetricsReporter::kPrometheus }) {
+    // the last snapshot is written on destruction
+    delete new MetricsReporter(path, 3600, format, 0);
+    std::ifstream file(path);
+    std::stringstream text;
+    text << file.rdbuf();
+    file.close();
+    std::remove(path.c_str());
+    if (format == MetricsReporter::kJsonLines) {
+      BOOST_CHECK(text.str().find("\"dashboard_test_export\":{\"count\":1,"
+        "\"sum\":42") != std::string::npos);
+      BOOST_CHECK(text.str().find("\"dashboard_test_gauge\":-3") !=
+        std::string::npos);
+    } else {
+      BOOST_CHECK(text.str().find("multiverso_events_size_total{counter="
+        "\"dashboard_test_export\",rank=\"0\"} 42\n") != std::string::npos);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
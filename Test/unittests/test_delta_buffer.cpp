@@ -0,0 +1,110 @@
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/dashboard.h>
+#include <multiverso/table/delta_buffer.h>
+#include <multiverso/table/matrix_table.h>
+#include <multiverso/updater/updater.h>
+
+#include "multiverso_env.h"
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+const int kNumRow = 8;
+const int kNumCol = 4;
+
+// Adds the rows of keys, with values key * 10 + column, to table in one Add
+void AddRows(ServerTable* table, const std::vector<integer_t>& keys) {
+  std::vector<float> values;
+  for (integer_t key : keys) {
+    for (int j = 0; j < kNumCol; ++j) values.push_back(key * 10.0f + j);
+  }
+  AddOption option;
+  std::vector<Blob> data;
+  data.push_back(Blob(keys.data(), keys.size() * sizeof(integer_t)));
+  data.push_back(Blob(values.data(), values.size() * sizeof(float)));
+  data.push_back(Blob(option.data(), option.size()));
+  table->ProcessAdd(data);
+}
+
+std::vector<float> GetAll(ServerTable* table) {
+  integer_t all = -1;
+  std::vector<Blob> data, result;
+  data.push_back(Blob(&all, sizeof(integer_t)));
+  table->ProcessGet(data, &result);
+  return std::vector<float>(reinterpret_cast<float*>(result[1].data()),
+    reinterpret_cast<float*>(result[1].data()) + result[1].size<float>());
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(delta_buffer)
+
+BOOST_AUTO_TEST_CASE(merged_equals_serial) {
+  DefaultUpdater<int> updater;
+  std::vector<int> serial(kNumRow * kNumCol), merged(kNumRow * kNumCol);
+  DeltaBuffer<int> buffer(kNumRow, kNumCol);
+  std::vector<int> delta(kNumCol);
+  for (int i = 0; i < 100; ++i) {
+    size_t row = (i * 7) % 5;
+    for (int j = 0; j < kNumCol; ++j) delta[j] = i * kNumCol + j;
+    updater.Update(kNumCol, serial.data(), delta.data(), nullptr,
+      row * kNumCol);
+    buffer.Add(row, delta.data());
+  }
+  buffer.FlushAll([&](size_t row, int* sum) {
+    updater.Update(kNumCol, merged.data(), sum, nullptr, row * kNumCol);
+  });
+  BOOST_CHECK(buffer.empty());
+  BOOST_CHECK(merged == serial);
+  BOOST_CHECK_CLOSE(buffer.merge_ratio(), 20.0, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(matrix_table_merges_linear) {
+  MV_SetFlag("aggregate_adds", 4);
+  std::vector<float> expected(kNumRow * kNumCol);
+  {
+    MultiversoEnv env;
+    MatrixServerTable<float> table(kNumRow, kNumCol);
+    std::vector<integer_t> keys = { 1, 3, 1 };
+    for (int i = 0; i < 3; ++i) {
+      AddRows(&table, keys);
+      for (integer_t key : keys) {
+        for (int j = 0; j < kNumCol; ++j) {
+          expected[key * kNumCol + j] += key * 10.0f + j;
+        }
+      }
+    }
+    BOOST_CHECK(GetAll(&table) == expected);
+    BOOST_CHECK_CLOSE(table.merge_ratio(), 4.5, 1e-9);
+    BOOST_CHECK_EQUAL(Dashboard::GetGauge("SERVER_ADD_MERGE_PERCENT[table " +
+      std::to_string(table.table_id()) + "]")->value(), 450);
+  }
+  MV_SetFlag("aggregate_adds", 0);
+}
+
+BOOST_AUTO_TEST_CASE(matrix_table_not_merges_nonlinear) {
+  MV_SetFlag("aggregate_adds", 4);
+  MV_SetFlag("updater_type", std::string("adagrad"));
+  {
+    MultiversoEnv env;
+    std::unique_ptr<Updater<float>> updater(Updater<float>::GetUpdater());
+    BOOST_CHECK(!updater->linear());
+    MatrixServerTable<float> table(kNumRow, kNumCol);
+    std::vector<integer_t> keys = { 1, 3, 1 };
+    AddRows(&table, keys);
+    AddRows(&table, keys);
+    BOOST_CHECK_EQUAL(table.merge_ratio(), 1.0);
+  }
+  MV_SetFlag("updater_type", std::string("default"));
+  MV_SetFlag("aggregate_adds", 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
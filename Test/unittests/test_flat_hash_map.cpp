@@ -0,0 +1,84 @@
+#include <unordered_map>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/util/flat_hash_map.h>
+
+namespace multiverso {
+namespace test {
+
+BOOST_AUTO_TEST_SUITE(flat_hash_map_test)
+
+BOOST_AUTO_TEST_CASE(flat_hash_map_grow) {
+  FlatHashMap<int, int> map;
+  std::unordered_map<int, int> reference;
+  for (int i = 0; i < 10000; ++i) {
+    int key = (i * 7919) % 5003 - 2500;  // repeated and negative keys
+    map[key] += i;
+    reference[key] += i;
+  }
+  BOOST_CHECK_EQUAL(map.size(), reference.size());
+  size_t visited = 0;
+  for (auto& kv : map) {
+    BOOST_CHECK_EQUAL(kv.second, reference[kv.first]);
+    ++visited;
+  }
+  BOOST_CHECK_EQUAL(visited, reference.size());
+  BOOST_CHECK(map.find(100000) == nullptr);
+  BOOST_CHECK_EQUAL(map.count(-2500), 1);
+
+  map.clear();
+  BOOST_CHECK(map.empty());
+  BOOST_CHECK(map.begin() == map.end());
+}
+
+BOOST_AUTO_TEST_CASE(flat_hash_map_batch) {
+  FlatHashMap<long long, float> map;
+  std::vector<long long> keys;
+  for (long long i = 0; i < 1000; ++i) keys.push_back(i * 1000003);
+  keys.push_back(keys[0]);
+
+  std::vector<float*> values(keys.size());
+  map.FindOrInsert(keys.data(), keys.size(), values.data());
+  BOOST_CHECK_EQUAL(map.size(), 1000);
+  BOOST_CHECK(values.front() == values.back());
+  for (size_t i = 0; i < keys.size(); ++i) *values[i] += 1.0f;
+
+  keys.push_back(-1);
+  std::vector<const float*> found(keys.size());
+  map.Find(keys.data(), keys.size(), found.data());
+  BOOST_CHECK_EQUAL(*found[0], 2.0f);
+  BOOST_CHECK_EQUAL(*found[1], 1.0f);
+  BOOST_CHECK(found.back() == nullptr);
+  BOOST_CHECK_EQUAL(map.size(), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(flat_hash_map_batch_present) {
+  FlatHashMap<int, int> map;
+  std::vector<int> keys;
+  for (int i = 0; i < 1000; ++i) map[i] = i;
+  // every key twice, all of them there already
+  for (int i = 0; i < 2000; ++i) keys.push_back(i % 1000);
+  int* first = map.find(0);
+
+  std::vector<int*> values(keys.size());
+  map.FindOrInsert(keys.data(), keys.size(), values.data());
+  // the map didn't grow, the slots stay in place
+  BOOST_CHECK(map.find(0) == first);
+  BOOST_CHECK_EQUAL(map.size(), 1000);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    BOOST_CHECK_EQUAL(*values[i], keys[i]);
+  }
+
+  // a batch with missing keys still grows as needed
+  for (int i = 0; i < 2000; ++i) keys.push_back(1000 + i);
+  values.resize(keys.size());
+  map.FindOrInsert(keys.data(), keys.size(), values.data());
+  BOOST_CHECK_EQUAL(map.size(), 3000);
+  BOOST_CHECK_EQUAL(*values[0], 0);
+  BOOST_CHECK_EQUAL(*values.back(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
@@ -0,0 +1,56 @@
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/util/key_codec.h>
+
+namespace multiverso {
+namespace test {
+
+BOOST_AUTO_TEST_SUITE(key_codec_test)
+
+BOOST_AUTO_TEST_CASE(codec_roundtrip) {
+  std::vector<int> sorted = { 0, 1, 2, 127, 128, 16384, 2147483647 };
+  std::vector<int> unsorted = { 5, -1, 1000000, 3, -2147483647 - 1, 0 };
+  std::vector<char> buffer(key_codec::MaxEncodedSize<int>(8));
+  std::vector<int> result(8);
+
+  size_t size = key_codec::Encode(sorted.data(), sorted.size(), true,
+                                  buffer.data());
+  BOOST_CHECK_EQUAL(key_codec::Decode(buffer.data(), sorted.size(), true,
+                                      result.data()), size);
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    BOOST_CHECK_EQUAL(result[i], sorted[i]);
+  }
+
+  size = key_codec::Encode(unsorted.data(), unsorted.size(), false,
+                           buffer.data());
+  BOOST_CHECK_EQUAL(key_codec::Decode(buffer.data(), unsorted.size(), false,
+                                      result.data()), size);
+  for (size_t i = 0; i < unsorted.size(); ++i) {
+    BOOST_CHECK_EQUAL(result[i], unsorted[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(codec_keys_blob) {
+  std::vector<integer_t> keys;
+  for (integer_t i = 0; i < 100; ++i) keys.push_back(i * 3);
+  Blob blob = key_codec::EncodeKeys(keys.data(), keys.size());
+  BOOST_CHECK(key_codec::IsEncoded(blob));
+  BOOST_CHECK(blob.size() < keys.size() * sizeof(integer_t));
+
+  std::vector<integer_t> buffer;
+  size_t count;
+  const integer_t* result = key_codec::DecodeKeys(blob, &count, &buffer);
+  BOOST_CHECK_EQUAL(count, keys.size());
+  for (size_t i = 0; i < count; ++i) BOOST_CHECK_EQUAL(result[i], keys[i]);
+
+  Blob plain(keys.data(), keys.size() * sizeof(integer_t));
+  BOOST_CHECK(!key_codec::IsEncoded(plain));
+  result = key_codec::DecodeKeys(plain, &count, &buffer);
+  BOOST_CHECK_EQUAL(count, keys.size());
+  BOOST_CHECK(result == reinterpret_cast<integer_t*>(plain.data()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
 #include <boost/test/unit_test.hpp>
+#include <multiverso/table/kv_embedding_table.h>
 #include <multiverso/table/kv_table.h>
 
 #include "multiverso_env.h"
@@ -6,6 +11,29 @@
 namespace multiverso {
 namespace test {
 
+namespace {
+
+class MemoryStream : public Stream {
+public:
+  void Write(const void* buf, size_t size) override {
+    data.append(static_cast<const char*>(buf), size);
+  }
+
+  size_t Read(void* buf, size_t size) override {
+    size = std::min(size, data.size() - pos);
+    memcpy(buf, data.data() + pos, size);
+    pos += size;
+    return size;
+  }
+
+  bool Good() override { return true; }
+
+  std::string data;
+  size_t pos = 0;
+};
+
+}  // namespace
+
 struct KVTableEnv : public MultiversoEnv {
   KVWorkerTable<int, int>* table;
 
@@ -38,6 +66,126 @@ BOOST_AUTO_TEST_CASE(access) {
   BOOST_CHECK_EQUAL(map[0], -1);
 }
 
+BOOST_AUTO_TEST_CASE(snapshots) {
+  KVTableOption<int, int> option;
+  option.incremental_snapshots = true;
+  KVServerTable<int, int> server(option), restored(option);
+  std::vector<int> keys, vals;
+  for (int i = 0; i < 1000; ++i) {
+    keys.push_back(i * 7 - 300);
+    vals.push_back(i);
+  }
+  server.ProcessAdd({ Blob(keys.data(), keys.size() * sizeof(int)),
+                      Blob(vals.data(), vals.size() * sizeof(int)) });
+  MemoryStream full, incremental;
+  server.Store(&full);
+  // varint keys take 1 byte instead of 4
+  BOOST_CHECK(full.data.size() < keys.size() * (sizeof(int) + 2) + 64);
+
+  std::vector<int> key = { 4 }, val = { 5 };
+  server.ProcessAdd({ Blob(key.data(), sizeof(int)),
+                      Blob(val.data(), sizeof(int)) });
+  server.StoreIncremental(&incremental);
+  BOOST_CHECK(incremental.data.size() < 64);
+
+  restored.Load(&full);
+  restored.Load(&incremental);
+  keys.push_back(4);
+  std::vector<Blob> result;
+  restored.ProcessGet({ Blob(keys.data(), keys.size() * sizeof(int)) },
+                      &result);
+  for (size_t i = 0; i < 1000; ++i) {
+    BOOST_CHECK_EQUAL(result[1].As<int>(i), keys[i] == 4 ? 5 : vals[i]);
+  }
+  BOOST_CHECK_EQUAL(result[1].As<int>(1000), 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_kv_local)
+
+BOOST_AUTO_TEST_CASE(negative_keys) {
+  MV_SetFlag("sync", false);
+  const int num_ranks = 2;
+  std::vector<std::vector<int>> values(num_ranks);
+
+  // the keys are spread on 2 servers
+  MV_RunLocal(num_ranks, [&](int rank) {
+    KVTableOption<int, int> option;
+    KVWorkerTable<int, int>* table = MV_CreateTable(option);
+    std::vector<int> keys = { -3, -4, 5 }, vals = { 1, 2, 3 };
+    table->Add(keys, vals);
+    MV_Barrier();
+    table->Get(keys);
+    for (int key : keys) values[rank].push_back(table->raw()[key]);
+    MV_Barrier();
+    delete table;
+  });
+
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    BOOST_CHECK(values[rank] == std::vector<int>({ 2, 4, 6 }));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+struct KVEmbeddingTableEnv : public MultiversoEnv {
+  KVEmbeddingWorkerTable<int64_t, float>* table;
+
+  KVEmbeddingTableEnv() : MultiversoEnv() {
+    KVEmbeddingTableOption<int64_t, float> option(4);
+    table = MV_CreateTable(option);
+  }
+
+  ~KVEmbeddingTableEnv() {
+    delete table;
+    table = nullptr;
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE(test_kv_embedding, KVEmbeddingTableEnv)
+
+BOOST_AUTO_TEST_CASE(embedding_access) {
+  std::vector<int64_t> keys = { 5, -3, 1LL << 40, 5 };
+  std::vector<float> values(keys.size() * 4, 1), deltas(values.size());
+  table->Get(keys, values.data());
+  for (float v : values) BOOST_CHECK_EQUAL(v, 0);
+
+  for (size_t i = 0; i < deltas.size(); ++i) deltas[i] = static_cast<float>(i);
+  table->Add(keys, deltas.data());
+  table->Get(keys, values.data());
+  for (size_t i = 0; i < 4; ++i) {
+    // key 5 was Added twice
+    BOOST_CHECK_EQUAL(values[i], deltas[i] + deltas[12 + i]);
+    BOOST_CHECK_EQUAL(values[12 + i], values[i]);
+    BOOST_CHECK_EQUAL(values[4 + i], deltas[4 + i]);
+    BOOST_CHECK_EQUAL(values[8 + i], deltas[8 + i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(embedding_snapshots) {
+  KVEmbeddingTableOption<int64_t, float> option(3, -1, 1);
+  KVEmbeddingServerTable<int64_t, float> server(option), restored(option);
+  std::vector<int64_t> keys;
+  for (int64_t i = 0; i < 10000; ++i) keys.push_back(i * 13);
+  std::vector<Blob> values, loaded;
+  server.ProcessGet({ Blob(keys.data(), keys.size() * sizeof(int64_t)) },
+                    &values);
+  BOOST_CHECK_EQUAL(server.size(), keys.size());
+  for (size_t i = 0; i < keys.size() * 3; ++i) {
+    BOOST_CHECK(values[1].As<float>(i) >= -1 && values[1].As<float>(i) < 1);
+  }
+
+  MemoryStream stream;
+  server.Store(&stream);
+  restored.Load(&stream);
+  restored.ProcessGet({ Blob(keys.data(), keys.size() * sizeof(int64_t)) },
+                      &loaded);
+  BOOST_CHECK_EQUAL(restored.size(), keys.size());
+  for (size_t i = 0; i < keys.size() * 3; ++i) {
+    BOOST_CHECK_EQUAL(loaded[1].As<float>(i), values[1].As<float>(i));
+  }
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
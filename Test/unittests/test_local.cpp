@@ -0,0 +1,147 @@
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/multiverso.h>
+#include <multiverso/table/array_table.h>
+#include <multiverso/table/matrix_table.h>
+#include <multiverso/util/log.h>
+
+namespace multiverso {
+namespace test {
+
+BOOST_AUTO_TEST_SUITE(local_test)
+
+BOOST_AUTO_TEST_CASE(local_array) {
+  MV_SetFlag("sync", false);
+  const int num_ranks = 3;
+  const int size = 10;
+  std::vector<int> ranks(num_ranks, -1), sizes(num_ranks, -1);
+  std::vector<std::vector<int>> models(num_ranks, std::vector<int>(size));
+
+  MV_RunLocal(num_ranks, [&](int rank) {
+    ranks[rank] = MV_Rank();
+    sizes[rank] = MV_Size();
+    ArrayTableOption<int> option(size);
+    ArrayWorker<int>* table = MV_CreateTable(option);
+    std::vector<int> delta(size);
+    for (int i = 0; i < size; ++i) delta[i] = i;
+    table->Add(delta.data(), delta.size());
+    MV_Barrier();
+    table->Get(models[rank].data(), size);
+    delete table;
+  });
+
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    BOOST_CHECK_EQUAL(ranks[rank], rank);
+    BOOST_CHECK_EQUAL(sizes[rank], num_ranks);
+    for (int i = 0; i < size; ++i) {
+      BOOST_CHECK_EQUAL(models[rank][i], num_ranks * i);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(local_matrix_delta_gets) {
+  MV_SetFlag("sync", false);
+  const int num_ranks = 2;
+  const int num_row = 11, num_col = 3;
+  std::vector<std::vector<int>> models(num_ranks,
+    std::vector<int>(num_row * num_col, -1));
+
+  MV_RunLocal(num_ranks, [&](int rank) {
+    MatrixTableOption<int> option(num_row, num_col);
+    option.delta_gets = true;
+    MatrixWorkerTable<int>* table = MV_CreateTable(option);
+    std::vector<int>& model = models[rank];
+    std::vector<int> delta(num_col, 1);
+    // a first Get with all the rows, then ones with the changed rows only
+    for (integer_t row : { 0, 5, 10 }) {
+      table->Add(row, delta.data(), num_col);
+      MV_Barrier();
+      table->Get(model.data(), model.size());
+      MV_Barrier();
+    }
+    delete table;
+  });
+
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    for (int row = 0; row < num_row; ++row) {
+      int expected = (row == 0 || row == 5 || row == 10) ? num_ranks : 0;
+      BOOST_CHECK_EQUAL(models[rank][row * num_col], expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(local_matrix_delta_gets_new_buffer) {
+  MV_SetFlag("sync", false);
+  const int num_ranks = 2;
+  const int num_row = 6, num_col = 2;
+  std::vector<std::vector<int>> models(num_ranks);
+
+  MV_RunLocal(num_ranks, [&](int rank) {
+    MatrixTableOption<int> option(num_row, num_col);
+    option.delta_gets = true;
+    MatrixWorkerTable<int>* table = MV_CreateTable(option);
+    std::vector<int> delta(num_row * num_col, 1), model(num_row * num_col);
+    table->Add(delta.data(), delta.size());
+    MV_Barrier();
+    table->Get(model.data(), model.size());
+    MV_Barrier();
+    // nothing changed since, still all the rows in another buffer
+    models[rank].assign(num_row * num_col, -1);
+    table->Get(models[rank].data(), models[rank].size());
+    MV_Barrier();
+    delete table;
+  });
+
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    for (int i = 0; i < num_row * num_col; ++i) {
+      BOOST_CHECK_EQUAL(models[rank][i], num_ranks);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(local_async_log) {
+  MV_SetFlag("sync", false);
+  MV_SetFlag("log_async_buffer", 1024);
+  const int num_ranks = 3;
+  std::vector<int> done(num_ranks);
+
+  // the ranks share the log sink while the others stop
+  MV_RunLocal(num_ranks, [&](int rank) {
+    for (int i = 0; i < 100; ++i) Log::Info("rank %d message %d\n", rank, i);
+    done[rank] = 1;
+  });
+  MV_SetFlag("log_async_buffer", 0);
+
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    BOOST_CHECK_EQUAL(done[rank], 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(local_aggregate) {
+  MV_SetFlag("sync", false);
+  const int num_ranks = 3;
+  const int size = 5;
+  std::vector<std::vector<double>> sums(num_ranks);
+
+  MV_RunLocal(num_ranks, [&](int rank) {
+    std::vector<double>& data = sums[rank];
+    // several rounds, the buffer of a round isn't mixed with the next one
+    for (int round = 0; round < 3; ++round) {
+      data.assign(size, 0);
+      for (int i = 0; i < size; ++i) data[i] = rank * 10 + i + round;
+      MV_Aggregate(data.data(), size);
+    }
+  });
+
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    for (int i = 0; i < size; ++i) {
+      // ranks 0, 1 and 2 at the last round
+      BOOST_CHECK_EQUAL(sums[rank][i], 30 + 3 * (i + 2));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
@@ -0,0 +1,71 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/util/log.h>
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+int Count(int* calls) { return ++*calls; }
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(log_test)
+
+BOOST_AUTO_TEST_CASE(level_checked) {
+  int calls = 0;
+  Log::ResetLogLevel(LogLevel::Info);
+  BOOST_CHECK(!Log::IsEnabled(LogLevel::Debug));
+  MV_LOG_DEBUG("not written %d\n", Count(&calls));
+  BOOST_CHECK_EQUAL(calls, 0);
+  BOOST_CHECK(Log::IsEnabled(LogLevel::Error));
+  MV_LOG_ERROR("level_checked %d\n", Count(&calls));
+  BOOST_CHECK_EQUAL(calls, 1);
+}
+
+BOOST_AUTO_TEST_CASE(async_sink) {
+  const std::string path = "test_log_async.log";
+  const int kThreads = 4, kMessages = 100;
+  Log::ResetLogLevel(LogLevel::Info);
+  BOOST_CHECK_EQUAL(Log::ResetLogFile(path), 0);
+  Log::StartAsync(kThreads * kMessages);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.push_back(std::thread([t]() {
+      for (int i = 0; i < kMessages; ++i) {
+        MV_LOG_INFO("async %d %d\n", t, i);
+      }
+    }));
+  }
+  for (auto& thread : threads) thread.join();
+  Log::StopAsync();
+  Log::ResetLogFile("");
+
+  std::string log = ReadFile(path);
+  for (int t = 0; t < kThreads; ++t) {
+    for (int i = 0; i < kMessages; ++i) {
+      std::string line = "] async " + std::to_string(t) + " " +
+        std::to_string(i) + "\n";
+      BOOST_CHECK(log.find(line) != std::string::npos);
+    }
+  }
+  std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
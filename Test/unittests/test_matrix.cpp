@@ -0,0 +1,72 @@
+#include <memory>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/table/matrix_table.h>
+#include <multiverso/table/sparse_matrix_table.h>
+#include <multiverso/updater/updater.h>
+
+#include "multiverso_env.h"
+
+namespace multiverso {
+namespace test {
+
+BOOST_AUTO_TEST_SUITE(matrix_test)
+
+BOOST_AUTO_TEST_CASE(parallel_rows) {
+  const int num_row = 37, num_col = 3;
+  MV_SetFlag("matrix_parallel_rows", 1);
+  {
+    MultiversoEnv env;
+    MatrixServerTable<int> table(num_row, num_col);
+    // every row twice, some of them more
+    std::vector<integer_t> keys;
+    std::vector<int> values, expected(num_row * num_col);
+    for (int i = 0; i < 3 * num_row; ++i) {
+      integer_t row = (i * 5) % num_row;
+      keys.push_back(row);
+      for (int j = 0; j < num_col; ++j) {
+        values.push_back(i + j);
+        expected[row * num_col + j] += i + j;
+      }
+    }
+    table.ProcessAdd({ Blob(keys.data(), keys.size() * sizeof(integer_t)),
+                       Blob(values.data(), values.size() * sizeof(int)) });
+
+    integer_t all = -1;
+    std::vector<Blob> result;
+    table.ProcessGet({ Blob(&all, sizeof(integer_t)) }, &result);
+    for (int i = 0; i < num_row * num_col; ++i) {
+      BOOST_CHECK_EQUAL(result[1].As<int>(i), expected[i]);
+    }
+  }
+  MV_SetFlag("matrix_parallel_rows", 1024);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_formats) {
+  const int num_row = 8, num_col = 50;
+  for (int format : { 1, 2 }) {
+    MV_SetFlag("sparse_format", format);
+    MultiversoEnv env;
+    SparseMatrixServerTable<float> server(num_row, num_col, false);
+    std::unique_ptr<SparseMatrixWorkerTable<float>> table(
+      new SparseMatrixWorkerTable<float>(num_row, num_col));
+    AddOption add_option;
+    add_option.set_worker_id(0);
+    GetOption get_option;
+    get_option.set_worker_id(0);
+    // sparse enough to be compressed
+    std::vector<float> delta(num_row * num_col), model(num_row * num_col);
+    for (int i = 0; i < num_row * num_col; i += 7) delta[i] = i + 1.0f;
+    table->Add(delta.data(), delta.size(), &add_option);
+    table->Get(model.data(), model.size(), &get_option);
+    for (int i = 0; i < num_row * num_col; ++i) {
+      BOOST_CHECK_EQUAL(model[i], delta[i]);
+    }
+  }
+  MV_SetFlag("sparse_format", 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
@@ -9,6 +9,7 @@ BOOST_AUTO_TEST_SUITE(message)
 BOOST_AUTO_TEST_CASE(message_access) {
   multiverso::Message msg;
   BOOST_CHECK_EQUAL(msg.data().size(), 0);
+  BOOST_CHECK_EQUAL(msg.trace_id(), 0);
 
   msg.set_msg_id(0);
   BOOST_CHECK_EQUAL(msg.msg_id(), 0);
@@ -20,6 +21,8 @@ BOOST_AUTO_TEST_CASE(message_access) {
   BOOST_CHECK_EQUAL(msg.table_id(), 3);
   msg.set_type(MsgType::Request_Get);
   BOOST_CHECK_EQUAL(msg.type(), MsgType::Request_Get);
+  msg.set_trace_id(4);
+  BOOST_CHECK_EQUAL(msg.trace_id(), 4);
 
   BOOST_TEST_MESSAGE("before blob\n");
 
@@ -37,6 +40,7 @@ BOOST_AUTO_TEST_CASE(message_access) {
   BOOST_CHECK_EQUAL(reply_msg->src(), msg.dst());
   BOOST_CHECK_EQUAL(reply_msg->dst(), msg.src());
   BOOST_CHECK_EQUAL(reply_msg->type(), MsgType::Reply_Get);
+  BOOST_CHECK_EQUAL(reply_msg->trace_id(), msg.trace_id());
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/io/io.h>
+#include <multiverso/io/mmap_stream.h>
+#include <multiverso/table/mapped_storage.h>
+
+namespace multiverso {
+
+namespace test {
+
+namespace {
+
+const char* kPath = "test_mmap_stream.bin";
+
+// a header int followed by values 0, 1, ...
+std::vector<float> WriteValues(size_t size) {
+  std::vector<float> values(size);
+  for (size_t i = 0; i < size; ++i) values[i] = static_cast<float>(i);
+  std::unique_ptr<Stream> stream(StreamFactory::GetStream(URI(kPath),
+    FileOpenMode::BinaryWrite));
+  int header = static_cast<int>(size);
+  stream->Write(&header, sizeof(header));
+  stream->Write(values.data(), values.size() * sizeof(float));
+  return values;
+}
+
+Stream* OpenMmap(const std::string& options) {
+  return StreamFactory::GetStream(URI(std::string("mmap://") + kPath +
+    options), FileOpenMode::BinaryRead);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(mmap_stream)
+
+BOOST_AUTO_TEST_CASE(read) {
+  std::vector<float> values = WriteValues(1000);
+  for (std::string options : { "", "?advice=sequential", "?private=true" }) {
+    std::unique_ptr<Stream> stream(OpenMmap(options));
+    BOOST_CHECK(stream->Good());
+    MmapStream* mmap = dynamic_cast<MmapStream*>(stream.get());
+    BOOST_REQUIRE(mmap != nullptr);
+    BOOST_CHECK_EQUAL(mmap->size(), sizeof(int) + 1000 * sizeof(float));
+
+    int header;
+    BOOST_CHECK_EQUAL(stream->Read(&header, sizeof(header)), sizeof(header));
+    BOOST_CHECK_EQUAL(header, 1000);
+    std::vector<float> read(1000);
+    BOOST_CHECK_EQUAL(stream->Read(read.data(), 10 * sizeof(float)),
+      10 * sizeof(float));
+    const float* next = reinterpret_cast<const float*>(
+      mmap->Next(990 * sizeof(float)));
+    BOOST_REQUIRE(next != nullptr);
+    std::copy(next, next + 990, read.begin() + 10);
+    BOOST_CHECK(read == values);
+    BOOST_CHECK(mmap->Next(1) == nullptr);
+    BOOST_CHECK_EQUAL(stream->Read(&header, sizeof(header)), 0);
+
+    mmap->Seek(0);
+    BOOST_CHECK_EQUAL(mmap->position(), 0);
+    BOOST_CHECK_EQUAL(stream->Read(&header, sizeof(header)), sizeof(header));
+    BOOST_CHECK_EQUAL(header, 1000);
+  }
+  std::remove(kPath);
+}
+
+BOOST_AUTO_TEST_CASE(adopt) {
+  std::vector<float> values = WriteValues(1000);
+  MappedStorage<float> storage;
+  storage.resize(1000);
+  {
+    // shared mapping, read in
+    std::unique_ptr<Stream> stream(OpenMmap(""));
+    int header;
+    stream->Read(&header, sizeof(header));
+    storage.Load(stream.get());
+    BOOST_CHECK(!storage.mapped());
+    BOOST_CHECK(std::vector<float>(storage.data(), storage.data() + 1000) ==
+      values);
+  }
+  {
+    // private mapping, adopted in place, and still valid after the stream
+    std::unique_ptr<Stream> stream(OpenMmap("?private=true&advice=random"));
+    int header;
+    stream->Read(&header, sizeof(header));
+    storage.Load(stream.get());
+    BOOST_CHECK(storage.mapped());
+    BOOST_CHECK_EQUAL(reinterpret_cast<char*>(storage.data()),
+      dynamic_cast<MmapStream*>(stream.get())->data() + sizeof(header));
+  }
+  BOOST_CHECK_EQUAL(storage.size(), 1000);
+  BOOST_CHECK(std::vector<float>(storage.data(), storage.data() + 1000) ==
+    values);
+  // writes are copied on write and never reach the file
+  storage[0] = -1;
+  std::unique_ptr<Stream> stream(OpenMmap(""));
+  int header;
+  float first;
+  stream->Read(&header, sizeof(header));
+  stream->Read(&first, sizeof(first));
+  BOOST_CHECK_EQUAL(first, 0);
+  std::remove(kPath);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+
+}  // namespace multiverso
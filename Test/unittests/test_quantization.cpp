@@ -0,0 +1,164 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/util/quantization_util.h>
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+const size_t kNumRow = 7, kRowSize = 37;
+
+std::vector<float> RandomRows(unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(-1, 1);
+  std::vector<float> values(kNumRow * kRowSize);
+  for (auto& v : values) v = dist(gen);
+  return values;
+}
+
+// Encodes a copy of values and checks that decoded + lost == values
+Blob CheckRoundTrip(DeltaFilter<float>* filter,
+                    const std::vector<float>& values) {
+  std::vector<float> rest = values;
+  std::vector<float*> rows;
+  for (size_t r = 0; r < kNumRow; ++r) rows.push_back(&rest[r * kRowSize]);
+  Blob blob = filter->Encode(rows.data(), kNumRow);
+  BOOST_CHECK_EQUAL(DeltaFilter<float>::DecodedSize(blob), values.size());
+  std::vector<float> decoded(values.size());
+  DeltaFilter<float>::Decode(blob, decoded.data());
+  for (size_t i = 0; i < values.size(); ++i) {
+    BOOST_CHECK_CLOSE_FRACTION(decoded[i] + rest[i], values[i], 1e-4);
+  }
+  return blob;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(quantization_test)
+
+BOOST_AUTO_TEST_CASE(topk_per_row) {
+  std::vector<float> values = RandomRows(1);
+  TopKFilter<float> filter(0.1, kRowSize, true);
+  Blob blob = CheckRoundTrip(&filter, values);
+  std::vector<float> decoded(values.size());
+  DeltaFilter<float>::Decode(blob, decoded.data());
+  for (size_t r = 0; r < kNumRow; ++r) {
+    // 4 values kept, none smaller than a dropped one
+    float min_kept = 2, max_dropped = 0;
+    int kept = 0;
+    for (size_t i = r * kRowSize; i < (r + 1) * kRowSize; ++i) {
+      if (decoded[i] != 0) {
+        ++kept;
+        min_kept = std::min(min_kept, std::abs(values[i]));
+      } else {
+        max_dropped = std::max(max_dropped, std::abs(values[i]));
+      }
+    }
+    BOOST_CHECK_EQUAL(kept, 4);
+    BOOST_CHECK(min_kept >= max_dropped);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(topk_per_blob) {
+  std::vector<float> values = RandomRows(2);
+  TopKFilter<float> filter(0.5, kRowSize, false);
+  Blob blob = CheckRoundTrip(&filter, values);
+  BOOST_CHECK(blob.size() < values.size() * sizeof(float) + 64);
+}
+
+BOOST_AUTO_TEST_CASE(quantize_bits) {
+  std::vector<float> values = RandomRows(3);
+  for (int bits : { 1, 2 }) {
+    OneBitsFilter<float> filter(kRowSize, bits);
+    Blob blob = CheckRoundTrip(&filter, values);
+    BOOST_CHECK_EQUAL(blob.size(), kDeltaFilterHeader + kNumRow *
+      (2 * sizeof(float) + OneBitsFilter<float>::RowBytes(kRowSize, bits)));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(filter_blobs) {
+  std::vector<float> values = RandomRows(4);
+  std::vector<int> keys = { 1, 2, 3, 4, 5, 6, 7 };
+  std::vector<Blob> blobs = { Blob(keys.data(), keys.size() * sizeof(int)),
+    Blob(values.data(), values.size() * sizeof(float)) }, encoded, decoded;
+  OneBitsFilter<float> filter(kRowSize, 2);
+  filter.FilterIn(blobs, &encoded);
+  filter.FilterOut(encoded, &decoded);
+  BOOST_CHECK_EQUAL(decoded.size(), 2);
+  BOOST_CHECK_EQUAL(decoded[1].size(), blobs[1].size());
+  // FilterIn leaves its input untouched
+  BOOST_CHECK_EQUAL(blobs[1].As<float>(0), values[0]);
+}
+
+BOOST_AUTO_TEST_CASE(sparse_versions) {
+  std::vector<float> sparse(100, 0), dense(100, 1);
+  sparse[3] = 1.5;
+  sparse[97] = -2;
+  std::vector<int> keys = { 1 };
+  std::vector<Blob> blobs = { Blob(keys.data(), sizeof(int)),
+    Blob(sparse.data(), sparse.size() * sizeof(float)),
+    Blob(dense.data(), dense.size() * sizeof(float)),
+    Blob(keys.data(), sizeof(int)) };
+  SparseFilter<float, int32_t> v1(0, true, 1), v2(0, true);
+  for (auto filter : { &v1, &v2 }) {
+    std::vector<Blob> encoded, decoded;
+    filter->FilterIn(blobs, &encoded);
+    BOOST_CHECK_EQUAL(encoded.size(), 5);
+    BOOST_CHECK(encoded[2].size() < blobs[1].size());
+    BOOST_CHECK_EQUAL(encoded[1].As<int32_t>(1), -1);
+    // either filter reads both versions
+    v2.FilterOut(encoded, &decoded);
+    BOOST_CHECK_EQUAL(decoded.size(), 4);
+    for (size_t i = 0; i < sparse.size(); ++i) {
+      BOOST_CHECK_EQUAL(decoded[1].As<float>(i), sparse[i]);
+      BOOST_CHECK_EQUAL(decoded[2].As<float>(i), dense[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sparse_compaction) {
+  // over the SSE blocks and the tail, for float and double
+  std::vector<int> keys = { 1 };
+  SparseFilter<float, int32_t> float_filter(0);
+  SparseFilter<double, int32_t> double_filter(0);
+  for (size_t size : { 3, 4, 37, 1000 }) {
+    std::vector<float> values(size, 0);
+    std::vector<double> doubles(size, 0);
+    for (size_t i = 0; i < size; i += 7) doubles[i] = values[i] = i % 2 ? 1 : -1;
+    std::vector<Blob> blobs = { Blob(keys.data(), sizeof(int)),
+      Blob(values.data(), size * sizeof(float)) }, encoded, decoded;
+    float_filter.FilterIn(blobs, &encoded);
+    BOOST_CHECK_EQUAL(encoded[1].As<int32_t>(0),
+                      -2 - static_cast<int32_t>(size * sizeof(float)));
+    float_filter.FilterOut(encoded, &decoded);
+    for (size_t i = 0; i < size; ++i) {
+      BOOST_CHECK_EQUAL(decoded[1].As<float>(i), values[i]);
+    }
+
+    blobs[1] = Blob(doubles.data(), size * sizeof(double));
+    double_filter.FilterIn(blobs, &encoded);
+    double_filter.FilterOut(encoded, &decoded);
+    for (size_t i = 0; i < size; ++i) {
+      BOOST_CHECK_EQUAL(decoded[1].As<double>(i), doubles[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sparse_empty) {
+  std::vector<int> keys = { 1 };
+  std::vector<Blob> blobs = { Blob(keys.data(), sizeof(int)), Blob() },
+    encoded, decoded;
+  SparseFilter<float, int32_t> filter(0);
+  filter.FilterIn(blobs, &encoded);
+  filter.FilterOut(encoded, &decoded);
+  BOOST_CHECK_EQUAL(decoded.size(), 2);
+  BOOST_CHECK_EQUAL(decoded[1].size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
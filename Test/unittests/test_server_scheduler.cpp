@@ -0,0 +1,59 @@
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/server_scheduler.h>
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+// Pushes the requests below to a scheduler of policy, in this order, and
+// returns the ids in serving order
+//   id:     0    1    2    3    4
+//   source: 0    1    1    1    0
+//   type:   Add  Get  Get  Get  Add
+std::vector<int> Serve(const std::string& policy, int get_weight = 1) {
+  ServerScheduler scheduler(policy, 2, get_weight);
+  const int sources[] = { 0, 1, 1, 1, 0 };
+  for (int id = 0; id < 5; ++id) {
+    MessagePtr msg(new Message());
+    msg->set_src(sources[id]);
+    msg->set_type(sources[id] == 1 ? MsgType::Request_Get :
+                  MsgType::Request_Add);
+    msg->set_msg_id(id);
+    scheduler.Push(msg);
+  }
+  std::vector<int> order;
+  MessagePtr msg;
+  while (scheduler.Pop(&msg)) order.push_back(msg->msg_id());
+  BOOST_CHECK(scheduler.Empty());
+  return order;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(server_scheduler)
+
+BOOST_AUTO_TEST_CASE(fifo) {
+  BOOST_CHECK(Serve("fifo") == std::vector<int>({ 0, 1, 2, 3, 4 }));
+}
+
+BOOST_AUTO_TEST_CASE(get_first) {
+  BOOST_CHECK(Serve("get_first") == std::vector<int>({ 1, 2, 3, 0, 4 }));
+}
+
+BOOST_AUTO_TEST_CASE(weighted) {
+  // get_weight Gets for each Add while both wait
+  BOOST_CHECK(Serve("weighted", 1) == std::vector<int>({ 1, 0, 2, 4, 3 }));
+  BOOST_CHECK(Serve("weighted", 2) == std::vector<int>({ 1, 2, 0, 3, 4 }));
+}
+
+BOOST_AUTO_TEST_CASE(round_robin) {
+  BOOST_CHECK(Serve("round_robin") == std::vector<int>({ 0, 1, 4, 2, 3 }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
@@ -0,0 +1,241 @@
+#ifndef _WIN32
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/net/shm_net.h>
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+const size_t kCapacity = 16;
+
+// Ring on a segment of the process memory
+struct RingSegment {
+  RingSegment() {
+    producer.Attach(segment, kCapacity, true);
+    consumer.Attach(segment, kCapacity, false);
+  }
+
+  alignas(64) char segment[sizeof(ShmRing::Header) + kCapacity];
+  ShmRing producer;
+  ShmRing consumer;
+};
+
+// Raw channel between the ranks of a process, the only part of the
+// underlying net ShmNetWrapper uses among ranks of one host
+class RawNet : public NetInterface {
+public:
+  struct Channel {
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::string> packets;
+  };
+
+  RawNet(int rank, std::vector<Channel>* channels)
+    : rank_(rank), channels_(channels), poll_timeout_(-1) {}
+
+  void Init(int*, char**) override {}
+  void Finalize() override {}
+  int Bind(int, char*) override { return -1; }
+  int Connect(int*, char* [], int) override { return -1; }
+  bool active() const override { return true; }
+  std::string name() const override { return "Raw"; }
+  int size() const override { return static_cast<int>(channels_->size()); }
+  int rank() const override { return rank_; }
+  int Send(MessagePtr&) override { return 0; }
+  int Recv(MessagePtr*) override { return 0; }
+
+  // nothing ever arrives on the raw net
+  bool Poll(int timeout_ms) override {
+    poll_timeout_ = timeout_ms;
+    return false;
+  }
+  int poll_timeout() const { return poll_timeout_; }
+
+  void SendTo(int rank, char* buf, int len) const override {
+    Channel& channel = (*channels_)[rank];
+    std::lock_guard<std::mutex> lock(channel.m);
+    channel.packets.push_back(std::string(buf, len));
+    channel.cv.notify_all();
+  }
+
+  // from any rank, as ZMQ
+  void RecvFrom(int, char* buf, int len) const override {
+    Channel& channel = (*channels_)[rank_];
+    std::unique_lock<std::mutex> lock(channel.m);
+    while (channel.packets.empty()) channel.cv.wait(lock);
+    CHECK(channel.packets.front().size() == static_cast<size_t>(len));
+    memcpy(buf, channel.packets.front().data(), len);
+    channel.packets.pop_front();
+  }
+
+  void SendRecv(int, char*, int, int, char*, int) const override {}
+  int thread_level_support() override {
+    return NetThreadLevel::THREAD_MULTIPLE;
+  }
+
+private:
+  int rank_;
+  std::vector<Channel>* channels_;
+  int poll_timeout_;
+};
+
+MessagePtr NewMessage(int src, int dst, int id, size_t size) {
+  MessagePtr msg(new Message());
+  msg->set_src(src);
+  msg->set_dst(dst);
+  msg->set_type(MsgType::Request_Add);
+  msg->set_msg_id(id);
+  Blob blob(size);
+  for (size_t i = 0; i < size; ++i) {
+    blob.data()[i] = static_cast<char>(i * 7 + id);
+  }
+  msg->Push(blob);
+  msg->Push(Blob());
+  return msg;
+}
+
+// Receives the next message from net, keeping the pending sends moving
+MessagePtr Receive(NetInterface* net) {
+  MessagePtr msg;
+  while (net->Recv(&msg) == 0) std::this_thread::yield();
+  return msg;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(shm_net)
+
+BOOST_AUTO_TEST_CASE(ring_empty) {
+  RingSegment ring;
+  char buf[kCapacity];
+  BOOST_CHECK_EQUAL(ring.consumer.Read(buf, sizeof(buf)), 0);
+  BOOST_CHECK_EQUAL(ring.producer.Write("ab", 2), 2);
+  BOOST_CHECK_EQUAL(ring.consumer.Read(buf, sizeof(buf)), 2);
+  BOOST_CHECK_EQUAL(ring.consumer.Read(buf, sizeof(buf)), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ring_full) {
+  RingSegment ring;
+  std::string text = "0123456789abcdefghij";
+  BOOST_CHECK_EQUAL(ring.producer.Write(text.data(), text.size()), kCapacity);
+  BOOST_CHECK_EQUAL(ring.producer.Write(text.data(), text.size()), 0);
+  char buf[4];
+  BOOST_CHECK_EQUAL(ring.consumer.Read(buf, sizeof(buf)), 4);
+  BOOST_CHECK_EQUAL(std::string(buf, 4), "0123");
+  // only the room freed by the read
+  BOOST_CHECK_EQUAL(ring.producer.Write(text.data(), text.size()), 4);
+}
+
+BOOST_AUTO_TEST_CASE(ring_wraparound) {
+  RingSegment ring;
+  std::string text = "0123456789abcdefghij";
+  char buf[kCapacity];
+  for (size_t round = 0; round < 10; ++round) {
+    // 11 bytes at each round, wrapping at different offsets
+    BOOST_REQUIRE_EQUAL(ring.producer.Write(text.data() + round, 11), 11);
+    BOOST_REQUIRE_EQUAL(ring.consumer.Read(buf, sizeof(buf)), 11);
+    BOOST_CHECK_EQUAL(std::string(buf, 11), text.substr(round, 11));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ring_threads) {
+  RingSegment ring;
+  const size_t kBytes = 100000;
+  std::thread producer([&ring]() {
+    for (size_t sent = 0; sent < kBytes; ) {
+      char buf[7];
+      for (size_t i = 0; i < sizeof(buf); ++i) {
+        buf[i] = static_cast<char>((sent + i) % 251);
+      }
+      sent += ring.producer.Write(buf, std::min(sizeof(buf), kBytes - sent));
+    }
+  });
+  std::vector<char> received;
+  while (received.size() < kBytes) {
+    char buf[5];
+    size_t n = ring.consumer.Read(buf, sizeof(buf));
+    received.insert(received.end(), buf, buf + n);
+  }
+  producer.join();
+  bool ordered = true;
+  for (size_t i = 0; i < kBytes; ++i) {
+    ordered = ordered && received[i] == static_cast<char>(i % 251);
+  }
+  BOOST_CHECK(ordered);
+}
+
+BOOST_AUTO_TEST_CASE(wrapper_round_trip) {
+  std::vector<RawNet::Channel> channels(2);
+  RawNet raw0(0, &channels), raw1(1, &channels);
+  ShmNetWrapper net0(&raw0, 1), net1(&raw1, 1);
+  // larger than the ring, so streamed by the later Recv calls
+  const size_t kLarge = 3 << 20;
+
+  MessagePtr small, large;
+  std::thread rank1([&]() {
+    net1.Init(nullptr, nullptr);
+    small = Receive(&net1);
+    large = Receive(&net1);
+    MessagePtr ack = NewMessage(1, 0, 3, 10);
+    net1.Send(ack);
+  });
+  net0.Init(nullptr, nullptr);
+  MessagePtr sent = NewMessage(0, 1, 1, 100);
+  net0.Send(sent);
+  sent = NewMessage(0, 1, 2, kLarge);
+  net0.Send(sent);
+  MessagePtr ack = Receive(&net0);
+  rank1.join();
+  net0.Finalize();
+  net1.Finalize();
+
+  BOOST_CHECK_EQUAL(ack->msg_id(), 3);
+  BOOST_CHECK_EQUAL(small->msg_id(), 1);
+  BOOST_CHECK_EQUAL(small->data()[0].size(), 100);
+  BOOST_CHECK_EQUAL(large->msg_id(), 2);
+  BOOST_CHECK(large->type() == MsgType::Request_Add);
+  BOOST_CHECK_EQUAL(large->src(), 0);
+  BOOST_CHECK_EQUAL(large->dst(), 1);
+  BOOST_REQUIRE_EQUAL(large->size(), 2);
+  BOOST_CHECK_EQUAL(large->data()[1].size(), 0);
+  MessagePtr expected = NewMessage(0, 1, 2, kLarge);
+  BOOST_CHECK(memcmp(large->data()[0].data(), expected->data()[0].data(),
+                     kLarge) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(wrapper_poll) {
+  std::vector<RawNet::Channel> channels(2);
+  RawNet raw0(0, &channels), raw1(1, &channels);
+  ShmNetWrapper net0(&raw0, 1), net1(&raw1, 1);
+  std::thread rank1([&]() { net1.Init(nullptr, nullptr); });
+  net0.Init(nullptr, nullptr);
+  rank1.join();
+
+  // nothing pending, waits on the raw net a slice of the timeout
+  BOOST_CHECK(!net1.Poll(100));
+  BOOST_CHECK_EQUAL(raw1.poll_timeout(), 1);
+  MessagePtr sent = NewMessage(0, 1, 1, 100);
+  net0.Send(sent);
+  // the ring has data, no wait
+  BOOST_CHECK(net1.Poll(100));
+  BOOST_CHECK_EQUAL(raw1.poll_timeout(), 1);
+  BOOST_CHECK_EQUAL(Receive(&net1)->msg_id(), 1);
+  BOOST_CHECK(!net1.Poll(100));
+  net0.Finalize();
+  net1.Finalize();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
+
+#endif  // _WIN32
@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/io/io.h>
+#include <multiverso/table/array_table.h>
+#include <multiverso/table/snapshot.h>
+
+#include "multiverso_env.h"
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+std::vector<int> ReadInts(const std::string& path, size_t size) {
+  std::vector<int> values(size + 1);
+  std::unique_ptr<Stream> stream(StreamFactory::GetStream(URI(path),
+    FileOpenMode::BinaryRead));
+  values.resize(stream->Read(values.data(), values.size() * sizeof(int)) /
+    sizeof(int));
+  return values;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(snapshot)
+
+BOOST_AUTO_TEST_CASE(copy_on_write) {
+  const std::string kPath = "test_snapshot.bin";
+  const size_t kSize = 100000;
+  std::vector<int> values(kSize), expected(kSize);
+  for (size_t i = 0; i < kSize; ++i) values[i] = expected[i] = i;
+
+  {
+    Snapshot snapshot(values.data(), kSize * sizeof(int),
+      StreamFactory::GetStream(URI(kPath), FileOpenMode::BinaryWrite), 1000);
+    // changes the values while they are written, from the end
+    for (size_t i = kSize; i-- > 0; ) {
+      snapshot.Touch(i * sizeof(int), sizeof(int));
+      values[i] = -1;
+    }
+    snapshot.Wait();
+    BOOST_CHECK(snapshot.done());
+    BOOST_CHECK_EQUAL(snapshot.bytes(), kSize * sizeof(int));
+    BOOST_CHECK(snapshot.copied() <= kSize * sizeof(int));
+  }
+  BOOST_CHECK(ReadInts(kPath, kSize) == expected);
+  std::remove(kPath.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(array_table) {
+  const std::string kPath = "test_snapshot_array";
+  std::vector<int> delta(10), model(10);
+  for (int i = 0; i < 10; ++i) delta[i] = i;
+  {
+    MultiversoEnv env;
+    ArrayTableOption<int> option(10);
+    std::unique_ptr<ArrayWorker<int>> table(MV_CreateTable(option));
+    table->Add(delta.data(), delta.size());
+    MV_Snapshot(kPath);
+    // not in the snapshot
+    table->Add(delta.data(), delta.size());
+    table->Get(model.data(), model.size());
+    BOOST_CHECK_EQUAL(model[1], 2);
+  }
+  // all written by the shut down
+  std::string path = kPath + ".0.0";
+  BOOST_CHECK(ReadInts(path, 10) == delta);
+  std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(model_average) {
+  // no server to snapshot
+  MV_SetFlag("ma", true);
+  {
+    MultiversoEnv env;
+    MV_Snapshot("test_snapshot_ma");
+  }
+  MV_SetFlag("ma", false);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/io/chunked_text_reader.h>
+#include <multiverso/io/io.h>
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+const char* kPath = "test_text_reader.txt";
+
+// Lines of all the sizes around the chunk size, with empty ones, and the
+// last one without '\n'
+std::vector<std::string> WriteLines() {
+  std::vector<std::string> lines;
+  for (int i = 0; i < 200; ++i) {
+    lines.push_back(i % 7 == 0 ? "" : std::string(i % 50, 'a' + i % 26));
+  }
+  lines.push_back(std::string(1000, 'z'));
+  lines.push_back("last");
+  std::unique_ptr<Stream> stream(StreamFactory::GetStream(URI(kPath),
+    FileOpenMode::Write));
+  for (size_t i = 0; i < lines.size(); ++i) {
+    stream->Write(lines[i].data(), lines[i].size());
+    if (i + 1 < lines.size()) stream->Write("\n", 1);
+  }
+  return lines;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(text_reader)
+
+BOOST_AUTO_TEST_CASE(next_chunk) {
+  std::vector<std::string> expected = WriteLines();
+  for (size_t chunk_size : { 1, 16, 100, 1 << 20 }) {
+    ChunkedTextReader reader(URI(kPath), chunk_size);
+    std::vector<std::string> lines;
+    size_t index = 0;
+    while (std::unique_ptr<TextChunk> chunk = reader.NextChunk()) {
+      BOOST_CHECK_EQUAL(chunk->index(), index++);
+      for (auto& line : chunk->lines()) lines.push_back(line.str());
+    }
+    BOOST_CHECK(lines == expected);
+  }
+
+  TextReader reader(URI(kPath), 64);
+  std::string line;
+  for (auto& line_expected : expected) {
+    reader.GetLine(line);
+    BOOST_CHECK_EQUAL(line, line_expected);
+  }
+  BOOST_CHECK_EQUAL(reader.GetLine(line), 0);
+  std::remove(kPath);
+}
+
+BOOST_AUTO_TEST_CASE(for_each_chunk) {
+  std::vector<std::string> expected = WriteLines();
+  ChunkedTextReader reader(URI(kPath), 64);
+  std::mutex m;
+  std::map<size_t, std::vector<std::string>> chunks;
+  reader.ForEachChunk([&](const TextChunk& chunk) {
+    std::vector<std::string> lines;
+    for (auto& line : chunk.lines()) lines.push_back(line.str());
+    std::lock_guard<std::mutex> l(m);
+    chunks[chunk.index()] = lines;
+  }, 4);
+  std::vector<std::string> lines;
+  for (auto& chunk : chunks) {
+    lines.insert(lines.end(), chunk.second.begin(), chunk.second.end());
+  }
+  BOOST_CHECK(lines == expected);
+  BOOST_CHECK(reader.NextChunk() == nullptr);
+  std::remove(kPath);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/multiverso.h>
+#include <multiverso/table/array_table.h>
+#include <multiverso/util/tracer.h>
+
+#include "multiverso_env.h"
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+int Count(const std::string& text, const std::string& pattern) {
+  int count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(tracer)
+
+BOOST_AUTO_TEST_CASE(dump) {
+  const std::string path = "test_tracer.json";
+  {
+    MultiversoEnv env;
+    Tracer::SetThreadName("test \"thread\"");
+    Tracer::Span(5, "Test::Span", 100, 150);
+    Tracer::Span(6, std::string("Test::Other"), 200, 200);
+    Tracer::Dump(path, 0);
+  }
+  std::string json = ReadFile(path);
+  BOOST_CHECK_EQUAL(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["),
+                    0);
+  BOOST_CHECK(json.find("\"args\":{\"name\":\"rank 0\"}") !=
+              std::string::npos);
+  BOOST_CHECK(json.find("\"args\":{\"name\":\"test \\\"thread\\\"\"}") !=
+              std::string::npos);
+  BOOST_CHECK(json.find("\"name\":\"Test::Span\",\"pid\":0,") !=
+              std::string::npos);
+  BOOST_CHECK(json.find("\"ts\":100,\"dur\":50,\"bind_id\":\"0x5\"") !=
+              std::string::npos);
+  BOOST_CHECK(json.find("\"ts\":200,\"dur\":0,\"bind_id\":\"0x6\"") !=
+              std::string::npos);
+  BOOST_CHECK(json.find("\n]}\n") == json.size() - 4);
+
+  // the spans are dropped by the dump
+  Tracer::Dump(path, 0);
+  BOOST_CHECK_EQUAL(Count(ReadFile(path), "\"ph\":\"X\""), 0);
+  std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(local_ranks) {
+  MV_SetFlag("sync", false);
+  MV_SetFlag("trace_sample", 1);
+  MV_SetFlag("trace_file", std::string("test_tracer"));
+  const int num_ranks = 2;
+
+  MV_RunLocal(num_ranks, [&](int) {
+    ArrayTableOption<int> option(10);
+    ArrayWorker<int>* table = MV_CreateTable(option);
+    std::vector<int> delta(10, 1), model(10);
+    // never waited, traced up to its reply
+    table->AddAsync(delta.data(), delta.size());
+    table->Get(model.data(), model.size());
+    MV_Barrier();
+    delete table;
+  });
+  MV_SetFlag("trace_sample", 0);
+  MV_SetFlag("trace_file", std::string("multiverso_trace"));
+
+  // each rank dumps its own spans
+  for (int rank = 0; rank < num_ranks; ++rank) {
+    std::string path = "test_tracer." + std::to_string(rank) + ".json";
+    std::string json = ReadFile(path);
+    std::string pid = "\"pid\":" + std::to_string(rank) + ",";
+    BOOST_CHECK_EQUAL(Count(json, "\"pid\":"), Count(json, pid));
+    BOOST_CHECK_EQUAL(Count(json, "\"name\":\"WorkerTable::Request\""), 2);
+    std::remove(path.c_str());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
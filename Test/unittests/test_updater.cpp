@@ -0,0 +1,139 @@
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <multiverso/updater/adagrad_updater.h>
+#include <multiverso/updater/adam_updater.h>
+#include <multiverso/updater/ftrl_updater.h>
+
+#include "multiverso_env.h"
+
+namespace multiverso {
+namespace test {
+
+namespace {
+
+// over the SSE blocks and the tail
+const size_t kSize = 7;
+const int kSteps = 3;
+
+// delta of parameter i at step, both signs and some small ones
+double Delta(int step, size_t i) {
+  double delta = 0.01 * (i + 1) * (step + 1);
+  return i % 3 == 0 ? -delta : i % 3 == 1 ? delta : delta / 100;
+}
+
+AddOption Option() {
+  AddOption option;
+  option.set_learning_rate(0.5f);
+  option.set_rho(0.1f);
+  option.set_lambda(0.01f);
+  return option;
+}
+
+// Applies kSteps Adds to updater and checks the values against expected
+template <typename T>
+void CheckUpdates(Updater<T>* updater, const std::vector<double>& expected,
+                  double tolerance) {
+  AddOption option = Option();
+  std::vector<T> data(kSize), delta(kSize);
+  for (int step = 0; step < kSteps; ++step) {
+    for (size_t i = 0; i < kSize; ++i) {
+      delta[i] = static_cast<T>(Delta(step, i));
+    }
+    updater->Update(kSize, data.data(), delta.data(), &option, 0);
+  }
+  for (size_t i = 0; i < kSize; ++i) {
+    BOOST_CHECK_CLOSE(static_cast<double>(data[i]), expected[i], tolerance);
+  }
+}
+
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(updater_test, MultiversoEnv)
+
+BOOST_AUTO_TEST_CASE(adagrad) {
+  AddOption option = Option();
+  double lr = option.learning_rate(), rho = option.rho(), eps = 1e-6f;
+  std::vector<double> w(kSize), g2(kSize);
+  for (int step = 0; step < kSteps; ++step) {
+    for (size_t i = 0; i < kSize; ++i) {
+      double g = Delta(step, i) / lr;
+      g2[i] += g * g;
+      w[i] -= rho * g / std::sqrt(g2[i] + eps);
+    }
+  }
+  // g = 0.04, 0.08, 0.12
+  BOOST_CHECK_CLOSE(w[1], -0.1 * (0.04 / std::sqrt(0.0016 + 1e-6) +
+    0.08 / std::sqrt(0.008 + 1e-6) + 0.12 / std::sqrt(0.0224 + 1e-6)), 1e-3);
+
+  std::unique_ptr<Updater<double>> d(new AdaGradUpdater<double>(kSize, 0));
+  CheckUpdates(d.get(), w, 1e-9);
+  std::unique_ptr<Updater<float>> f(new AdaGradUpdater<float>(kSize, 0));
+  CheckUpdates(f.get(), w, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(adam) {
+  const double beta1 = 0.9, beta2 = 0.999, eps = 1e-8;
+  AddOption option = Option();
+  double lr = option.learning_rate(), rho = option.rho();
+  std::vector<double> w(kSize), m(kSize), v(kSize);
+  for (int step = 0; step < kSteps; ++step) {
+    int t = step + 1;
+    for (size_t i = 0; i < kSize; ++i) {
+      double g = Delta(step, i) / lr;
+      m[i] = beta1 * m[i] + (1 - beta1) * g;
+      v[i] = beta2 * v[i] + (1 - beta2) * g * g;
+      // bias corrected, with eps inside the square root of v
+      double m_hat = m[i] / (1 - std::pow(beta1, t));
+      double v_hat = v[i] / (1 - std::pow(beta2, t));
+      w[i] -= rho * m_hat / std::sqrt(v_hat + eps / (1 - std::pow(beta2, t)));
+    }
+  }
+
+  std::unique_ptr<Updater<double>> d(
+    new AdamUpdater<double>(kSize, 0, beta1, beta2, eps));
+  CheckUpdates(d.get(), w, 1e-9);
+  std::unique_ptr<Updater<float>> f(
+    new AdamUpdater<float>(kSize, 0, beta1, beta2, eps));
+  CheckUpdates(f.get(), w, 1e-2);
+}
+
+BOOST_AUTO_TEST_CASE(ftrl) {
+  const double beta = 1.0, l2 = 0.1;
+  AddOption option = Option();
+  double lr = option.learning_rate(), alpha = option.rho(),
+    l1 = option.lambda();
+  std::vector<double> w(kSize), z(kSize), n(kSize);
+  for (int step = 0; step < kSteps; ++step) {
+    for (size_t i = 0; i < kSize; ++i) {
+      double g = Delta(step, i) / lr;
+      double sigma = (std::sqrt(n[i] + g * g) - std::sqrt(n[i])) / alpha;
+      z[i] += g - sigma * w[i];
+      n[i] += g * g;
+      if (std::abs(z[i]) <= l1) {
+        w[i] = 0;
+      } else {
+        double sign = z[i] < 0 ? -1 : 1;
+        w[i] = -(z[i] - sign * l1) /
+          ((beta + std::sqrt(n[i])) / alpha + l2);
+      }
+    }
+  }
+  // the small gradients are cut by the l1 regularization
+  BOOST_CHECK_EQUAL(w[2], 0);
+  BOOST_CHECK_EQUAL(w[5], 0);
+  BOOST_CHECK(w[0] > 0 && w[1] < 0);
+
+  std::unique_ptr<Updater<double>> d(
+    new FTRLUpdater<double>(kSize, 0, beta, l2));
+  CheckUpdates(d.get(), w, 1e-9);
+  std::unique_ptr<Updater<float>> f(
+    new FTRLUpdater<float>(kSize, 0, beta, l2));
+  CheckUpdates(f.get(), w, 1e-3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace test
+}  // namespace multiverso
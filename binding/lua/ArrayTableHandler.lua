@@ -7,7 +7,7 @@ ffi.cdef[[
     void MV_NewArrayTable(int size, TableHandler* out);
     void MV_GetArrayTable(TableHandler handler, float* data, int size);
     void MV_AddArrayTable(TableHandler handler, float* data, int size);
-    void MV_AddAsyncArrayTable(TableHandler handler, float* data, int size);
+    int MV_AddAsyncArrayTable(TableHandler handler, float* data, int size);
 ]]
 
 function tbh:new(size, init_value)
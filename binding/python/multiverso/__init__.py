@@ -2,4 +2,4 @@
 # coding:utf8
 
 from .api import init, shutdown, barrier, workers_num, worker_id, server_id, is_master_worker
-from .tables import ArrayTableHandler, MatrixTableHandler
+from .tables import ArrayTableHandler, MatrixTableHandler, AsyncHandle
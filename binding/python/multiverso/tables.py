@@ -4,6 +4,8 @@
 import ctypes
 from .utils import Loader
 from .utils import convert_data
+from .utils import convert_row_ids
+from .utils import check_buffer
 import numpy as np
 from . import api
 
@@ -30,9 +32,55 @@ class TableHandler(object):
     def add(self, data, sync=False):
         raise NotImplementedError("You must implement the add method.")
 
+    def _start(self, msg_id, result, *buffers):
+        '''track the async get msg_id, which uses the buffers in place'''
+        handle = AsyncHandle(self, msg_id, result, buffers)
+        self._pending[msg_id] = handle
+        return handle
+
+    def _start_add(self, msg_id):
+        '''the async add msg_id copied its data, so it is not tracked and
+        its handle keeps no buffer'''
+        return AsyncHandle(self, msg_id, None, ())
+
+    def wait(self):
+        '''wait for all the async gets of the table, the async adds are
+        waited through their own handles'''
+        for handle in list(self._pending.values()):
+            handle.wait()
+
+
+class AsyncHandle(object):
+    '''`AsyncHandle` is returned by the async calls of the tables.
+
+    The buffers of a get are used in place by multiverso and kept alive by
+    the handle until `wait` returns, so the caller can compute while the call
+    is on the way. The data of an add is copied when the call is made.
+    '''
+    def __init__(self, table, msg_id, result, buffers):
+        self._table = table
+        self._msg_id = msg_id
+        self._result = result
+        self._buffers = buffers
+        self._done = False
+
+    def wait(self):
+        '''wait for the call to finish, return the array got, if any'''
+        if not self._done:
+            self._table._wait(self._msg_id)
+            self._table._pending.pop(self._msg_id, None)
+            self._done = True
+            self._buffers = None
+        return self._result
+
+    def done(self):
+        '''whether the call has been waited for'''
+        return self._done
+
 
 # types
 C_FLOAT_P = ctypes.POINTER(ctypes.c_float)
+C_INT_P = ctypes.POINTER(ctypes.c_int)
 
 
 class ArrayTableHandler(TableHandler):
@@ -47,6 +95,7 @@ class ArrayTableHandler(TableHandler):
         '''
         self._handler = ctypes.c_void_p()
         self._size = size
+        self._pending = {}
         mv_lib.MV_NewArrayTable(size, ctypes.byref(self._handler))
         if init_value is not None:
             init_value = convert_data(init_value)
@@ -56,14 +105,29 @@ class ArrayTableHandler(TableHandler):
             # sync mode
             self.add(init_value if api.is_master_worker() else np.zeros(init_value.shape), sync=True)
 
-    def get(self):
+    def get(self, out=None, sync=True):
         '''get the latest value from multiverso ArrayTable
 
         Data type of return value is numpy.ndarray with one-dimensional
+
+        If `out` is given, a float32 C-contiguous numpy.ndarray of the table
+        size, the value is written into it and it is returned, otherwise a new
+        array is allocated.
+
+        If sync is False, an `AsyncHandle` is returned at once, its `wait`
+        returns the array. A Get first waits for the pending calls of the
+        table, which serves one Get at a time.
         '''
-        data = np.zeros((self._size, ), dtype=np.dtype("float32"))
-        mv_lib.MV_GetArrayTable(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
-        return data
+        self.wait()
+        if out is None:
+            data = np.zeros((self._size, ), dtype=np.dtype("float32"))
+        else:
+            data = check_buffer(out, self._size)
+        if sync:
+            mv_lib.MV_GetArrayTable(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
+            return data
+        msg_id = mv_lib.MV_GetAsyncArrayTable(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
+        return self._start(msg_id, data, data)
 
     def add(self, data, sync=False):
         '''add the data to the multiverso ArrayTable
@@ -71,14 +135,19 @@ class ArrayTableHandler(TableHandler):
         Data type of `data` is numpy.ndarray with one-dimensional
 
         If sync is True, this call will blocked by IO until the call finish.
-        Otherwise it will return immediately
+        Otherwise it will return immediately an `AsyncHandle`, `data` is
+        copied so it may be changed at once
         '''
         data = convert_data(data)
         assert(data.size == self._size)
         if sync:
             mv_lib.MV_AddArrayTable(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
         else:
-            mv_lib.MV_AddAsyncArrayTable(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
+            msg_id = mv_lib.MV_AddAsyncArrayTable(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
+            return self._start_add(msg_id)
+
+    def _wait(self, msg_id):
+        mv_lib.MV_WaitArrayTable(self._handler, msg_id)
 
 
 class MatrixTableHandler(TableHandler):
@@ -96,6 +165,7 @@ class MatrixTableHandler(TableHandler):
         self._num_row = num_row
         self._num_col = num_col
         self._size = num_col * num_row
+        self._pending = {}
         mv_lib.MV_NewMatrixTable(num_row, num_col, ctypes.byref(self._handler))
         if init_value is not None:
             init_value = convert_data(init_value)
@@ -105,29 +175,54 @@ class MatrixTableHandler(TableHandler):
             # sync mode
             self.add(init_value if api.is_master_worker() else np.zeros(init_value.shape), sync=True)
 
-    def get(self, row_ids=None):
+    def get(self, row_ids=None, out=None, sync=True):
         '''get the latest value from multiverso MatrixTable
 
         If row_ids is None, we will return all rows as numpy.narray , e.g.
         array([[1, 3], [3, 4]]).
         Otherwise we will return the data according to the row_ids(e.g. you can
         pass [1] to row_ids to get only the first row, it will return a
-        two-dimensional numpy.ndarray with one row)
+        two-dimensional numpy.ndarray with one row). The row_ids may be any
+        sequence or buffer, a contiguous int32 numpy.ndarray is used without
+        any copy.
 
         Data type of return value is numpy.ndarray with two-dimensional
+
+        If `out` is given, a float32 C-contiguous numpy.ndarray of the size of
+        the rows got, the value is written into it and it is returned,
+        otherwise a new array is allocated.
+
+        If sync is False, an `AsyncHandle` is returned at once, its `wait`
+        returns the array. A Get first waits for the pending calls of the
+        table, which serves one Get at a time.
         '''
+        self.wait()
         if row_ids is None:
-            data = np.zeros((self._num_row, self._num_col), dtype=np.dtype("float32"))
-            mv_lib.MV_GetMatrixTableAll(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
-            return data
+            if out is None:
+                data = np.zeros((self._num_row, self._num_col), dtype=np.dtype("float32"))
+            else:
+                data = check_buffer(out, self._size)
+            if sync:
+                mv_lib.MV_GetMatrixTableAll(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
+                return data
+            msg_id = mv_lib.MV_GetAsyncMatrixTableAll(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
+            return self._start(msg_id, data, data)
         else:
-            row_ids_n = len(row_ids)
-            int_array_type = ctypes.c_int * row_ids_n
-            data = np.zeros((row_ids_n, self._num_col), dtype=np.dtype("float32"))
-            mv_lib.MV_GetMatrixTableByRows(self._handler, data.ctypes.data_as(C_FLOAT_P),
-                                           row_ids_n * self._num_col,
-                                           int_array_type(*row_ids), row_ids_n)
-            return data
+            row_ids = convert_row_ids(row_ids)
+            row_ids_n = row_ids.size
+            if out is None:
+                data = np.zeros((row_ids_n, self._num_col), dtype=np.dtype("float32"))
+            else:
+                data = check_buffer(out, row_ids_n * self._num_col)
+            if sync:
+                mv_lib.MV_GetMatrixTableByRows(self._handler, data.ctypes.data_as(C_FLOAT_P),
+                                               row_ids_n * self._num_col,
+                                               row_ids.ctypes.data_as(C_INT_P), row_ids_n)
+                return data
+            msg_id = mv_lib.MV_GetAsyncMatrixTableByRows(self._handler, data.ctypes.data_as(C_FLOAT_P),
+                                                         row_ids_n * self._num_col,
+                                                         row_ids.ctypes.data_as(C_INT_P), row_ids_n)
+            return self._start(msg_id, data, data, row_ids)
 
     def add(self, data=None, row_ids=None, sync=False):
         '''add the data to the multiverso MatrixTable
@@ -135,12 +230,14 @@ class MatrixTableHandler(TableHandler):
         If row_ids is None, we will add all data, and the data
         should be a list, e.g. [1, 2, 3, ...]
 
-        Otherwise we will add the data according to the row_ids
+        Otherwise we will add the data according to the row_ids, passed as in
+        `get`
 
         Data type of `data` is numpy.ndarray with two-dimensional
 
         If sync is True, this call will blocked by IO until the call finish.
-        Otherwise it will return immediately
+        Otherwise it will return immediately an `AsyncHandle`, `data` and
+        `row_ids` are copied so they may be changed at once
         '''
         assert(data is not None)
         data = convert_data(data)
@@ -150,16 +247,21 @@ class MatrixTableHandler(TableHandler):
             if sync:
                 mv_lib.MV_AddMatrixTableAll(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
             else:
-                mv_lib.MV_AddAsyncMatrixTableAll(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
+                msg_id = mv_lib.MV_AddAsyncMatrixTableAll(self._handler, data.ctypes.data_as(C_FLOAT_P), self._size)
+                return self._start_add(msg_id)
         else:
-            row_ids_n = len(row_ids)
+            row_ids = convert_row_ids(row_ids)
+            row_ids_n = row_ids.size
             assert(data.size == row_ids_n * self._num_col)
-            int_array_type = ctypes.c_int * row_ids_n
             if sync:
                 mv_lib.MV_AddMatrixTableByRows(self._handler, data.ctypes.data_as(C_FLOAT_P),
                                                row_ids_n * self._num_col,
-                                               int_array_type(*row_ids), row_ids_n)
+                                               row_ids.ctypes.data_as(C_INT_P), row_ids_n)
             else:
-                mv_lib.MV_AddAsyncMatrixTableByRows(self._handler, data.ctypes.data_as(C_FLOAT_P),
-                                               row_ids_n * self._num_col,
-                                               int_array_type(*row_ids), row_ids_n)
+                msg_id = mv_lib.MV_AddAsyncMatrixTableByRows(self._handler, data.ctypes.data_as(C_FLOAT_P),
+                                                             row_ids_n * self._num_col,
+                                                             row_ids.ctypes.data_as(C_INT_P), row_ids_n)
+                return self._start_add(msg_id)
+
+    def _wait(self, msg_id):
+        mv_lib.MV_WaitMatrixTable(self._handler, msg_id)
@@ -72,6 +72,36 @@ class TestMultiversoTables(unittest.TestCase):
                     self.assertEqual(expected, actual)
 
 
+    def test_async(self):
+        num_row = 11
+        num_col = 10
+        workers_num = mv.workers_num()
+        atbh = mv.ArrayTableHandler(num_col)
+        mtbh = mv.MatrixTableHandler(num_row, num_col)
+        mv.barrier()
+        row_ids = np.array([0, 3, 10], dtype=np.int32)
+        array_out = np.empty(num_col, dtype=np.float32)
+        rows_out = np.empty((len(row_ids), num_col), dtype=np.float32)
+        for count in xrange(1, 11):
+            handles = [atbh.add(np.ones(num_col, dtype=np.float32)),
+                       mtbh.add(np.ones((len(row_ids), num_col)), row_ids)]
+            # the adds copied their data, nothing kept for them
+            self.assertFalse(atbh._pending or mtbh._pending)
+            for handle in handles:
+                handle.wait()
+                self.assertTrue(handle.done())
+            mv.barrier()
+            handle = atbh.get(out=array_out, sync=False)
+            self.assertIs(handle.wait(), array_out)
+            data = mtbh.get(row_ids, out=rows_out, sync=False).wait()
+            self.assertIs(data, rows_out)
+            mv.barrier()
+            for actual in array_out:
+                self.assertEqual(count * workers_num, actual)
+            for actual in rows_out.ravel():
+                self.assertEqual(count * workers_num, actual)
+
+
 class TestMultiversoSharedVariable(unittest.TestCase):
     '''
     Use the commands below to run test
@@ -69,11 +69,35 @@ class Loader(object):
         if not cls.LIB:
             cls.LIB = cls.load_lib()
             cls.LIB.MV_NumWorkers.restype = ctypes.c_int
+            for name in ["MV_GetAsyncArrayTable", "MV_AddAsyncArrayTable",
+                         "MV_GetAsyncMatrixTableAll",
+                         "MV_AddAsyncMatrixTableAll",
+                         "MV_GetAsyncMatrixTableByRows",
+                         "MV_AddAsyncMatrixTableByRows"]:
+                getattr(cls.LIB, name).restype = ctypes.c_int
         return cls.LIB
 
 
 def convert_data(data):
-    '''convert the data to float32 ndarray'''
-    if not isinstance(data, np.ndarray):
-        data = np.array(data)
-    return data.astype(np.float32)
+    '''convert the data to a contiguous float32 ndarray
+
+    Data which already is a contiguous float32 ndarray is returned as is.
+    '''
+    return np.ascontiguousarray(data, dtype=np.float32)
+
+
+def convert_row_ids(row_ids):
+    '''convert the row ids to a contiguous int32 ndarray
+
+    Row ids which already are a contiguous int32 ndarray are returned as is,
+    other sequences and buffers are converted in one vectorized copy.
+    '''
+    return np.ascontiguousarray(row_ids, dtype=np.int32).ravel()
+
+
+def check_buffer(out, size):
+    '''check that `out` can be filled in place with size float32 values'''
+    assert(isinstance(out, np.ndarray))
+    assert(out.dtype == np.float32 and out.flags["C_CONTIGUOUS"])
+    assert(out.flags["WRITEABLE"] and out.size == size)
+    return out
@@ -37,6 +37,8 @@ protected:
   }
   // Send a message to a dst actor
   void SendTo(const std::string& dst_name, MessagePtr& msg);
+  // Process a message by its registered handler
+  void Dispatch(MessagePtr& msg);
 
   // Main function run in a background thread
   // The default main is to receive msg from other actors and process
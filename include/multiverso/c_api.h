@@ -13,6 +13,10 @@ extern "C" {
 
 typedef void* TableHandler;
 
+// The async calls return a handle to wait for with MV_Wait*Table. The data
+// and row ids are used in place, they must stay valid until the wait returns.
+// A table serves one Get at a time.
+
 DllExport void MV_Init(int* argc, char* argv[]);
 
 DllExport void MV_ShutDown();
@@ -32,7 +36,11 @@ DllExport void MV_GetArrayTable(TableHandler handler, float* data, int size);
 
 DllExport void MV_AddArrayTable(TableHandler handler, float* data, int size);
 
-DllExport void MV_AddAsyncArrayTable(TableHandler handler, float* data, int size);
+DllExport int MV_GetAsyncArrayTable(TableHandler handler, float* data, int size);
+
+DllExport int MV_AddAsyncArrayTable(TableHandler handler, float* data, int size);
+
+DllExport void MV_WaitArrayTable(TableHandler handler, int id);
 
 
 // Matrix Table
@@ -42,7 +50,9 @@ DllExport void MV_GetMatrixTableAll(TableHandler handler, float* data, int size)
 
 DllExport void MV_AddMatrixTableAll(TableHandler handler, float* data, int size);
 
-DllExport void MV_AddAsyncMatrixTableAll(TableHandler handler, float* data, int size);
+DllExport int MV_GetAsyncMatrixTableAll(TableHandler handler, float* data, int size);
+
+DllExport int MV_AddAsyncMatrixTableAll(TableHandler handler, float* data, int size);
 
 DllExport void MV_GetMatrixTableByRows(TableHandler handler, float* data,
                                        int size, int row_ids[], int row_ids_n);
@@ -50,9 +60,14 @@ DllExport void MV_GetMatrixTableByRows(TableHandler handler, float* data,
 DllExport void MV_AddMatrixTableByRows(TableHandler handler, float* data,
                                        int size, int row_ids[], int row_ids_n);
 
-DllExport void MV_AddAsyncMatrixTableByRows(TableHandler handler, float* data,
+DllExport int MV_GetAsyncMatrixTableByRows(TableHandler handler, float* data,
                                        int size, int row_ids[], int row_ids_n);
 
+DllExport int MV_AddAsyncMatrixTableByRows(TableHandler handler, float* data,
+                                       int size, int row_ids[], int row_ids_n);
+
+DllExport void MV_WaitMatrixTable(TableHandler handler, int id);
+
 #ifdef __cplusplus
 }  // end extern "C"
 #endif
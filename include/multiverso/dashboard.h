@@ -1,15 +1,25 @@
 #ifndef MULTIVERSO_DASHBOARD_H_
 #define MULTIVERSO_DASHBOARD_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "multiverso/util/timer.h"
 
 namespace multiverso {
 
 class Monitor;
+class Counter;
+class Gauge;
+struct DashboardSnapshot;
 
 // Dashboard to record and query system running information
 // thread safe
@@ -17,45 +27,266 @@ class Dashboard {
 public:
   static void AddMonitor(const std::string& name, Monitor* monitor);
   static void RemoveMonitor(const std::string& name);
+  // Counter of name, created on the first call and kept until exit. Callers
+  // on hot paths should keep the pointer.
+  static Counter* GetCounter(const std::string& name);
+  // Gauge of name, as GetCounter
+  static Gauge* GetGauge(const std::string& name);
   static std::string Watch(const std::string& name);
+  // Records the current totals of all the monitors and counters, which
+  // gives the rates over sliding windows
+  static void Sample();
+  // Samples, then reads everything with the rates over the last
+  // rate_seconds
+  static void Snapshot(double rate_seconds, DashboardSnapshot* snapshot);
   static void Display();
 private:
   static std::map<std::string, Monitor*> record_;
+  static std::map<std::string, std::unique_ptr<Counter>> counters_;
+  static std::map<std::string, std::unique_ptr<Gauge>> gauges_;
   static std::mutex m_;
 };
 
-class Monitor {
+// Log-linear histogram of latencies in nanoseconds. Values below 8 have a
+// bucket each, then every power of two is split in 8 linear buckets, so a
+// quantile is within 12.5% of the exact one.
+class Histogram {
+public:
+  static const int kNumBuckets = 336;
+
+  Histogram() : buckets_(kNumBuckets, 0), count_(0), sum_(0) {}
+
+  static int Bucket(uint64_t value);
+  // [lower, upper) bound of the values of bucket
+  static uint64_t Lower(int bucket);
+  static uint64_t Upper(int bucket);
+
+  void Add(int bucket, uint64_t count) {
+    buckets_[bucket] += count;
+    count_ += count;
+  }
+  void AddSum(uint64_t sum) { sum_ += sum; }
+
+  // Approximate q quantile, q in [0, 1], 0 if empty
+  double Quantile(double q) const;
+
+  uint64_t count() const { return count_; }
+  uint64_t sum() const { return sum_; }
+
+private:
+  std::vector<uint64_t> buckets_;
+  uint64_t count_;
+  uint64_t sum_;
+};
+
+// Totals of a monitor or counter sampled over time, see Dashboard::Sample
+class RateWindow {
+public:
+  RateWindow();
+
+  void Sample(double total);
+
+  // Increase per second of the total over the last seconds before the
+  // newest sample, from the newest sample at least that old, or the oldest
+  double rate(double seconds) const;
+
+private:
+  static const size_t kMaxSamples = 128;
+
+  Timer timer_;
+  // (seconds since construction, total)
+  std::deque<std::pair<double, double>> samples_;
+};
+
+namespace dashboard {
+
+// Slot of this thread for the statistics of id, nullptr at first
+void*& LocalShard(int id);
+int NewShardsId();
+
+// Per thread copies of the statistics of a monitor or counter. A copy is
+// written by its thread only, with relaxed atomics so that readers summing
+// them see whole values, and the writers never take a lock after their
+// first record.
+template <typename Shard>
+class ThreadShards {
 public:
-  explicit Monitor(const std::string& name) {
-    name_ = name;
-    timer_.Start();
-    Dashboard::AddMonitor(name_, this);
+  ThreadShards() : id_(NewShardsId()) {}
+
+  Shard* local() {
+    void*& slot = LocalShard(id_);
+    if (slot == nullptr) {
+      std::lock_guard<std::mutex> l(m_);
+      shards_.emplace_back(new Shard());
+      slot = shards_.back().get();
+    }
+    return static_cast<Shard*>(slot);
+  }
+
+  template <typename Func>
+  void ForEach(Func func) const {
+    std::lock_guard<std::mutex> l(m_);
+    for (auto& shard : shards_) func(*shard);
   }
 
-  void Begin() { timer_.Start(); }
+private:
+  // ids are never reused, so slots of destroyed objects are never read
+  int id_;
+  mutable std::mutex m_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+// Adds value to a counter only written by this thread
+inline void Increase(std::atomic<uint64_t>* counter, uint64_t value) {
+  counter->store(counter->load(std::memory_order_relaxed) + value,
+                 std::memory_order_relaxed);
+}
+
+}  // namespace dashboard
+
+// Latencies of a piece of code, cheap enough to be always on
+class Monitor {
+public:
+  explicit Monitor(const std::string& name);
+
+  // Begin and End time the code between them on the calling thread
+  void Begin() { shards_.local()->start = Clock::now(); }
 
   void End() {
-    elapse_ += timer_.elapse();
-    ++count_;
+    Shard* shard = shards_.local();
+    Add(shard, static_cast<uint64_t>(std::chrono::duration_cast<
+      std::chrono::nanoseconds>(Clock::now() - shard->start).count()));
+  }
+
+  // Account an elapse measured elsewhere, in milliseconds
+  void Record(double elapse) {
+    Add(shards_.local(), static_cast<uint64_t>(elapse * 1e6));
   }
 
-  double average() const { return elapse_ / count_; }
+  // Merge of the latencies of all the threads
+  Histogram histogram() const;
+
+  double average() const;
 
   std::string name() const { return name_; }
-  double elapse() const { return elapse_; }
-  int count() const { return count_; }
+  // total elapse in milliseconds
+  double elapse() const;
+  int count() const;
+  // Quantile of the latencies in milliseconds
+  double quantile(double q) const { return histogram().Quantile(q) / 1e6; }
+  // calls per second, see Dashboard::Sample
+  double rate(double seconds) const;
 
+  void Sample();
   std::string info_string() const;
 
 private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Shard {
+    Shard() : count(0), sum(0) {
+      for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    }
+    std::atomic<uint64_t> buckets[Histogram::kNumBuckets];
+    std::atomic<uint64_t> count;
+    // nanoseconds
+    std::atomic<uint64_t> sum;
+    Clock::time_point start;
+  };
+
+  static void Add(Shard* shard, uint64_t nanoseconds) {
+    dashboard::Increase(&shard->buckets[Histogram::Bucket(nanoseconds)], 1);
+    dashboard::Increase(&shard->count, 1);
+    dashboard::Increase(&shard->sum, nanoseconds);
+  }
+
   // name of the Monitor
   std::string name_;
-  // total elapsed time
-  double elapse_;
-  // count of monitor
-  int count_;
-  // a timer util
-  Timer timer_;
+  dashboard::ThreadShards<Shard> shards_;
+  mutable std::mutex m_;
+  RateWindow calls_;
+};
+
+// Number and total size of events, e.g. messages and their bytes
+class Counter {
+public:
+  explicit Counter(const std::string& name) : name_(name) {}
+
+  // one more event of size value
+  void Add(uint64_t value) {
+    Shard* shard = shards_.local();
+    dashboard::Increase(&shard->count, 1);
+    dashboard::Increase(&shard->sum, value);
+  }
+
+  std::string name() const { return name_; }
+  uint64_t count() const;
+  uint64_t sum() const;
+  // events and size per second, see Dashboard::Sample
+  double count_rate(double seconds) const;
+  double sum_rate(double seconds) const;
+
+  void Sample();
+  std::string info_string() const;
+
+private:
+  struct Shard {
+    Shard() : count(0), sum(0) {}
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+  };
+
+  std::string name_;
+  dashboard::ThreadShards<Shard> shards_;
+  mutable std::mutex m_;
+  RateWindow counts_;
+  RateWindow sums_;
+};
+
+// Last value of a quantity, e.g. the length of a queue
+class Gauge {
+public:
+  explicit Gauge(const std::string& name) : name_(name), value_(0) {}
+
+  void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+
+  std::string name() const { return name_; }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+  std::string info_string() const;
+
+private:
+  std::string name_;
+  std::atomic<int64_t> value_;
+};
+
+// Values of the monitors, counters and gauges at one time
+struct DashboardSnapshot {
+  static const int kNumQuantiles = 4;
+  // 0.5, 0.9, 0.99 and 0.999
+  static const double kQuantiles[kNumQuantiles];
+
+  struct MonitorValues {
+    std::string name;
+    uint64_t count;
+    // milliseconds
+    double elapse;
+    double quantiles[kNumQuantiles];
+    // calls per second
+    double rate;
+  };
+
+  struct CounterValues {
+    std::string name;
+    uint64_t count;
+    uint64_t sum;
+    double count_rate;
+    double sum_rate;
+  };
+
+  std::vector<MonitorValues> monitors;
+  std::vector<CounterValues> counters;
+  std::vector<std::pair<std::string, int64_t>> gauges;
 };
 
 #define REGISTER_MONITOR(name)           \
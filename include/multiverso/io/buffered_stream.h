@@ -0,0 +1,73 @@
+#ifndef MULTIVERSO_IO_BUFFERED_STREAM_H_
+#define MULTIVERSO_IO_BUFFERED_STREAM_H_
+
+/*!
+* \file buffered_stream.h
+* \brief Stream decorator reading and writing in large blocks.
+*/
+
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "multiverso/io/io.h"
+#include "multiverso/util/async_buffer.h"
+
+namespace multiverso {
+
+// Reads and writes a Stream in blocks of block_size bytes, so that small
+// Reads and Writes cost a copy instead of a syscall or an RPC. With async,
+// a thread reads the next block while the current one is consumed, or
+// writes the previous block while the next one is filled, the two blocks
+// being swapped as in ASyncBuffer. A BufferedStream is either read or
+// written.
+class BufferedStream : public Stream {
+public:
+  // Takes the ownership of stream
+  BufferedStream(Stream* stream, size_t block_size, bool async);
+  // Flushes the written data
+  ~BufferedStream() override;
+
+  void Write(const void *buf, size_t size) override;
+  size_t Read(void *buf, size_t size) override;
+  bool Good() override;
+
+  // Writes the buffered data to the underlying stream
+  void Flush();
+
+private:
+  struct Block {
+    std::vector<char> data;
+    size_t size;
+  };
+
+  // Reads a whole block, less only at the end of the stream
+  void Fill(Block* block);
+  // Makes the next block current, false at the end of the stream
+  bool NextBlock();
+  // Writes the current block
+  void WriteBlock();
+  // Waits for the write behind
+  void WaitWrite();
+
+  Stream* stream_;
+  size_t block_size_;
+  bool async_;
+  // the current block is blocks_[0] except for the read ahead
+  Block blocks_[2];
+  Block* current_;
+  // read position in the current block
+  size_t pos_;
+  bool end_;
+  bool written_;
+  std::unique_ptr<ASyncBuffer<Block>> read_ahead_;
+  std::future<void> write_behind_;
+
+  // No copying allowed
+  BufferedStream(const BufferedStream&);
+  void operator=(const BufferedStream&);
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_IO_BUFFERED_STREAM_H_
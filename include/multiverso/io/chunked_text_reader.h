@@ -0,0 +1,93 @@
+#ifndef MULTIVERSO_IO_CHUNKED_TEXT_READER_H_
+#define MULTIVERSO_IO_CHUNKED_TEXT_READER_H_
+
+/*!
+* \file chunked_text_reader.h
+* \brief Reads text in newline aligned chunks, split and parsed in parallel.
+*/
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "multiverso/io/io.h"
+
+namespace multiverso {
+
+// A line of a TextChunk without its '\n', pointing into the chunk
+struct LineView {
+  const char* data;
+  size_t size;
+
+  std::string str() const { return std::string(data, size); }
+};
+
+// Newline aligned piece of a text input and its lines
+class TextChunk {
+public:
+  // position of the chunk in the input, from 0
+  size_t index() const { return index_; }
+  size_t bytes() const { return size_; }
+  const char* data() const { return data_.get(); }
+
+  size_t num_lines() const { return lines_.size(); }
+  const LineView& line(size_t i) const { return lines_[i]; }
+  const std::vector<LineView>& lines() const { return lines_; }
+
+private:
+  friend class ChunkedTextReader;
+
+  // Finds the lines of the data
+  void Split();
+
+  size_t index_;
+  std::unique_ptr<char[]> data_;
+  size_t size_;
+  std::vector<LineView> lines_;
+};
+
+// Reads a text Stream, local or HDFS, in chunks of about chunk_size bytes
+// cut after a '\n', so that every line is in one chunk. The lines are views
+// into their chunk instead of copies. ForEachChunk splits and consumes the
+// chunks on a pool of threads while the next ones are read.
+class ChunkedTextReader {
+public:
+  static const size_t kDefaultChunkSize = 16 << 20;
+
+  explicit ChunkedTextReader(const URI& uri,
+                             size_t chunk_size = kDefaultChunkSize);
+  // Takes the ownership of stream
+  explicit ChunkedTextReader(Stream* stream,
+                             size_t chunk_size = kDefaultChunkSize);
+  ~ChunkedTextReader();
+
+  // Next chunk of the input with its lines, nullptr at the end
+  std::unique_ptr<TextChunk> NextChunk();
+
+  // Calls func for each of the remaining chunks, with its lines, on
+  // num_threads threads (0 for one per core) in any order. At most two
+  // chunks per thread are in memory. Returns after the last call.
+  void ForEachChunk(const std::function<void(const TextChunk&)>& func,
+                    int num_threads = 0);
+
+private:
+  // Reads the next chunk without its lines, false at the end
+  bool ReadChunk(std::unique_ptr<TextChunk>* chunk);
+  // Reads size bytes, fewer only at the end of the stream
+  size_t ReadFull(char* buf, size_t size);
+
+  Stream* stream_;
+  size_t chunk_size_;
+  size_t num_chunks_;
+  // bytes after the last '\n' of the previous chunk
+  std::vector<char> carry_;
+
+  // No copying allowed
+  ChunkedTextReader(const ChunkedTextReader&);
+  void operator=(const ChunkedTextReader&);
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_IO_CHUNKED_TEXT_READER_H_
@@ -20,17 +20,34 @@
 
 namespace multiverso {
 
-// only support file and hdfs
+// only support file, mmap (see io/mmap_stream.h) and hdfs
+// Options of the stream follow a '?', e.g. hdfs:///data?buffer=8M, see
+// StreamFactory::GetStream
 struct URI {
   std::string scheme;
   std::string host;
   std::string name;
   std::string path;
+  std::map<std::string, std::string> options;
 
   URI(void) {}
   explicit URI(const char *uri) :URI(std::string(uri)){}
-  explicit URI(const std::string& uri)
+  explicit URI(const std::string& full_uri)
   {
+    std::size_t query = full_uri.find('?');
+    std::string uri = full_uri.substr(0, query);
+    while (query != std::string::npos) {
+      std::size_t next = full_uri.find('&', query + 1);
+      std::string option = full_uri.substr(query + 1,
+        next == std::string::npos ? std::string::npos : next - query - 1);
+      std::size_t equal = option.find('=');
+      if (!option.empty()) {
+        options[option.substr(0, equal)] = equal == std::string::npos ?
+          "" : option.substr(equal + 1);
+      }
+      query = next;
+    }
+
     std::size_t start = 0, pos = uri.find("://", start);
     if (pos == std::string::npos) {
       scheme = "file";
@@ -94,7 +111,10 @@ enum class FileOpenMode :int {
 class StreamFactory {
 public:
   /*!
-  * \brief create a Stream and open in binary mode
+  * \brief create a Stream and open in binary mode. With the option
+  *        buffer=<size> of the uri, e.g. buffer=4M, the stream is read and
+  *        written in blocks of size bytes by a BufferedStream, which reads
+  *        ahead and writes behind on a thread unless async=false.
   * \param path the path of the file
   * \param mode Write - create an empty file to store data;
   *             Append - open the file to append data to it
@@ -0,0 +1,93 @@
+#ifndef MULTIVERSO_IO_MMAP_STREAM_H_
+#define MULTIVERSO_IO_MMAP_STREAM_H_
+
+/*!
+* \file mmap_stream.h
+* \brief Read only Stream over a memory mapped local file.
+*/
+
+#include <memory>
+#include <string>
+
+#include "multiverso/io/io.h"
+
+namespace multiverso {
+
+// A whole local file mapped in memory, read only or, if private, copy on
+// write: the pages written are copied and never reach the file
+class MemoryMap {
+public:
+  MemoryMap(const std::string& path, bool is_private);
+  ~MemoryMap();
+
+  bool good() const { return good_; }
+  bool is_private() const { return is_private_; }
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // Hints how [offset, offset + size) will be read, one of normal,
+  // sequential, random, willneed and dontneed as for madvise. Ignored on
+  // Windows
+  void Advise(const std::string& advice, size_t offset, size_t size);
+
+private:
+  bool good_;
+  bool is_private_;
+  char* data_;
+  size_t size_;
+#ifdef _MSC_VER
+  void* file_;
+  void* mapping_;
+#endif
+
+  // No copying allowed
+  MemoryMap(const MemoryMap&);
+  void operator=(const MemoryMap&);
+};
+
+// Reads a local file through a MemoryMap, opened by mmap://<path>. Read is
+// a memcpy from the page cache, and the direct pointer API gives the bytes
+// without any copy. Options of the uri:
+//   advice=<advice>  madvise hint for the whole file, see MemoryMap::Advise
+//   private=true     maps the file copy on write, so that the pointers can
+//                    be written, e.g. by a table adopting the mapped values
+class MmapStream : public Stream {
+public:
+  MmapStream(const URI& uri, FileOpenMode mode);
+
+  // Fatal, the stream is read only
+  void Write(const void *buf, size_t size) override;
+  size_t Read(void *buf, size_t size) override;
+  bool Good() override;
+
+  // Mapped bytes of the file, writable only if private
+  char* data() const { return map_->data(); }
+  size_t size() const { return map_->size(); }
+  size_t position() const { return pos_; }
+  void Seek(size_t position);
+  // Pointer to the next size bytes, skipped as if read, nullptr if less
+  // than size bytes are left
+  char* Next(size_t size);
+
+  // Shares the mapping, which outlives the stream as long as it is held
+  std::shared_ptr<MemoryMap> map() const { return map_; }
+
+private:
+  std::shared_ptr<MemoryMap> map_;
+  size_t pos_;
+};
+
+class MmapStreamFactory : public StreamFactory {
+public:
+  explicit MmapStreamFactory(const std::string& host) : host_(host) {}
+
+  Stream* Open(const URI& uri, FileOpenMode mode) override;
+  void Close() override {}
+
+private:
+  std::string host_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_IO_MMAP_STREAM_H_
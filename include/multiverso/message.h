@@ -1,6 +1,7 @@
 #ifndef MULTIVERSO_MESSAGE_H_
 #define MULTIVERSO_MESSAGE_H_
 
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <string>
@@ -15,6 +16,8 @@ enum MsgType {
   Request_Add = 2,
   Reply_Get = -1,
   Reply_Add = -2,
+  Server_Snapshot = 30,  // from the zoo of the same rank, see Zoo::Snapshot
+  Reply_Snapshot = -30,
   Server_Finish_Train = 31,
   Control_Barrier = 33,  // 0x100001
   Control_Reply_Barrier = -33,
@@ -23,19 +26,41 @@ enum MsgType {
   Default = 0
 };
 
+inline std::string MsgTypeName(int type) {
+  switch (type) {
+  case MsgType::Request_Get: return "Request_Get";
+  case MsgType::Request_Add: return "Request_Add";
+  case MsgType::Reply_Get: return "Reply_Get";
+  case MsgType::Reply_Add: return "Reply_Add";
+  case MsgType::Server_Snapshot: return "Server_Snapshot";
+  case MsgType::Reply_Snapshot: return "Reply_Snapshot";
+  case MsgType::Server_Finish_Train: return "Server_Finish_Train";
+  case MsgType::Control_Barrier: return "Control_Barrier";
+  case MsgType::Control_Reply_Barrier: return "Control_Reply_Barrier";
+  case MsgType::Control_Register: return "Control_Register";
+  case MsgType::Control_Reply_Register: return "Control_Reply_Register";
+  default: return std::to_string(type);
+  }
+}
+
 class Message {
 public:
+  Message() { memset(header_, 0, sizeof(header_)); }
+
   MsgType type() const { return static_cast<MsgType>(header_[2]); }
   inline int src() const { return header_[0]; }
   inline int dst() const { return header_[1]; }
   inline int table_id() const { return header_[3]; }
   inline int msg_id() const { return header_[4]; }
+  // sampled request this message is part of, 0 if none, see util/tracer.h
+  inline int trace_id() const { return header_[5]; }
 
   inline void set_type(MsgType type) { header_[2] = static_cast<int>(type); }
   inline void set_src(int src) { header_[0] = src; }
   inline void set_dst(int dst) { header_[1] = dst; }
   inline void set_table_id(int table_id) { header_[3] = table_id; }
   inline void set_msg_id(int msg_id) { header_[4] = msg_id; }
+  inline void set_trace_id(int trace_id) { header_[5] = trace_id; }
 
   inline void set_data(const std::vector<Blob>& data) { 
     data_ = std::move(data); }
@@ -55,6 +80,7 @@ public:
     reply->set_type(static_cast<MsgType>(-header_[2]));
     reply->set_table_id(this->table_id());
     reply->set_msg_id(this->msg_id());
+    reply->set_trace_id(this->trace_id());
     return reply;
   }
 
@@ -1,6 +1,7 @@
 #ifndef MULTIVERSO_INCLUDE_MULTIVERSO_H_
 #define MULTIVERSO_INCLUDE_MULTIVERSO_H_
 
+#include <functional>
 #include <string>
 #include "table_factory.h"
 
@@ -40,7 +41,17 @@ MV_CreateTable(const TableOptionType& option) {
   return table;
 }
 
-// inplace sum by allreduce
+// Snapshot the server tables of this rank, if a server, as of the requests
+// it served so far. Each table shard is written to <path>.<server id>.<table
+// id> of uri, e.g. hdfs:///ckpt/model?buffer=8M, in the background while
+// the tables keep serving, see ServerTable::StartSnapshot. Returns once the
+// snapshot point is marked; the previous snapshot is written before the next
+// one starts, and all are by MV_ShutDown. Call after MV_Barrier for a
+// snapshot consistent across the servers. Does nothing with -ma, which runs
+// no server
+void MV_Snapshot(const std::string& uri);
+
+// inplace sum by allreduce, among the local ranks under MV_RunLocal
 template <typename ElemType>
 void MV_Aggregate(ElemType* data, int size);
 
@@ -64,6 +75,16 @@ int  MV_NetBind(int rank, char* endpoint);
 int  MV_NetConnect(int* rank, char* endpoint[], int size);
 void MV_NetFinalize();
 
+// --- Local API ------------------------------------------------------------ //
+// Run num_ranks ranks as threads of this process, with no MPI/ZMQ involved.
+// Messages between ranks are moved in memory without serialization. Each rank
+// calls MV_Init, func(rank) and MV_ShutDown in its own thread, all the
+// MV_* API called in func refers to that rank, MV_Aggregate sums over the
+// local ranks and MV_NetBind/MV_NetConnect fail since there is no endpoint.
+// Flags should be set with MV_SetFlag before, since they are shared by all
+// the ranks.
+void MV_RunLocal(int num_ranks, const std::function<void(int)>& func);
+
 }  // namespace multiverso
 
 #endif  // MULTIVERSO_INCLUDE_MULTIVERSO_H_
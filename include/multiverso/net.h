@@ -37,6 +37,11 @@ public:
   // \return 1. > 0 received size 2. = 0 not received 3. < 0 net error
   virtual int Recv(MessagePtr* msg) = 0;
 
+  // Blocking, wait at most timeout_ms milliseconds for a message to Recv.
+  // Nets without a way to wait on incoming messages just sleep
+  // \return false if it's known that nothing arrived
+  virtual bool Poll(int timeout_ms);
+
   // Blocking, send raw data to rank
   virtual void SendTo(int rank, char* buf, int len) const = 0;
   // Blocking, receive raw data from rank 
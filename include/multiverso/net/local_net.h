@@ -0,0 +1,155 @@
+#ifndef MULTIVERSO_NET_LOCAL_NET_H_
+#define MULTIVERSO_NET_LOCAL_NET_H_
+
+#include "multiverso/net.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "multiverso/message.h"
+#include "multiverso/util/log.h"
+#include "multiverso/util/mt_queue.h"
+
+namespace multiverso {
+
+// In place sum of the buffers of all the ranks of the process, the
+// Allreduce of the local ranks
+class LocalReducer {
+public:
+  explicit LocalReducer(int num_ranks)
+    : num_ranks_(num_ranks), arrived_(0), leaving_(0), round_(0) {}
+
+  // Blocking, returns when all the ranks called it for this round
+  template <typename T>
+  void Allreduce(T* data, size_t elem_count) {
+    size_t bytes = elem_count * sizeof(T);
+    std::unique_lock<std::mutex> lock(mutex_);
+    // the previous round is still copied out by some ranks
+    cv_.wait(lock, [this]{ return leaving_ == 0; });
+    if (arrived_ == 0) {
+      sum_.assign(reinterpret_cast<char*>(data),
+                  reinterpret_cast<char*>(data) + bytes);
+    } else {
+      CHECK(sum_.size() == bytes);
+      T* sum = reinterpret_cast<T*>(sum_.data());
+      for (size_t i = 0; i < elem_count; ++i) sum[i] += data[i];
+    }
+    long long round = round_;
+    if (++arrived_ == num_ranks_) {
+      arrived_ = 0;
+      leaving_ = num_ranks_;
+      ++round_;
+      cv_.notify_all();
+    } else {
+      cv_.wait(lock, [this, round]{ return round_ != round; });
+    }
+    memcpy(data, sum_.data(), bytes);
+    if (--leaving_ == 0) cv_.notify_all();
+  }
+
+private:
+  int num_ranks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<char> sum_;
+  // ranks added to sum_ and ranks yet to copy it out
+  int arrived_;
+  int leaving_;
+  long long round_;
+};
+
+// Net among ranks running as threads of one process. Messages are moved into
+// the mailbox of the destination rank, nothing is serialized or copied.
+class LocalNetWrapper : public NetInterface {
+public:
+  // One mailbox for each rank, shared by all the ranks of the process
+  typedef std::vector<std::unique_ptr<MtQueue<MessagePtr>>> Mailboxes;
+
+  LocalNetWrapper(int rank, Mailboxes* mailboxes, LocalReducer* reducer)
+    : active_(false), rank_(rank), mailboxes_(mailboxes), reducer_(reducer) {
+    CHECK_NOTNULL(mailboxes_);
+    CHECK_NOTNULL(reducer_);
+    CHECK(rank_ >= 0 && rank_ < static_cast<int>(mailboxes_->size()));
+  }
+
+  void Init(int*, char**) override {
+    active_ = true;
+    Log::Debug("%s net util inited, rank = %d, size = %d\n",
+      name().c_str(), rank(), size());
+  }
+
+  void Finalize() override { active_ = false; }
+
+  int Bind(int, char*) override {
+    Log::Fatal("Shouldn't call this in local Net\n");
+    return -1;
+  }
+
+  int Connect(int*, char* [], int) override {
+    Log::Fatal("Shouldn't call this in local Net\n");
+    return -1;
+  }
+
+  bool active() const override { return active_; }
+  int rank() const override { return rank_; }
+  int size() const override { return static_cast<int>(mailboxes_->size()); }
+  std::string name() const override { return "Local"; }
+
+  int Send(MessagePtr& msg) override {
+    if (msg.get() == nullptr) return 0;
+    int size = MessageSize(msg);
+    (*mailboxes_)[msg->dst()]->Push(msg);
+    return size;
+  }
+
+  int Recv(MessagePtr* msg) override {
+    if (!(*mailboxes_)[rank_]->TryPop(*msg)) return 0;
+    return MessageSize(*msg);
+  }
+
+  bool Poll(int timeout_ms) override {
+    return (*mailboxes_)[rank_]->Wait(timeout_ms);
+  }
+
+  void SendTo(int, char*, int) const override {
+    Log::Fatal("Shouldn't call this in local Net\n");
+  }
+
+  void RecvFrom(int, char*, int) const override {
+    Log::Fatal("Shouldn't call this in local Net\n");
+  }
+
+  void SendRecv(int, char*, int, int, char*, int) const override {
+    Log::Fatal("Shouldn't call this in local Net\n");
+  }
+
+  int thread_level_support() override {
+    return NetThreadLevel::THREAD_MULTIPLE;
+  }
+
+  // inplace allreduce among the local ranks
+  template <typename T>
+  void Allreduce(T* data, size_t elem_count) {
+    reducer_->Allreduce(data, elem_count);
+  }
+
+private:
+  int MessageSize(const MessagePtr& msg) const {
+    size_t size = Message::kHeaderSize;
+    for (auto& data : msg->data()) size += data.size();
+    return static_cast<int>(size);
+  }
+
+  bool active_;
+  int rank_;
+  Mailboxes* mailboxes_;
+  LocalReducer* reducer_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_NET_LOCAL_NET_H_
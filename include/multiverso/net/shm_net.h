@@ -0,0 +1,459 @@
+#ifndef MULTIVERSO_NET_SHM_NET_H_
+#define MULTIVERSO_NET_SHM_NET_H_
+
+#ifndef _WIN32
+
+#include "multiverso/net.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "multiverso/message.h"
+#include "multiverso/util/log.h"
+
+namespace multiverso {
+
+// Single producer single consumer byte ring laid out in a shared memory
+// segment. Only the producer moves tail, only the consumer moves head, so no
+// lock is needed as long as 64-bit atomics are address free (true on all
+// platforms where POSIX shared memory is available to us).
+class ShmRing {
+public:
+  struct Header {
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) uint64_t capacity;
+  };
+
+  static size_t SegmentSize(size_t capacity) {
+    return sizeof(Header) + capacity;
+  }
+
+  ShmRing() : header_(nullptr), data_(nullptr), capacity_(0) {}
+
+  // capacity should be a power of 2
+  void Attach(void* segment, size_t capacity, bool init) {
+    CHECK((capacity & (capacity - 1)) == 0);
+    header_ = reinterpret_cast<Header*>(segment);
+    data_ = reinterpret_cast<char*>(segment) + sizeof(Header);
+    capacity_ = capacity;
+    if (init) {
+      header_->head.store(0, std::memory_order_relaxed);
+      header_->tail.store(0, std::memory_order_relaxed);
+      header_->capacity = capacity;
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+    CHECK(header_->capacity == capacity_);
+  }
+
+  // Producer side. Copy at most len bytes into the ring
+  // \return number of bytes written
+  size_t Write(const char* buf, size_t len) {
+    uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    uint64_t head = header_->head.load(std::memory_order_acquire);
+    size_t n = std::min(len, static_cast<size_t>(capacity_ - (tail - head)));
+    if (n == 0) return 0;
+    size_t pos = static_cast<size_t>(tail & (capacity_ - 1));
+    size_t first = std::min(n, capacity_ - pos);
+    memcpy(data_ + pos, buf, first);
+    memcpy(data_, buf + first, n - first);
+    header_->tail.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  // Consumer side. Copy at most len bytes out of the ring
+  // \return number of bytes read
+  size_t Read(char* buf, size_t len) {
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    size_t n = std::min(len, static_cast<size_t>(tail - head));
+    if (n == 0) return 0;
+    size_t pos = static_cast<size_t>(head & (capacity_ - 1));
+    size_t first = std::min(n, capacity_ - pos);
+    memcpy(buf, data_ + pos, first);
+    memcpy(buf + first, data_, n - first);
+    header_->head.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+  // Consumer side
+  bool Empty() const {
+    return header_->tail.load(std::memory_order_acquire) ==
+           header_->head.load(std::memory_order_relaxed);
+  }
+
+private:
+  Header* header_;
+  char* data_;
+  size_t capacity_;
+};
+
+// Decorator over another NetInterface. Messages between ranks on the same host
+// go through shared memory rings, the others go through the underlying net.
+// A message is streamed into the ring piece by piece, so messages larger than
+// the ring are fine, and Send never blocks when the ring is full: the rest of
+// the message is pushed by later Send/Recv calls. Messages of one ordered pair
+// of ranks always take the same path, so their order is kept.
+class ShmNetWrapper : public NetInterface {
+public:
+  // buffer_size is the size(MB) of each ring, see the shm_buffer_size flag
+  ShmNetWrapper(NetInterface* net, int buffer_size)
+    : net_(net), kover_(std::numeric_limits<size_t>::max()),
+      buffer_size_(buffer_size), poll_net_first_(false) {}
+
+  void Init(int* argc, char** argv) override {
+    net_->Init(argc, argv);
+    if (net_->size() > 1) SetupSharedMemory();
+  }
+
+  void Finalize() override {
+    for (auto& peer : peers_) {
+      if (peer.send_segment != nullptr) munmap(peer.send_segment, segment_size_);
+      if (peer.recv_segment != nullptr) munmap(peer.recv_segment, segment_size_);
+    }
+    peers_.clear();
+    net_->Finalize();
+  }
+
+  // Only the Init path sets up shared memory, ranks bound through
+  // Bind/Connect always use the underlying net
+  int Bind(int rank, char* endpoint) override {
+    return net_->Bind(rank, endpoint);
+  }
+
+  int Connect(int* rank, char* endpoints[], int size) override {
+    return net_->Connect(rank, endpoints, size);
+  }
+
+  bool active() const override { return net_->active(); }
+  int rank() const override { return net_->rank(); }
+  int size() const override { return net_->size(); }
+  std::string name() const override { return "SHM+" + net_->name(); }
+
+  int Send(MessagePtr& msg) override {
+    int size = 0;
+    if (msg.get() != nullptr && IsLocal(msg->dst())) {
+      Peer& peer = peers_[msg->dst()];
+      std::lock_guard<std::mutex> lock(peer.mutex);
+      size = static_cast<int>(MessageSize(msg));
+      peer.send_queue.push_back(std::move(msg));
+      FlushLocked(&peer);
+    } else {
+      size = net_->Send(msg);
+    }
+    FlushAll();
+    return size;
+  }
+
+  int Recv(MessagePtr* msg) override {
+    // Keep pushing partial messages when the net has no sending thread
+    // calling Send with an empty message, e.g. ZMQ
+    FlushAll();
+    poll_net_first_ = !poll_net_first_;
+    if (poll_net_first_) {
+      int size = net_->Recv(msg);
+      if (size > 0) return size;
+      return RecvLocal(msg) ? static_cast<int>(MessageSize(*msg)) : size;
+    }
+    if (RecvLocal(msg)) return static_cast<int>(MessageSize(*msg));
+    return net_->Recv(msg);
+  }
+
+  // Waits on the underlying net, at most kLocalPollMs at a time when there
+  // are local peers since the rings can't wake it up
+  bool Poll(int timeout_ms) override {
+    const int kLocalPollMs = 1;
+    if (local_ranks_.empty()) return net_->Poll(timeout_ms);
+    if (PendingLocal()) return true;
+    return net_->Poll(std::min(timeout_ms, kLocalPollMs)) || PendingLocal();
+  }
+
+  void SendTo(int rank, char* buf, int len) const override {
+    net_->SendTo(rank, buf, len);
+  }
+
+  void RecvFrom(int rank, char* buf, int len) const override {
+    net_->RecvFrom(rank, buf, len);
+  }
+
+  void SendRecv(int send_rank, char* send_buf, int send_len,
+    int recv_rank, char* recv_buf, int recv_len) const override {
+    net_->SendRecv(send_rank, send_buf, send_len,
+                   recv_rank, recv_buf, recv_len);
+  }
+
+  int thread_level_support() override {
+    return net_->thread_level_support();
+  }
+
+private:
+  struct Peer {
+    Peer() : send_segment(nullptr), recv_segment(nullptr),
+      send_piece(0), send_offset(0), recv_state(kRecvHeader),
+      recv_offset(0) {}
+
+    ShmRing send_ring;
+    ShmRing recv_ring;
+    void* send_segment;
+    void* recv_segment;
+
+    // sending side, protected by mutex
+    std::mutex mutex;
+    std::deque<MessagePtr> send_queue;
+    std::vector<std::pair<const char*, size_t>> send_pieces;
+    std::vector<size_t> send_sizes;
+    size_t send_piece;
+    size_t send_offset;
+
+    // receiving side, only touched by the receiving thread
+    enum { kRecvHeader, kRecvSize, kRecvData } recv_state;
+    MessagePtr recv_msg;
+    size_t recv_blob_size;
+    size_t recv_offset;
+  };
+
+  // \return true if a ring has data to read or a message is left to send
+  bool PendingLocal() {
+    for (int i : local_ranks_) {
+      Peer& peer = peers_[i];
+      if (!peer.recv_ring.Empty()) return true;
+      std::lock_guard<std::mutex> lock(peer.mutex);
+      if (!peer.send_queue.empty()) return true;
+    }
+    return false;
+  }
+
+  bool IsLocal(int rank) const {
+    return !peers_.empty() && rank != net_->rank() &&
+           peers_[rank].send_segment != nullptr;
+  }
+
+  size_t MessageSize(const MessagePtr& msg) const {
+    size_t size = Message::kHeaderSize + sizeof(size_t);
+    for (auto& data : msg->data()) size += sizeof(size_t) + data.size();
+    return size;
+  }
+
+  void FlushAll() {
+    for (auto& peer : peers_) {
+      if (peer.send_segment == nullptr) continue;
+      std::lock_guard<std::mutex> lock(peer.mutex);
+      FlushLocked(&peer);
+    }
+  }
+
+  // Stream queued messages into the ring until it is full. Same layout as
+  // MPINetWrapper: header, (size, data) for each blob, then an over tag
+  void FlushLocked(Peer* peer) {
+    while (!peer->send_queue.empty()) {
+      if (peer->send_pieces.empty()) {
+        MessagePtr& msg = peer->send_queue.front();
+        peer->send_sizes.clear();
+        for (auto& data : msg->data()) peer->send_sizes.push_back(data.size());
+        peer->send_pieces.emplace_back(
+          reinterpret_cast<const char*>(msg->header()),
+          static_cast<size_t>(Message::kHeaderSize));
+        for (size_t i = 0; i < msg->data().size(); ++i) {
+          peer->send_pieces.emplace_back(
+            reinterpret_cast<const char*>(&peer->send_sizes[i]), sizeof(size_t));
+          peer->send_pieces.emplace_back(msg->data()[i].data(),
+                                         msg->data()[i].size());
+        }
+        peer->send_pieces.emplace_back(
+          reinterpret_cast<const char*>(&kover_), sizeof(size_t));
+        peer->send_piece = 0;
+        peer->send_offset = 0;
+      }
+      while (peer->send_piece < peer->send_pieces.size()) {
+        auto& piece = peer->send_pieces[peer->send_piece];
+        peer->send_offset += peer->send_ring.Write(
+          piece.first + peer->send_offset, piece.second - peer->send_offset);
+        if (peer->send_offset < piece.second) return;  // ring is full
+        ++peer->send_piece;
+        peer->send_offset = 0;
+      }
+      peer->send_pieces.clear();
+      peer->send_queue.pop_front();
+    }
+  }
+
+  bool RecvLocal(MessagePtr* msg) {
+    int n = static_cast<int>(local_ranks_.size());
+    for (int i = 0; i < n; ++i) {
+      recv_cursor_ = (recv_cursor_ + 1) % n;
+      Peer& peer = peers_[local_ranks_[recv_cursor_]];
+      if (ReadFrom(&peer)) {
+        *msg = std::move(peer.recv_msg);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Advance the receiving state machine of peer as far as the ring allows
+  // \return true if a whole message has been received
+  bool ReadFrom(Peer* peer) {
+    while (true) {
+      switch (peer->recv_state) {
+      case Peer::kRecvHeader: {
+        if (peer->recv_msg.get() == nullptr) peer->recv_msg.reset(new Message());
+        char* header = reinterpret_cast<char*>(peer->recv_msg->header());
+        peer->recv_offset += peer->recv_ring.Read(header + peer->recv_offset,
+          Message::kHeaderSize - peer->recv_offset);
+        if (peer->recv_offset < Message::kHeaderSize) return false;
+        peer->recv_state = Peer::kRecvSize;
+        peer->recv_offset = 0;
+        break;
+      }
+      case Peer::kRecvSize: {
+        char* size = reinterpret_cast<char*>(&peer->recv_blob_size);
+        peer->recv_offset += peer->recv_ring.Read(size + peer->recv_offset,
+          sizeof(size_t) - peer->recv_offset);
+        if (peer->recv_offset < sizeof(size_t)) return false;
+        peer->recv_offset = 0;
+        if (peer->recv_blob_size == kover_) {
+          peer->recv_state = Peer::kRecvHeader;
+          return true;
+        }
+        if (peer->recv_blob_size == 0) {
+          peer->recv_msg->Push(Blob());
+          break;
+        }
+        peer->recv_msg->Push(Blob(peer->recv_blob_size));
+        peer->recv_state = Peer::kRecvData;
+        break;
+      }
+      case Peer::kRecvData: {
+        peer->recv_offset += peer->recv_ring.Read(
+          peer->recv_msg->data().back().data() + peer->recv_offset,
+          peer->recv_blob_size - peer->recv_offset);
+        if (peer->recv_offset < peer->recv_blob_size) return false;
+        peer->recv_state = Peer::kRecvSize;
+        peer->recv_offset = 0;
+        break;
+      }
+      }
+    }
+  }
+
+  // Gather one value from every rank, through rank 0 and the blocking raw
+  // channel of the underlying net. The sender rank travels with the value
+  // since ZMQ RecvFrom can not choose the source.
+  std::vector<long long> AllGather(long long value) {
+    int rank = net_->rank(), size = net_->size();
+    std::vector<long long> result(size);
+    long long pair[2] = { rank, value };
+    if (rank == 0) {
+      result[0] = value;
+      for (int i = 1; i < size; ++i) {
+        net_->RecvFrom(i, reinterpret_cast<char*>(pair), sizeof(pair));
+        result[pair[0]] = pair[1];
+      }
+      for (int i = 1; i < size; ++i) {
+        net_->SendTo(i, reinterpret_cast<char*>(result.data()),
+                     static_cast<int>(sizeof(long long) * size));
+      }
+    } else {
+      net_->SendTo(0, reinterpret_cast<char*>(pair), sizeof(pair));
+      net_->RecvFrom(0, reinterpret_cast<char*>(result.data()),
+                     static_cast<int>(sizeof(long long) * size));
+    }
+    return result;
+  }
+
+  std::string SegmentName(long long job, int src, int dst) const {
+    return "/multiverso_" + std::to_string(job) + "_" +
+      std::to_string(src) + "_" + std::to_string(dst);
+  }
+
+  void* MapSegment(const std::string& name, bool create) {
+    int flags = create ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR;
+    int fd = shm_open(name.c_str(), flags, 0600);
+    if (fd < 0 && create) {
+      // left by a crashed job with the same id
+      shm_unlink(name.c_str());
+      fd = shm_open(name.c_str(), flags, 0600);
+    }
+    if (fd < 0) {
+      Log::Fatal("Failed to open shared memory %s\n", name.c_str());
+    }
+    if (create && ftruncate(fd, segment_size_) != 0) {
+      Log::Fatal("Failed to resize shared memory %s\n", name.c_str());
+    }
+    void* segment = mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) {
+      Log::Fatal("Failed to map shared memory %s\n", name.c_str());
+    }
+    return segment;
+  }
+
+  void SetupSharedMemory() {
+    int rank = net_->rank(), size = net_->size();
+    char hostname[256] = { 0 };
+    gethostname(hostname, sizeof(hostname) - 1);
+    long long host = static_cast<long long>(
+      std::hash<std::string>()(std::string(hostname)));
+    std::vector<long long> hosts = AllGather(host);
+    long long token = static_cast<long long>(getpid()) ^
+      std::chrono::system_clock::now().time_since_epoch().count();
+    long long job = AllGather(token)[0] & std::numeric_limits<int>::max();
+
+    size_t capacity = 1;
+    while (capacity < static_cast<size_t>(buffer_size_) << 20) {
+      capacity <<= 1;
+    }
+    segment_size_ = ShmRing::SegmentSize(capacity);
+
+    peers_ = std::vector<Peer>(size);
+    for (int i = 0; i < size; ++i) {
+      if (i != rank && hosts[i] == host) local_ranks_.push_back(i);
+    }
+    recv_cursor_ = 0;
+    // The receiver creates the rings it reads from
+    for (int i : local_ranks_) {
+      peers_[i].recv_segment = MapSegment(SegmentName(job, i, rank), true);
+      peers_[i].recv_ring.Attach(peers_[i].recv_segment, capacity, true);
+    }
+    AllGather(0);
+    for (int i : local_ranks_) {
+      peers_[i].send_segment = MapSegment(SegmentName(job, rank, i), false);
+      peers_[i].send_ring.Attach(peers_[i].send_segment, capacity, false);
+    }
+    AllGather(0);
+    // Everyone has mapped, unlink now so nothing leaks if we crash later
+    for (int i : local_ranks_) shm_unlink(SegmentName(job, i, rank).c_str());
+    Log::Info("%s net util inited, rank = %d, %d local peers\n",
+      name().c_str(), rank, static_cast<int>(local_ranks_.size()));
+  }
+
+  NetInterface* net_;
+  const size_t kover_;
+  std::vector<Peer> peers_;
+  std::vector<int> local_ranks_;
+  int buffer_size_;
+  size_t segment_size_;
+  int recv_cursor_;
+  bool poll_net_first_;
+};
+
+}  // namespace multiverso
+
+#endif  // _WIN32
+
+#endif  // MULTIVERSO_NET_SHM_NET_H_
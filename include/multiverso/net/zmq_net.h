@@ -197,6 +197,10 @@ public:
     return size;
   }
 
+  bool Poll(int timeout_ms) override {
+    zmq_pollitem_t item = { receiver_.socket, 0, ZMQ_POLLIN, 0 };
+    return zmq_poll(&item, 1, timeout_ms) > 0;
+  }
 
   void SendTo(int rank, char* buf, int len) const override {
     int send_size = 0;
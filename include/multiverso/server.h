@@ -1,6 +1,7 @@
 #ifndef MULTIVERSO_SERVER_H_
 #define MULTIVERSO_SERVER_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -8,19 +9,33 @@
 
 namespace multiverso {
 
+class ServerScheduler;
 class ServerTable;
+class Snapshot;
 
 class Server : public Actor {
 public:
   Server();
+  ~Server() override;
   static Server* GetServer();
   int RegisterTable(ServerTable* table);
 
 protected:
+  // Serves the requests in the order picked by the scheduler
+  void Main() override;
+
   virtual void ProcessGet(MessagePtr& msg);
   virtual void ProcessAdd(MessagePtr& msg);
+  // Starts the snapshots of the tables at this point of the requests
+  virtual void ProcessSnapshot(MessagePtr& msg);
+  // Waits for the snapshots being written
+  void WaitSnapshots();
 
   std::vector<ServerTable*> store_;
+  std::vector<std::shared_ptr<Snapshot>> snapshots_;
+
+private:
+  std::unique_ptr<ServerScheduler> scheduler_;
 };
 
 }  // namespace multiverso
@@ -0,0 +1,65 @@
+#ifndef MULTIVERSO_SERVER_SCHEDULER_H_
+#define MULTIVERSO_SERVER_SCHEDULER_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "multiverso/message.h"
+#include "multiverso/util/timer.h"
+
+namespace multiverso {
+
+class Gauge;
+
+// Orders the requests queued at the server. Requests from one source are
+// always served in arrival order, so a worker sees the effects of its own
+// Adds, the policy only picks whose oldest request goes next:
+// - fifo: the oldest one
+// - get_first: the oldest Get if any, a small Get doesn't wait behind
+//   large Adds of other workers
+// - weighted: get_weight Gets for each other request when both wait
+// - round_robin: one request from each source in turn
+class ServerScheduler {
+public:
+  // num_sources is the number of ranks sending requests
+  ServerScheduler(const std::string& policy, int num_sources, int get_weight);
+
+  bool Empty() const { return size_ == 0; }
+
+  void Push(MessagePtr& msg);
+  // \return false if no request is queued
+  bool Pop(MessagePtr* msg);
+
+private:
+  enum Policy { kFifo, kGetFirst, kWeighted, kRoundRobin };
+  enum Kind { kAny, kGet, kOther };
+
+  struct Entry {
+    MessagePtr msg;
+    long long seq;
+    // started on construction, the time the request is queued
+    Timer timer;
+    // wall clock of the queueing of traced requests
+    int64_t queued;
+  };
+
+  // \return the source of the oldest queue head of kind, -1 if none
+  int Oldest(Kind kind) const;
+
+  Policy policy_;
+  // queued requests of each source rank
+  std::vector<std::deque<Entry>> queues_;
+  size_t size_;
+  long long seq_;
+  size_t next_;
+  int get_weight_;
+  int credit_;
+  // size_, for the metrics exports
+  Gauge* depth_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_SERVER_SCHEDULER_H_
@@ -3,8 +3,12 @@
 
 #include "multiverso/multiverso.h"
 #include "multiverso/table_interface.h"
+#include "multiverso/table/delta_buffer.h"
+#include "multiverso/table/mapped_storage.h"
 #include "multiverso/util/log.h"
 
+#include <memory>
+
 namespace multiverso {
 
 template<typename EleType>
@@ -55,13 +59,26 @@ public:
                   std::vector<Blob>* result) override;
 
   void Store(Stream* s) override;
+  // adopts the values of a private MmapStream, see MappedStorage
   void Load(Stream* s) override;
+  std::shared_ptr<Snapshot> StartSnapshot(Stream* s) override;
+
+  // deltas merged for each update when aggregating Adds
+  double merge_ratio() const {
+    return delta_buffer_ == nullptr ? 1.0 : delta_buffer_->merge_ratio();
+  }
 
 private:
+  // Apply the deltas summed by the aggregation buffer
+  void Flush();
+
   int32_t server_id_;
-  std::vector<T> storage_;
+  MappedStorage<T> storage_;
   Updater<T>* updater_;
   size_t size_; // number of element with type T
+  // sums deltas of Adds when aggregate_adds is set
+  std::unique_ptr<DeltaBuffer<T>> delta_buffer_;
+  int buffered_adds_;
   
 };
 
@@ -0,0 +1,89 @@
+#ifndef MULTIVERSO_TABLE_DELTA_BUFFER_H_
+#define MULTIVERSO_TABLE_DELTA_BUFFER_H_
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "multiverso/dashboard.h"
+#include "multiverso/util/log.h"
+
+namespace multiverso {
+
+// Sums the deltas Added to the rows of a server table, so that rows updated
+// by many workers between two reads pay a single pass of the updater. Only
+// valid for updaters where applying a sum equals applying its terms, see
+// Updater::linear.
+template <typename T>
+class DeltaBuffer {
+public:
+  DeltaBuffer(size_t num_row, size_t row_size)
+    : row_size_(row_size), slots_(num_row, -1),
+      rows_added_(0), rows_staged_(0), gauge_(nullptr) {}
+
+  // Exports the merge ratio of table_id, in percent, after each FlushAll
+  void ExportMergeRatio(int table_id) {
+    gauge_ = Dashboard::GetGauge("SERVER_ADD_MERGE_PERCENT[table " +
+      std::to_string(table_id) + "]");
+  }
+
+  // Sums delta into the staged delta of row
+  void Add(size_t row, const T* delta) {
+    ++rows_added_;
+    int slot = slots_[row];
+    if (slot < 0) {
+      ++rows_staged_;
+      slot = static_cast<int>(rows_.size());
+      slots_[row] = slot;
+      rows_.push_back(row);
+      deltas_.resize(deltas_.size() + row_size_);
+      memcpy(deltas_.data() + slot * row_size_, delta, row_size_ * sizeof(T));
+      return;
+    }
+    T* staged = deltas_.data() + slot * row_size_;
+    for (size_t i = 0; i < row_size_; ++i) staged[i] += delta[i];
+  }
+
+  // Calls apply(row, delta) if row has a staged delta, and drops it
+  template <typename Func>
+  void Flush(size_t row, Func apply) {
+    int slot = slots_[row];
+    if (slot < 0) return;
+    apply(row, deltas_.data() + slot * row_size_);
+    slots_[row] = -1;
+  }
+
+  // Applies all the staged deltas
+  template <typename Func>
+  void FlushAll(Func apply) {
+    for (size_t row : rows_) Flush(row, apply);
+    rows_.clear();
+    deltas_.clear();
+    if (gauge_ != nullptr) gauge_->Set(std::llround(merge_ratio() * 100));
+  }
+
+  bool empty() const { return rows_.empty(); }
+
+  // row deltas Added for each updater pass, 1 when nothing was merged
+  double merge_ratio() const {
+    return rows_staged_ == 0 ? 1.0 :
+      static_cast<double>(rows_added_) / rows_staged_;
+  }
+
+private:
+  size_t row_size_;
+  // slot of each row in deltas_, -1 if not staged
+  std::vector<int> slots_;
+  // staged rows, in staging order
+  std::vector<size_t> rows_;
+  std::vector<T> deltas_;
+  size_t rows_added_;
+  // rows_added_ which didn't find their row staged
+  size_t rows_staged_;
+  Gauge* gauge_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_TABLE_DELTA_BUFFER_H_
@@ -0,0 +1,289 @@
+#ifndef MULTIVERSO_TABLE_KV_EMBEDDING_TABLE_H_
+#define MULTIVERSO_TABLE_KV_EMBEDDING_TABLE_H_
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "multiverso/multiverso.h"
+#include "multiverso/table_interface.h"
+#include "multiverso/table/kv_snapshot.h"
+#include "multiverso/updater/updater.h"
+#include "multiverso/util/flat_hash_map.h"
+#include "multiverso/util/log.h"
+
+namespace multiverso {
+
+template <typename Key, typename T>
+struct KVEmbeddingTableOption;
+
+// A distributed hash map from integer keys to vectors of dim values, e.g.
+// the embeddings of hashed features. Servers apply Adds through the
+// updater of updater_type like the matrix tables, and create the value of
+// a key on its first Get or Add.
+template <typename Key, typename T>
+class KVEmbeddingWorkerTable : public WorkerTable {
+public:
+  explicit KVEmbeddingWorkerTable(const KVEmbeddingTableOption<Key, T>& option)
+    : dim_(option.dim) {
+    CHECK(dim_ > 0);
+  }
+
+  size_t dim() const { return dim_; }
+
+  // data is user-allocated memory of keys.size() * dim values, row i gets
+  // the value of keys[i]
+  void Get(const std::vector<Key>& keys, T* data) {
+    Get(keys.data(), keys.size(), data);
+  }
+
+  void Get(const Key* keys, size_t num_keys, T* data) {
+    if (num_keys == 0) return;
+    // each key is requested once and copied to its repetitions
+    rows_.clear();
+    rows_.reserve(num_keys);
+    unique_.clear();
+    for (size_t i = 0; i < num_keys; ++i) {
+      T*& row = rows_[keys[i]];
+      if (row != nullptr) continue;
+      row = data + i * dim_;
+      unique_.push_back(keys[i]);
+    }
+    WorkerTable::Get(Blob(unique_.data(), unique_.size() * sizeof(Key)));
+    for (size_t i = 0; i < num_keys; ++i) {
+      T* row = *rows_.find(keys[i]);
+      if (row != data + i * dim_) memcpy(data + i * dim_, row, dim_ * sizeof(T));
+    }
+  }
+
+  // deltas holds keys.size() * dim values, row i is the delta of keys[i]
+  void Add(const std::vector<Key>& keys, const T* deltas,
+           const AddOption* option = nullptr) {
+    Wait(AddAsync(keys.data(), keys.size(), deltas, option));
+  }
+
+  int AddAsync(const Key* keys, size_t num_keys, const T* deltas,
+               const AddOption* option = nullptr) {
+    CHECK(num_keys > 0);
+    // the stateful updaters read the learning rate of the option
+    AddOption default_option;
+    return WorkerTable::AddAsync(Blob(keys, num_keys * sizeof(Key)),
+      Blob(deltas, num_keys * dim_ * sizeof(T)),
+      option != nullptr ? option : &default_option);
+  }
+
+  int Partition(const std::vector<Blob>& kv,
+    MsgType, std::unordered_map<int, std::vector<Blob> >* out) override {
+    CHECK(kv.size() == 1 || kv.size() == 3);
+    CHECK_NOTNULL(out);
+    int num_server = MV_NumServers();
+    size_t num_keys = kv[0].size<Key>();
+    const Key* keys = reinterpret_cast<const Key*>(kv[0].data());
+    dest_.resize(num_keys);
+    counts_.assign(num_server, 0);
+    for (size_t i = 0; i < num_keys; ++i) {
+      dest_[i] = static_cast<int>(static_cast<size_t>(keys[i]) % num_server);
+      ++counts_[dest_[i]];
+    }
+    std::vector<Key*> out_keys(num_server, nullptr);
+    std::vector<T*> out_vals(num_server, nullptr);
+    for (int dst = 0; dst < num_server; ++dst) {
+      if (counts_[dst] == 0) continue;
+      std::vector<Blob>& vec = (*out)[MV_ServerIdToRank(dst)];
+      vec.push_back(Blob(counts_[dst] * sizeof(Key)));
+      out_keys[dst] = reinterpret_cast<Key*>(vec.back().data());
+      if (kv.size() == 3) {
+        vec.push_back(Blob(counts_[dst] * dim_ * sizeof(T)));
+        out_vals[dst] = reinterpret_cast<T*>(vec.back().data());
+        vec.push_back(kv[2]);
+      }
+    }
+    const T* vals = kv.size() == 3 ?
+      reinterpret_cast<const T*>(kv[1].data()) : nullptr;
+    for (size_t i = 0; i < num_keys; ++i) {
+      int dst = dest_[i];
+      *out_keys[dst]++ = keys[i];
+      if (vals == nullptr) continue;
+      memcpy(out_vals[dst], vals + i * dim_, dim_ * sizeof(T));
+      out_vals[dst] += dim_;
+    }
+    return static_cast<int>(out->size());
+  }
+
+  void ProcessReplyGet(std::vector<Blob>& data) override {
+    CHECK(data.size() == 2);
+    size_t num_keys = data[0].size<Key>();
+    CHECK(num_keys * dim_ == data[1].size<T>());
+    const Key* keys = reinterpret_cast<const Key*>(data[0].data());
+    const T* vals = reinterpret_cast<const T*>(data[1].data());
+    for (size_t i = 0; i < num_keys; ++i) {
+      memcpy(*rows_.find(keys[i]), vals + i * dim_, dim_ * sizeof(T));
+    }
+  }
+
+private:
+  size_t dim_;
+  // first row of each key in the buffer of the running Get
+  FlatHashMap<Key, T*> rows_;
+  std::vector<Key> unique_;
+  // scratch of Partition
+  std::vector<int> dest_;
+  std::vector<size_t> counts_;
+};
+
+// The values are kept in chunks of kChunkKeys rows, filled in the order the
+// keys arrive, and the hash table maps a key to its row. Each chunk has its
+// own updater, so the optimizer state is allocated lazily by rows as for
+// the matrix tables.
+template <typename Key, typename T>
+class KVEmbeddingServerTable : public ServerTable {
+public:
+  explicit KVEmbeddingServerTable(const KVEmbeddingTableOption<Key, T>& option)
+    : dim_(option.dim), init_min_(option.init_min),
+      init_max_(option.init_max), num_rows_(0), gen_(MV_ServerId()) {
+    CHECK(dim_ > 0);
+  }
+
+  void ProcessGet(const std::vector<Blob>& data,
+                  std::vector<Blob>* result) override {
+    CHECK(data.size() == 1);
+    CHECK_NOTNULL(result);
+    Blob keys = data[0];
+    size_t num_keys = keys.size<Key>();
+    Rows(reinterpret_cast<const Key*>(keys.data()), num_keys);
+    result->push_back(keys);
+    result->push_back(Blob(num_keys * dim_ * sizeof(T)));
+    T* vals = reinterpret_cast<T*>((*result)[1].data());
+    for (size_t i = 0; i < num_keys; ++i) {
+      size_t chunk = found_[i] / kChunkKeys;
+      updaters_[chunk]->Access(dim_, chunks_[chunk].get(), vals + i * dim_,
+                               found_[i] % kChunkKeys * dim_);
+    }
+  }
+
+  void ProcessAdd(const std::vector<Blob>& data) override {
+    CHECK(data.size() == 2 || data.size() == 3);
+    size_t num_keys = data[0].size<Key>();
+    CHECK(num_keys * dim_ == data[1].size<T>());
+    AddOption* option = nullptr;
+    if (data.size() == 3) {
+      option = new AddOption(data[2].data(), data[2].size());
+    }
+    Rows(reinterpret_cast<const Key*>(data[0].data()), num_keys);
+    T* deltas = reinterpret_cast<T*>(data[1].data());
+    for (size_t i = 0; i < num_keys; ++i) {
+      size_t chunk = found_[i] / kChunkKeys;
+      updaters_[chunk]->Update(dim_, chunks_[chunk].get(), deltas + i * dim_,
+                               option, found_[i] % kChunkKeys * dim_);
+    }
+    delete option;
+  }
+
+  // Values only, as for the matrix tables the optimizer state is not stored.
+  // See table/kv_snapshot.h for the format.
+  void Store(Stream* s) override {
+    std::vector<std::pair<Key, size_t>> entries;
+    entries.reserve(index_.size());
+    for (auto& entry : index_) {
+      entries.push_back(std::make_pair(entry.first, entry.second - 1));
+    }
+    std::sort(entries.begin(), entries.end());
+    std::vector<Key> keys(entries.size());
+    for (size_t i = 0; i < keys.size(); ++i) keys[i] = entries[i].first;
+    kv_snapshot::WriteSorted(s, keys.data(), keys.size(), dim_ * sizeof(T),
+      false, true, [&](size_t i, char* out) {
+      size_t row = entries[i].second, chunk = row / kChunkKeys;
+      updaters_[chunk]->Access(dim_, chunks_[chunk].get(),
+        reinterpret_cast<T*>(out), row % kChunkKeys * dim_);
+    });
+  }
+
+  void Load(Stream* s) override {
+    kv_snapshot::Header header = kv_snapshot::ReadHeader(s);
+    if (!(header.flags & kv_snapshot::kIncremental)) {
+      index_.clear();
+      chunks_.clear();
+      updaters_.clear();
+      num_rows_ = 0;
+    }
+    kv_snapshot::ReadRuns<Key>(s, header, dim_ * sizeof(T),
+      [this](const Key* keys, const char* vals, size_t count) {
+      Rows(keys, count);
+      for (size_t i = 0; i < count; ++i) {
+        memcpy(Row(found_[i]), vals + i * dim_ * sizeof(T), dim_ * sizeof(T));
+      }
+    });
+  }
+
+  // number of keys of the server
+  size_t size() const { return num_rows_; }
+
+private:
+  static const size_t kChunkKeys = 4096;
+
+  T* Row(size_t row) {
+    return chunks_[row / kChunkKeys].get() + row % kChunkKeys * dim_;
+  }
+
+  // Fills found_ with the rows of keys, creating the missing ones
+  void Rows(const Key* keys, size_t num_keys) {
+    // the map stores row + 1, value initialized 0 for new keys
+    slots_.resize(num_keys);
+    index_.FindOrInsert(keys, num_keys, slots_.data());
+    found_.resize(num_keys);
+    for (size_t i = 0; i < num_keys; ++i) {
+      if (*slots_[i] == 0) *slots_[i] = NewRow() + 1;
+      found_[i] = *slots_[i] - 1;
+    }
+  }
+
+  size_t NewRow() {
+    size_t row = num_rows_++;
+    if (row / kChunkKeys == chunks_.size()) {
+      chunks_.emplace_back(new T[kChunkKeys * dim_]);
+      updaters_.emplace_back(Updater<T>::GetUpdater(kChunkKeys * dim_, dim_));
+    }
+    T* values = Row(row);
+    if (init_max_ > init_min_) {
+      std::uniform_real_distribution<double> dist(init_min_, init_max_);
+      for (size_t i = 0; i < dim_; ++i) values[i] = static_cast<T>(dist(gen_));
+    } else {
+      std::fill(values, values + dim_, static_cast<T>(init_min_));
+    }
+    return row;
+  }
+
+  size_t dim_;
+  double init_min_;
+  double init_max_;
+  size_t num_rows_;
+  std::mt19937 gen_;
+  FlatHashMap<Key, size_t> index_;
+  std::vector<std::unique_ptr<T[]>> chunks_;
+  std::vector<std::unique_ptr<Updater<T>>> updaters_;
+  // rows of the keys of a request, kept to reuse their memory
+  std::vector<size_t*> slots_;
+  std::vector<size_t> found_;
+};
+
+template <typename Key, typename T>
+struct KVEmbeddingTableOption {
+  explicit KVEmbeddingTableOption(size_t dim, double init_min = 0,
+                                  double init_max = 0)
+    : dim(dim), init_min(init_min), init_max(init_max) {}
+  size_t dim;
+  // new values are drawn uniformly from [init_min, init_max), or all
+  // init_min if init_max <= init_min
+  double init_min;
+  double init_max;
+  typedef KVEmbeddingWorkerTable<Key, T> WorkerTableType;
+  typedef KVEmbeddingServerTable<Key, T> ServerTableType;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_TABLE_KV_EMBEDDING_TABLE_H_
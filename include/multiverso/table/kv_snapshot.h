@@ -0,0 +1,177 @@
+#ifndef MULTIVERSO_TABLE_KV_SNAPSHOT_H_
+#define MULTIVERSO_TABLE_KV_SNAPSHOT_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "multiverso/io/io.h"
+#include "multiverso/util/key_codec.h"
+#include "multiverso/util/log.h"
+
+namespace multiverso {
+
+// Binary snapshots of the KV server tables. A snapshot is a Header followed
+// by runs of at most kRunSize entries sorted by key:
+//   uint32 count, uint32 key bytes, keys, count values
+// With kEncodedKeys the keys of a run are delta + varint encoded, see
+// util/key_codec.h, otherwise stored as is. An incremental snapshot holds the
+// keys changed since the previous snapshot and applies on top of it, keys are
+// never erased so a chain of snapshots needs no tombstones.
+namespace kv_snapshot {
+
+const uint32_t kMagic = 0x564b564d;  // "MVKV"
+const uint32_t kVersion = 1;
+const uint32_t kIncremental = 1;
+const uint32_t kEncodedKeys = 2;
+const size_t kRunSize = 1 << 16;
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t flags;
+  uint32_t key_size;
+  uint32_t val_size;
+  uint32_t reserved;
+  uint64_t count;
+};
+
+inline void ReadAll(Stream* stream, void* buf, size_t size) {
+  CHECK(stream->Read(buf, size) == size);
+}
+
+template <typename Key>
+size_t EncodeKeys(const Key* keys, size_t count, char* out, std::true_type) {
+  return key_codec::Encode(keys, count, true, out);
+}
+
+template <typename Key>
+size_t EncodeKeys(const Key*, size_t, char*, std::false_type) {
+  Log::Fatal("Only integer keys are encoded\n");
+  return 0;
+}
+
+template <typename Key>
+size_t DecodeKeys(const char* in, size_t count, Key* keys, std::true_type) {
+  return key_codec::Decode(in, count, true, keys);
+}
+
+template <typename Key>
+size_t DecodeKeys(const char*, size_t, Key*, std::false_type) {
+  Log::Fatal("Only integer keys are encoded\n");
+  return 0;
+}
+
+// Writes count entries with ascending keys, value(i, out) writes the
+// val_size bytes of the value of keys[i] to out
+template <typename Key, typename Func>
+void WriteSorted(Stream* stream, const Key* keys, size_t count,
+                 size_t val_size, bool incremental, bool encode_keys,
+                 Func value) {
+  typedef std::is_integral<Key> Encodable;
+  encode_keys = encode_keys && Encodable::value;
+  Header header;
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.flags = (incremental ? kIncremental : 0) |
+                 (encode_keys ? kEncodedKeys : 0);
+  header.key_size = sizeof(Key);
+  header.val_size = static_cast<uint32_t>(val_size);
+  header.reserved = 0;
+  header.count = count;
+  stream->Write(&header, sizeof(header));
+
+  std::vector<char> vals, encoded;
+  for (size_t begin = 0; begin < count; begin += kRunSize) {
+    size_t num = std::min(count - begin, kRunSize);
+    const char* key_bytes = reinterpret_cast<const char*>(keys + begin);
+    uint32_t run[2] = { static_cast<uint32_t>(num),
+                        static_cast<uint32_t>(num * sizeof(Key)) };
+    if (encode_keys) {
+      encoded.resize(key_codec::MaxEncodedSize<Key>(num));
+      run[1] = static_cast<uint32_t>(
+        EncodeKeys(keys + begin, num, encoded.data(), Encodable()));
+      key_bytes = encoded.data();
+    }
+    vals.resize(num * val_size);
+    for (size_t i = 0; i < num; ++i) {
+      value(begin + i, vals.data() + i * val_size);
+    }
+    stream->Write(run, sizeof(run));
+    stream->Write(key_bytes, run[1]);
+    stream->Write(vals.data(), vals.size());
+  }
+}
+
+// Writes entries, which are sorted in place
+template <typename Key, typename Val>
+void Write(Stream* stream, std::vector<std::pair<Key, Val>>* entries,
+           bool incremental, bool encode_keys) {
+  std::sort(entries->begin(), entries->end(),
+    [](const std::pair<Key, Val>& a, const std::pair<Key, Val>& b) {
+      return a.first < b.first;
+  });
+  std::vector<Key> keys(entries->size());
+  for (size_t i = 0; i < keys.size(); ++i) keys[i] = (*entries)[i].first;
+  WriteSorted(stream, keys.data(), keys.size(), sizeof(Val), incremental,
+    encode_keys, [entries](size_t i, char* out) {
+    memcpy(out, &(*entries)[i].second, sizeof(Val));
+  });
+}
+
+inline Header ReadHeader(Stream* stream) {
+  Header header;
+  ReadAll(stream, &header, sizeof(header));
+  CHECK(header.magic == kMagic);
+  CHECK(header.version == kVersion);
+  return header;
+}
+
+// Calls apply(keys, vals, count) for each run of the snapshot after header,
+// vals holds count values of val_size bytes
+template <typename Key, typename Func>
+void ReadRuns(Stream* stream, const Header& header, size_t val_size,
+              Func apply) {
+  typedef std::is_integral<Key> Encodable;
+  CHECK(header.key_size == sizeof(Key));
+  CHECK(header.val_size == val_size);
+  std::vector<Key> keys;
+  std::vector<char> vals, encoded;
+  for (uint64_t read = 0; read < header.count; ) {
+    uint32_t run[2];
+    ReadAll(stream, run, sizeof(run));
+    CHECK(run[0] > 0 && read + run[0] <= header.count);
+    keys.resize(run[0]);
+    vals.resize(run[0] * val_size);
+    if (header.flags & kEncodedKeys) {
+      encoded.resize(run[1]);
+      ReadAll(stream, encoded.data(), run[1]);
+      CHECK(DecodeKeys(encoded.data(), run[0], keys.data(), Encodable()) ==
+            run[1]);
+    } else {
+      CHECK(run[1] == run[0] * sizeof(Key));
+      ReadAll(stream, keys.data(), run[1]);
+    }
+    ReadAll(stream, vals.data(), vals.size());
+    apply(keys.data(), vals.data(), static_cast<size_t>(run[0]));
+    read += run[0];
+  }
+}
+
+// ReadRuns with values of type Val
+template <typename Key, typename Val, typename Func>
+void ReadRuns(Stream* stream, const Header& header, Func apply) {
+  ReadRuns<Key>(stream, header, sizeof(Val),
+    [&apply](const Key* keys, const char* vals, size_t count) {
+    apply(keys, reinterpret_cast<const Val*>(vals), count);
+  });
+}
+
+}  // namespace kv_snapshot
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_TABLE_KV_SNAPSHOT_H_
@@ -2,10 +2,13 @@
 #define MULTIVERSO_KV_TABLE_H_
 
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "multiverso/multiverso.h"
 #include "multiverso/table_interface.h"
+#include "multiverso/table/kv_snapshot.h"
+#include "multiverso/util/flat_hash_map.h"
 #include "multiverso/util/log.h"
 
 namespace multiverso {
@@ -13,7 +16,7 @@ namespace multiverso {
 template <typename Key, typename Val>
 struct KVTableOption;
 
-// A distributed shared std::unordered_map<Key, Val> table
+// A distributed shared hash map table, see util/flat_hash_map.h
 // Key, Val should be the basic type
 template <typename Key, typename Val>
 class KVWorkerTable : public WorkerTable {
@@ -37,30 +40,39 @@ public:
     WorkerTable::Add(keys_blob, vals_blob);
   }
 
-  std::unordered_map<Key, Val>& raw() { return table_; }
+  FlatHashMap<Key, Val>& raw() { return table_; }
    
   int Partition(const std::vector<Blob>& kv, 
     MsgType, std::unordered_map<int, std::vector<Blob> >* out) override {
     CHECK(kv.size() == 1 || kv.size() == 2);
     CHECK_NOTNULL(out);
-    std::unordered_map<int, int> counts;
-    Blob keys = kv[0];
-    for (int i = 0; i < keys.size<Key>(); ++i) { // iterate as type Key
-      int dst = static_cast<int>(keys.As<Key>(i) % MV_NumServers());
-      ++counts[dst];
+    int num_server = MV_NumServers();
+    size_t num_keys = kv[0].size<Key>();
+    const Key* keys = reinterpret_cast<const Key*>(kv[0].data());
+    dest_.resize(num_keys);
+    counts_.assign(num_server, 0);
+    for (size_t i = 0; i < num_keys; ++i) {
+      dest_[i] = static_cast<int>(static_cast<size_t>(keys[i]) % num_server);
+      ++counts_[dest_[i]];
     }
-    for (auto& it : counts) { // Allocate memory
-      std::vector<Blob>& vec = (*out)[it.first];
-      vec.push_back(Blob(it.second * sizeof(Key)));
-      if (kv.size() == 2) vec.push_back(Blob(it.second * sizeof(Val)));
+    std::vector<Key*> out_keys(num_server, nullptr);
+    std::vector<Val*> out_vals(num_server, nullptr);
+    for (int dst = 0; dst < num_server; ++dst) { // Allocate memory
+      if (counts_[dst] == 0) continue;
+      std::vector<Blob>& vec = (*out)[MV_ServerIdToRank(dst)];
+      vec.push_back(Blob(counts_[dst] * sizeof(Key)));
+      out_keys[dst] = reinterpret_cast<Key*>(vec.back().data());
+      if (kv.size() == 2) {
+        vec.push_back(Blob(counts_[dst] * sizeof(Val)));
+        out_vals[dst] = reinterpret_cast<Val*>(vec.back().data());
+      }
     }
-    counts.clear();
-    for (int i = 0; i < keys.size<Key>(); ++i) {
-      int dst = static_cast<int>(keys.As<Key>(i) % MV_NumServers());
-      (*out)[dst][0].As<Key>(counts[dst]) = keys.As<Key>(i);
-      if (kv.size() == 2) 
-        (*out)[dst][1].As<Val>(counts[dst]) = kv[1].As<Val>(i);
-      ++counts[dst];
+    const Val* vals = kv.size() == 2 ?
+      reinterpret_cast<const Val*>(kv[1].data()) : nullptr;
+    for (size_t i = 0; i < num_keys; ++i) {
+      int dst = dest_[i];
+      *out_keys[dst]++ = keys[i];
+      if (vals != nullptr) *out_vals[dst]++ = vals[i];
     }
     return static_cast<int>(out->size());
   }
@@ -68,57 +80,116 @@ public:
   void ProcessReplyGet(std::vector<Blob>& data) override {
     CHECK(data.size() == 2);
     Blob keys = data[0], vals = data[1];
-    CHECK(keys.size<Key>() == vals.size<Val>());
-    for (int i = 0; i < keys.size<Key>(); ++i) {
-      table_[keys.As<Key>(i)] = vals.As<Val>(i);
-    }
+    size_t num_keys = keys.size<Key>();
+    CHECK(num_keys == vals.size<Val>());
+    values_.resize(num_keys);
+    table_.FindOrInsert(reinterpret_cast<const Key*>(keys.data()), num_keys,
+                        values_.data());
+    for (size_t i = 0; i < num_keys; ++i) *values_[i] = vals.As<Val>(i);
   }
 
 private:
-  std::unordered_map<Key, Val> table_;
+  FlatHashMap<Key, Val> table_;
+  // scratch of Partition and ProcessReplyGet
+  std::vector<int> dest_;
+  std::vector<size_t> counts_;
+  std::vector<Val*> values_;
 };
 
 template <typename Key, typename Val>
 class KVServerTable : public ServerTable {
 public:
-  explicit KVServerTable(const KVTableOption<Key, Val>&) {}
+  explicit KVServerTable(const KVTableOption<Key, Val>& option)
+    : encode_keys_(option.compress_snapshots),
+      track_changes_(option.incremental_snapshots) {}
 
   void ProcessGet(const std::vector<Blob>& data, 
                   std::vector<Blob>* result) override {
     CHECK(data.size() == 1);
     CHECK_NOTNULL(result);
     Blob keys = data[0];
+    size_t num_keys = keys.size<Key>();
     result->push_back(keys); // also push the key
-    result->push_back(Blob(keys.size<Key>() * sizeof(Val)));
+    result->push_back(Blob(num_keys * sizeof(Val)));
     Blob& vals = (*result)[1];
-    for (int i = 0; i < keys.size<Key>(); ++i) {
-      vals.As<Val>(i) = table_[keys.As<Key>(i)];
+    // missing keys read as Val() and are not inserted
+    found_.resize(num_keys);
+    table_.Find(reinterpret_cast<const Key*>(keys.data()), num_keys,
+                found_.data());
+    for (size_t i = 0; i < num_keys; ++i) {
+      vals.As<Val>(i) = found_[i] != nullptr ? *found_[i] : Val();
     }
   }
 
   void ProcessAdd(const std::vector<Blob>& data) override {
     CHECK(data.size() == 2);
     Blob keys = data[0], vals = data[1];
-    CHECK(keys.size<Key>() == vals.size<Val>());
-    for (int i = 0; i < keys.size<Key>(); ++i) {
-      table_[keys.As<Key>(i)] += vals.As<Val>(i);
+    size_t num_keys = keys.size<Key>();
+    CHECK(num_keys == vals.size<Val>());
+    values_.resize(num_keys);
+    table_.FindOrInsert(reinterpret_cast<const Key*>(keys.data()), num_keys,
+                        values_.data());
+    for (size_t i = 0; i < num_keys; ++i) *values_[i] += vals.As<Val>(i);
+    if (track_changes_) {
+      const Key* added = reinterpret_cast<const Key*>(keys.data());
+      for (size_t i = 0; i < num_keys; ++i) changed_[added[i]] = true;
     }
   }
 
-  void Store(Stream*) override {
-    Log::Fatal("Not implemented yet\n");
+  // Full snapshot of the table, see table/kv_snapshot.h
+  void Store(Stream* s) override {
+    std::vector<std::pair<Key, Val>> entries(table_.begin(), table_.end());
+    kv_snapshot::Write(s, &entries, false, encode_keys_);
+    changed_.clear();
+  }
+
+  // Snapshot of the keys Added since the previous Store, StoreIncremental
+  // or Load, to Load after them. Needs KVTableOption::incremental_snapshots.
+  void StoreIncremental(Stream* s) {
+    CHECK(track_changes_);
+    std::vector<std::pair<Key, Val>> entries;
+    entries.reserve(changed_.size());
+    for (auto& changed : changed_) {
+      entries.push_back(std::make_pair(changed.first,
+                                       *table_.find(changed.first)));
+    }
+    kv_snapshot::Write(s, &entries, true, encode_keys_);
+    changed_.clear();
   }
 
-  void Load(Stream*) override {
-    Log::Fatal("Not implemented yet\n");
+  // Restores a full snapshot, or applies an incremental one to the table
+  void Load(Stream* s) override {
+    kv_snapshot::Header header = kv_snapshot::ReadHeader(s);
+    if (!(header.flags & kv_snapshot::kIncremental)) table_.clear();
+    table_.reserve(table_.size() + static_cast<size_t>(header.count));
+    kv_snapshot::ReadRuns<Key, Val>(s, header,
+      [this](const Key* keys, const Val* vals, size_t count) {
+      values_.resize(count);
+      table_.FindOrInsert(keys, count, values_.data());
+      for (size_t i = 0; i < count; ++i) *values_[i] = vals[i];
+    });
+    changed_.clear();
   }
 
 private:
-  std::unordered_map<Key, Val> table_;
+  FlatHashMap<Key, Val> table_;
+  // lookup results of a request, kept to reuse their memory
+  std::vector<const Val*> found_;
+  std::vector<Val*> values_;
+  bool encode_keys_;
+  bool track_changes_;
+  // keys Added since the last snapshot
+  FlatHashMap<Key, bool> changed_;
 };
 
 template <typename Key, typename Val>
 struct KVTableOption {
+  KVTableOption() : compress_snapshots(true), incremental_snapshots(false) {}
+  // delta + varint encode the keys of Store, for integer keys
+  bool compress_snapshots;
+  // track the keys Added since the last snapshot, see
+  // KVServerTable::StoreIncremental
+  bool incremental_snapshots;
   typedef KVWorkerTable<Key, Val> WorkerTableType;
   typedef KVServerTable<Key, Val> ServerTableType;
 };
@@ -0,0 +1,91 @@
+#ifndef MULTIVERSO_TABLE_MAPPED_STORAGE_H_
+#define MULTIVERSO_TABLE_MAPPED_STORAGE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "multiverso/io/mmap_stream.h"
+#include "multiverso/table/snapshot.h"
+#include "multiverso/util/log.h"
+
+namespace multiverso {
+
+// Values of a server table, owned in a vector or adopted in place from a
+// checkpoint mapped by a private MmapStream, e.g.
+// mmap:///data/model.bin?private=true&advice=random. An adopted table only
+// reads in the pages it serves and copies the pages it updates, which
+// never reach the checkpoint file. The values can be snapshotted while
+// being updated, see StartSnapshot.
+template <typename T>
+class MappedStorage {
+public:
+  MappedStorage() : data_(nullptr), size_(0) {}
+
+  void resize(size_t size) {
+    CHECK(map_ == nullptr);
+    owned_.resize(size);
+    data_ = owned_.data();
+    size_ = size;
+  }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+  size_t size() const { return size_; }
+  T& operator[](size_t i) { return data_[i]; }
+  const T& operator[](size_t i) const { return data_[i]; }
+
+  // true if the values are adopted from a mapping
+  bool mapped() const { return map_ != nullptr; }
+
+  // Starts writing the values as of now to s, which it takes, in the
+  // background, after the previous snapshot is written
+  std::shared_ptr<Snapshot> StartSnapshot(Stream* s) {
+    if (snapshot_ != nullptr) snapshot_->Wait();
+    snapshot_ = std::make_shared<Snapshot>(data_, size_ * sizeof(T), s);
+    return snapshot_;
+  }
+
+  // To be called before changing the values [offset, offset + size), keeps
+  // them for the running snapshot. Thread safe
+  void Touch(size_t offset, size_t size) {
+    if (snapshot_ != nullptr) {
+      snapshot_->Touch(offset * sizeof(T), size * sizeof(T));
+    }
+  }
+
+  // Adopts the next values of s if it is a private MmapStream and they are
+  // aligned, reads them in otherwise
+  void Load(Stream* s) {
+    if (snapshot_ != nullptr) snapshot_->Wait();
+    size_t bytes = size_ * sizeof(T);
+    MmapStream* mmap = dynamic_cast<MmapStream*>(s);
+    if (mmap != nullptr && mmap->map()->is_private() && bytes > 0 &&
+        reinterpret_cast<uintptr_t>(mmap->data() + mmap->position()) %
+        alignof(T) == 0) {
+      char* values = mmap->Next(bytes);
+      if (values != nullptr) {
+        data_ = reinterpret_cast<T*>(values);
+        map_ = mmap->map();
+        std::vector<T>().swap(owned_);
+        return;
+      }
+    }
+    s->Read(data_, bytes);
+  }
+
+private:
+  std::vector<T> owned_;
+  std::shared_ptr<MemoryMap> map_;
+  std::shared_ptr<Snapshot> snapshot_;
+  T* data_;
+  size_t size_;
+
+  // No copying allowed
+  MappedStorage(const MappedStorage&);
+  void operator=(const MappedStorage&);
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_TABLE_MAPPED_STORAGE_H_
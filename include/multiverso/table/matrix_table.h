@@ -4,7 +4,12 @@
 
 #include "multiverso/multiverso.h"
 #include "multiverso/table_interface.h"
+#include "multiverso/table/delta_buffer.h"
+#include "multiverso/table/mapped_storage.h"
+#include "multiverso/updater/lazy_state.h"
+#include "multiverso/util/quantization_util.h"
 
+#include <memory>
 #include <vector>
 #include <random>
 
@@ -81,6 +86,17 @@ public:
   void ProcessReplyGet(std::vector<Blob>& reply_data) override;
 
 protected:
+  // Sort the keys of one server message (and the rows along with them) and
+  // replace them with the delta + varint encoded keys
+  void EncodeKeys(std::vector<Blob>* blobs);
+  // Sort the keys of one server message along with its rows
+  void SortKeys(std::vector<Blob>* blobs);
+  // Add the residual of rows to the values of one server message, encode
+  // them with filter_ and keep what was lost as their residual
+  void Compress(const integer_t* rows, size_t num_rows, Blob* values);
+  // Use data as the buffer of the whole table delta Gets
+  void SetDeltaBuffer(T* data);
+
   T** row_index_;
   int get_reply_count_;                    // number of unprocessed get reply
   integer_t num_row_;
@@ -88,6 +104,16 @@ protected:
   integer_t row_size_;                           // equals to sizeof(T) * num_col_
   int num_server_;
   std::vector<integer_t> server_offsets_;        // row id offset
+  bool encode_keys_;
+  std::vector<integer_t> keys_buffer_;           // decoded keys of replies
+  // compression of Adds and the per row error it carries over, if enabled
+  std::unique_ptr<DeltaFilter<T>> filter_;
+  std::unique_ptr<LazyState<T>> residual_;
+  // server versions of the last whole table Get, when delta_gets
+  bool delta_gets_;
+  std::vector<int64_t> server_versions_;
+  // buffer of the last whole table Get, the one the changed rows merge into
+  T* delta_buffer_;
 };
 
 template <typename T>
@@ -107,15 +133,41 @@ public:
                   std::vector<Blob>* result) override;
 
   void Store(Stream* s) override;
+  // adopts the values of a private MmapStream, see MappedStorage
   void Load(Stream* s) override;
+  std::shared_ptr<Snapshot> StartSnapshot(Stream* s) override;
+
+  // row deltas merged for each update when aggregating Adds
+  double merge_ratio() const;
 
 protected:
+  // Apply delta to a row through the updater
+  void UpdateRow(integer_t row, T* delta, AddOption* option);
+  // Apply the deltas summed by the aggregation buffer
+  void FlushRow(integer_t row);
+  void FlushAll();
+  // Reply the rows changed since option's version to a whole table Get
+  void ProcessDeltaGet(const GetOption& option, std::vector<Blob>* result);
+
   int server_id_;
   integer_t my_num_row_;
   integer_t num_col_;
   integer_t row_offset_;
   Updater<T>* updater_;
-  std::vector<T> storage_;
+  MappedStorage<T> storage_;
+  std::vector<integer_t> keys_buffer_;           // decoded keys of requests
+  // indices of the keys of an Add applied by each OpenMP thread
+  std::vector<std::vector<size_t>> thread_keys_;
+  // sums row deltas of Adds when aggregate_adds is set
+  std::unique_ptr<DeltaBuffer<T>> delta_buffer_;
+  int buffered_adds_;
+  // Adds are encoded by a DeltaFilter, decoded into decoded_
+  bool compressed_adds_;
+  std::vector<T> decoded_;
+  // number of Adds applied, and the one which last changed each row, when
+  // the table serves delta Gets
+  int64_t version_;
+  std::vector<int64_t> row_versions_;
 };
 
 template <typename T>
@@ -123,11 +175,27 @@ struct MatrixTableOption {
   MatrixTableOption(integer_t num_row, integer_t num_col, 
     float min_value=0, float max_value=0) : 
       num_row(num_row), num_col(num_col), 
-      min_value(min_value), max_value(max_value) {}
+      min_value(min_value), max_value(max_value), encode_keys(false),
+      add_topk(0), add_topk_per_row(true), add_bits(0), delta_gets(false) {}
   integer_t num_row;
   integer_t num_col;
   float min_value;
   float max_value;
+  // send row ids sorted and delta + varint encoded, see util/key_codec.h
+  bool encode_keys;
+  // Lossy compression of Adds, see util/quantization_util.h. What a worker
+  // does not send is added back to its next Add of the same rows.
+  // fraction of the values sent, largest magnitudes first, 0 disables
+  double add_topk;
+  // pick the top values of each row, otherwise of each server message
+  bool add_topk_per_row;
+  // 1 or 2 bits quantization of the values, 0 disables
+  int add_bits;
+  // Whole table Gets only receive the rows changed since the previous whole
+  // table Get of the worker, which are merged into the given buffer. The
+  // buffer must hold the result of that previous Get, a Get into another
+  // buffer receives all the rows again.
+  bool delta_gets;
   DEFINE_TABLE_TYPE(T, MatrixWorkerTable, MatrixServerTable);
 };
 
@@ -0,0 +1,70 @@
+#ifndef MULTIVERSO_TABLE_SNAPSHOT_H_
+#define MULTIVERSO_TABLE_SNAPSHOT_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace multiverso {
+
+class Stream;
+
+// Writes the bytes of a region as of its construction to a Stream on a
+// thread, while the owner keeps changing the region: the owner calls Touch
+// before changing bytes, which copies the blocks not written yet, so that
+// only the blocks changed during the write are copied, once.
+class Snapshot {
+public:
+  static const size_t kBlockSize = 256 << 10;
+
+  // Takes the ownership of stream, which is deleted once written
+  Snapshot(const void* data, size_t size, Stream* stream,
+           size_t block_size = kBlockSize);
+  // Waits for the write
+  ~Snapshot();
+
+  // Keeps [offset, offset + size) of the region as of the snapshot, to be
+  // called before changing them. Thread safe
+  void Touch(size_t offset, size_t size) {
+    if (!done_.load(std::memory_order_acquire)) CopyBlocks(offset, size);
+  }
+
+  void Wait();
+  bool done() const { return done_.load(std::memory_order_acquire); }
+
+  // bytes written to the stream
+  size_t bytes() const { return size_; }
+  // bytes copied by Touch
+  size_t copied() const;
+  // time to write the stream, valid once done
+  double write_ms() const { return write_ms_; }
+
+private:
+  enum State : char { kPending, kCopied, kWritten };
+
+  void CopyBlocks(size_t offset, size_t size);
+  void Run();
+
+  const char* data_;
+  size_t size_;
+  Stream* stream_;
+  size_t block_size_;
+  std::vector<State> states_;
+  // the blocks copied before they are written
+  std::vector<std::vector<char>> copies_;
+  size_t copied_;
+  double write_ms_;
+  mutable std::mutex m_;
+  std::atomic<bool> done_;
+  std::thread thread_;
+
+  // No copying allowed
+  Snapshot(const Snapshot&);
+  void operator=(const Snapshot&);
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_TABLE_SNAPSHOT_H_
@@ -3,19 +3,20 @@
 #define INCLUDE_MULTIVERSO_TABLE_SPARSE_MATRIX_TABLE_H_
 
 #include <vector>
-#include <bitset>
+#include <memory>
 #include "multiverso/multiverso.h"
 #include "multiverso/table_interface.h"
 #include "multiverso/util/log.h"
 #include "multiverso/table/matrix_table.h"
+#include "multiverso/table/stale_rows.h"
+#include "multiverso/util/quantization_util.h"
 
 namespace multiverso {
 
 template <typename T>
 class SparseMatrixWorkerTable : public MatrixWorkerTable<T> {
  public:
-   SparseMatrixWorkerTable(integer_t num_row, integer_t num_col)
-     : MatrixWorkerTable<T>(num_row, num_col) { }
+   SparseMatrixWorkerTable(integer_t num_row, integer_t num_col);
     int Partition(const std::vector<Blob>& kv,
       MsgType partition_type,
       std::unordered_map<int, std::vector<Blob>>* out) override;
@@ -42,6 +43,9 @@ class SparseMatrixWorkerTable : public MatrixWorkerTable<T> {
 
     void Get(const std::vector<integer_t>& row_ids,
         const std::vector<T*>& data_vec, size_t size) = delete;
+
+    // compresses the messages, reused to keep its buffers
+    SparseFilter<T, int32_t> sparse_filter_;
 };
 
 template <typename T>
@@ -50,7 +54,6 @@ template <typename T>
 class SparseMatrixServerTable : public MatrixServerTable<T> {
  public:
      SparseMatrixServerTable(integer_t num_row, integer_t num_col, bool using_pipeline);
-     ~SparseMatrixServerTable();
     void ProcessAdd(const std::vector<Blob>& data) override;
     void ProcessGet(const std::vector<Blob>& data,
         std::vector<Blob>* result) override;
@@ -65,9 +68,10 @@ class SparseMatrixServerTable : public MatrixServerTable<T> {
        return global_row_id - this->row_offset_;
      }
  private:
-   bool** up_to_date_;
+   // rows each worker (or pipeline slot) has to fetch again
+   std::unique_ptr<StaleRows> stale_rows_;
    int workers_nums_;
-   // std::vector<std::vector<bool>> up_to_date_;
+   SparseFilter<T, int32_t> sparse_filter_;
 };
 
 }   // namespace multiverso
@@ -0,0 +1,75 @@
+#ifndef MULTIVERSO_TABLE_STALE_ROWS_H_
+#define MULTIVERSO_TABLE_STALE_ROWS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "multiverso/util/log.h"
+
+namespace multiverso {
+
+// Tracks which rows of a server table each worker has to fetch again, i.e.
+// were Added by another worker since it last read them. The bits of a row
+// for all the workers are packed next to each other, so that an Add marks
+// a row for every worker with a few word writes, and the table takes 1 bit
+// per row per worker. Every row starts stale.
+class StaleRows {
+public:
+  StaleRows(size_t num_row, int num_worker)
+    : num_row_(num_row), num_worker_(num_worker),
+      bits_((num_row * num_worker + 63) / 64, ~uint64_t(0)) {
+    CHECK(num_worker > 0);
+  }
+
+  // row was Added by worker, stale for all the other workers
+  void Added(size_t row, int worker) {
+    size_t first = row * num_worker_;
+    bool own = Test(first + worker);
+    SetRange(first, first + num_worker_);
+    if (!own) Clear(first + worker);
+  }
+
+  // every row was Added by worker
+  void AddedAll(int worker) {
+    for (size_t row = 0; row < num_row_; ++row) Added(row, worker);
+  }
+
+  // Whether worker has to fetch row, which is up to date for it afterwards
+  bool Fetch(size_t row, int worker) {
+    size_t bit = row * num_worker_ + worker;
+    if (!Test(bit)) return false;
+    Clear(bit);
+    return true;
+  }
+
+  size_t bytes() const { return bits_.size() * sizeof(uint64_t); }
+
+private:
+  bool Test(size_t bit) const {
+    return (bits_[bit / 64] >> (bit % 64)) & 1;
+  }
+
+  void Clear(size_t bit) { bits_[bit / 64] &= ~(uint64_t(1) << (bit % 64)); }
+
+  // sets bits [begin, end)
+  void SetRange(size_t begin, size_t end) {
+    size_t first = begin / 64, last = (end - 1) / 64;
+    uint64_t head = ~uint64_t(0) << (begin % 64);
+    uint64_t tail = ~uint64_t(0) >> (63 - (end - 1) % 64);
+    if (first == last) {
+      bits_[first] |= head & tail;
+      return;
+    }
+    bits_[first] |= head;
+    for (size_t i = first + 1; i < last; ++i) bits_[i] = ~uint64_t(0);
+    bits_[last] |= tail;
+  }
+
+  size_t num_row_;
+  size_t num_worker_;
+  std::vector<uint64_t> bits_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_TABLE_STALE_ROWS_H_
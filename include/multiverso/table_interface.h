@@ -1,8 +1,11 @@
 #ifndef MULTIVERSO_TABLE_INTERFACE_H_
 #define MULTIVERSO_TABLE_INTERFACE_H_
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <cctype>
 
@@ -51,10 +54,13 @@ private:
   int table_id_;
   std::mutex* m_;
   std::vector<Waiter*> waitings_;
+  // (trace id, start) of the sampled requests in flight, see util/tracer.h
+  std::unordered_map<int, std::pair<int, int64_t>> traces_;
   // assuming there are at most 2^32 msgs waiting in line
   int msg_id_;
 };
 
+class Snapshot;
 class Stream;
 
 // interface for checkpoint table
@@ -72,6 +78,15 @@ public:
   virtual void ProcessAdd(const std::vector<Blob>& data) = 0;
   virtual void ProcessGet(const std::vector<Blob>& data,
                           std::vector<Blob>* result) = 0;
+  // Starts storing the table as of now to s, which it takes. The returned
+  // snapshot writes in the background while the table keeps serving, the
+  // default Stores inline and returns nullptr
+  virtual std::shared_ptr<Snapshot> StartSnapshot(Stream* s);
+
+  int table_id() const { return table_id_; }
+
+private:
+  int table_id_;
 };
 
 #define DEFINE_TABLE_TYPE(template_type,                    \
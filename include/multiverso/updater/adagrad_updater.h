@@ -2,60 +2,40 @@
 #define MULTIVERSO_UPDATER_ADAGRAD_UPDATER_H_
 
 #include "multiverso/updater/updater.h"
+#include "multiverso/updater/kernels.h"
+#include "multiverso/updater/lazy_state.h"
 #include "multiverso/util/log.h"
 
-#include <vector>
-#include <cmath>
-#include <cstdint>
-
 
 namespace multiverso {
 
+// The historic squared gradients are shared by all the workers, delta is
+// the gradient scaled by the worker learning rate and rho is the step size
 template <typename T>
 class AdaGradUpdater : public Updater<T> {
 public:
-  explicit AdaGradUpdater(size_t size):
-    e(1e-6f), size_(size) {  
-    historic_g_sqr_.resize(MV_NumWorkers(), std::vector<T>(size_));
-    Log::Debug("[AdaGradUpdater] Init with size = %d, e = %f. historic_size = %d\n", size_, e, historic_g_sqr_.size());
+  AdaGradUpdater(size_t size, size_t row_size):
+    e(1e-6f), size_(size), historic_g_sqr_(size, row_size, 1) {  
+    Log::Debug("[AdaGradUpdater] Init with size = %zu, e = %f.\n", size_, e);
   }
 
   void Update(size_t num_element, T* data, T* delta, 
               AddOption* option, size_t offset) override {
-
-    auto g_sqr_data_ = historic_g_sqr_.at(option->worker_id());
-    for (size_t index = 0; index < num_element; ++index) {
-      g_sqr_data_[index + offset] -=
-        delta[index] * delta[index] / option->learning_rate() / 
-        option->learning_rate();
-
-      //[TODO(qiwye)] sqrt take too much time
-      data[index + offset] -= option->rho() /
-        std::sqrt(g_sqr_data_[index + offset] + e) *
-        delta[index] / option->learning_rate();
-
-      //data[index + offset] -= option->rho() *
-      //  QuakeRsqrt(g_sqr_data_[index + offset] + e) *
-      //  delta[index] / option->learning_rate();
-    }
+    T inv_lr = static_cast<T>(1 / option->learning_rate());
+    T rho = static_cast<T>(option->rho());
+    historic_g_sqr_.ForEach(offset, num_element,
+      [&](size_t, T* g_sqr, size_t begin, size_t count, size_t done) {
+      updater_kernel::AdaGrad(count, data + offset + done, g_sqr + begin,
+                              delta + done, inv_lr, rho, static_cast<T>(e));
+    });
   }
 
-
-private:
-
-  float QuakeRsqrt(float number){
-    float x = number * 0.5f, y = number;
-    std::uint32_t i;
-    std::memcpy(&i, &y, sizeof(float));
-    i = 0x5f3759df - (i >> 1);
-    std::memcpy(&y, &i, sizeof(float));
-    return y * (1.5f - (x * y * y));
-  }
+  size_t state_bytes() const override { return historic_g_sqr_.bytes(); }
 
 protected:
-    std::vector< std::vector<T>> historic_g_sqr_;
     float e;
     size_t size_;
+    LazyState<T> historic_g_sqr_;
 };
 
 }
@@ -0,0 +1,62 @@
+#ifndef MULTIVERSO_UPDATER_ADAM_UPDATER_H_
+#define MULTIVERSO_UPDATER_ADAM_UPDATER_H_
+
+#include <cmath>
+#include <vector>
+
+#include "multiverso/updater/updater.h"
+#include "multiverso/updater/kernels.h"
+#include "multiverso/updater/lazy_state.h"
+#include "multiverso/util/log.h"
+
+namespace multiverso {
+
+// Adam with the moments shared by all the workers. delta is the gradient
+// scaled by the worker learning rate and rho is the step size. Each page of
+// state counts its own steps for the bias correction, rows updated rarely
+// are corrected as in lazy Adam.
+template <typename T>
+class AdamUpdater : public Updater<T> {
+public:
+  AdamUpdater(size_t size, size_t row_size, 
+              double beta1, double beta2, double epsilon) :
+    beta1_(static_cast<T>(beta1)), beta2_(static_cast<T>(beta2)),
+    epsilon_(static_cast<T>(epsilon)), moments_(size, row_size, 2) {
+    steps_.resize(moments_.num_pages(), 0);
+    Log::Debug("[AdamUpdater] Init with size = %zu, beta1 = %f, beta2 = %f, "
+      "epsilon = %f.\n", size, beta1, beta2, epsilon);
+  }
+
+  void Update(size_t num_element, T* data, T* delta, 
+              AddOption* option, size_t offset) override {
+    T inv_lr = static_cast<T>(1 / option->learning_rate());
+    double rho = option->rho();
+    size_t page_size = moments_.page_size();
+    moments_.ForEach(offset, num_element,
+      [&](size_t index, T* state, size_t begin, size_t count, size_t done) {
+      int t = ++steps_[index];
+      T step = static_cast<T>(rho * std::sqrt(1 - std::pow(beta2_, t)) /
+        (1 - std::pow(beta1_, t)));
+      updater_kernel::Adam(count, data + offset + done, state + begin,
+                           state + page_size + begin, delta + done, inv_lr,
+                           step, beta1_, beta2_, epsilon_);
+    });
+  }
+
+  size_t state_bytes() const override { 
+    return moments_.bytes() + steps_.size() * sizeof(int);
+  }
+
+protected:
+  T beta1_;
+  T beta2_;
+  T epsilon_;
+  // first and second moments
+  LazyState<T> moments_;
+  // steps taken by each page
+  std::vector<int> steps_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_UPDATER_ADAM_UPDATER_H_
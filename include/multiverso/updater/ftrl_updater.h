@@ -0,0 +1,49 @@
+#ifndef MULTIVERSO_UPDATER_FTRL_UPDATER_H_
+#define MULTIVERSO_UPDATER_FTRL_UPDATER_H_
+
+#include "multiverso/updater/updater.h"
+#include "multiverso/updater/kernels.h"
+#include "multiverso/updater/lazy_state.h"
+#include "multiverso/util/log.h"
+
+namespace multiverso {
+
+// FTRL-Proximal with the z and n sums shared by all the workers. delta is
+// the gradient scaled by the worker learning rate, rho is alpha and lambda
+// the L1 regularization of the per coordinate learning rate.
+template <typename T>
+class FTRLUpdater : public Updater<T> {
+public:
+  FTRLUpdater(size_t size, size_t row_size, double beta, double l2) :
+    beta_(static_cast<T>(beta)), l2_(static_cast<T>(l2)),
+    sums_(size, row_size, 2) {
+    Log::Debug("[FTRLUpdater] Init with size = %zu, beta = %f, l2 = %f.\n",
+      size, beta, l2);
+  }
+
+  void Update(size_t num_element, T* data, T* delta, 
+              AddOption* option, size_t offset) override {
+    T inv_lr = static_cast<T>(1 / option->learning_rate());
+    T alpha = static_cast<T>(option->rho());
+    T l1 = static_cast<T>(option->lambda());
+    size_t page_size = sums_.page_size();
+    sums_.ForEach(offset, num_element,
+      [&](size_t, T* state, size_t begin, size_t count, size_t done) {
+      updater_kernel::Ftrl(count, data + offset + done, state + begin,
+                           state + page_size + begin, delta + done, inv_lr,
+                           alpha, beta_, l1, l2_);
+    });
+  }
+
+  size_t state_bytes() const override { return sums_.bytes(); }
+
+protected:
+  T beta_;
+  T l2_;
+  // z and n of each coordinate
+  LazyState<T> sums_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_UPDATER_FTRL_UPDATER_H_
@@ -0,0 +1,165 @@
+#ifndef MULTIVERSO_UPDATER_KERNELS_H_
+#define MULTIVERSO_UPDATER_KERNELS_H_
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MULTIVERSO_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace multiverso {
+
+// Fused update loops of the updaters. Each kernel makes one pass over the
+// parameters w, their optimizer state and the delta, which is the gradient
+// scaled by the worker learning rate as in SGDUpdater.
+namespace updater_kernel {
+
+// 1 / sqrt(x), float takes the hardware estimate refined by a Newton step
+inline float Rsqrt(float x) {
+#ifdef MULTIVERSO_USE_SSE
+  __m128 v = _mm_set_ss(x);
+  __m128 r = _mm_rsqrt_ss(v);
+  r = _mm_mul_ss(r, _mm_sub_ss(_mm_set_ss(1.5f),
+    _mm_mul_ss(_mm_mul_ss(_mm_set_ss(0.5f), v), _mm_mul_ss(r, r))));
+  return _mm_cvtss_f32(r);
+#else
+  return 1.0f / std::sqrt(x);
+#endif
+}
+
+inline double Rsqrt(double x) { return 1.0 / std::sqrt(x); }
+
+#ifdef MULTIVERSO_USE_SSE
+inline __m128 Rsqrt(__m128 v) {
+  __m128 r = _mm_rsqrt_ps(v);
+  return _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f),
+    _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), v), _mm_mul_ps(r, r))));
+}
+#endif
+
+// w -= delta
+template <typename T>
+inline void Sgd(size_t n, T* w, const T* delta) {
+  for (size_t i = 0; i < n; ++i) w[i] -= delta[i];
+}
+
+// s = momentum * s + (1 - momentum) * delta, w -= s
+template <typename T>
+inline void Momentum(size_t n, T* w, T* s, const T* delta, T momentum) {
+  T rest = 1 - momentum;
+  for (size_t i = 0; i < n; ++i) {
+    s[i] = momentum * s[i] + rest * delta[i];
+    w[i] -= s[i];
+  }
+}
+
+// g = delta / lr, g2 += g * g, w -= rho * g / sqrt(g2 + eps)
+template <typename T>
+inline void AdaGrad(size_t n, T* w, T* g2, const T* delta,
+                    T inv_lr, T rho, T eps) {
+  for (size_t i = 0; i < n; ++i) {
+    T g = delta[i] * inv_lr;
+    g2[i] += g * g;
+    w[i] -= rho * g * Rsqrt(g2[i] + eps);
+  }
+}
+
+#ifdef MULTIVERSO_USE_SSE
+template <>
+inline void AdaGrad<float>(size_t n, float* w, float* g2, const float* delta,
+                           float inv_lr, float rho, float eps) {
+  size_t i = 0;
+  __m128 vinv_lr = _mm_set1_ps(inv_lr);
+  __m128 vrho = _mm_set1_ps(rho);
+  __m128 veps = _mm_set1_ps(eps);
+  for (; i + 4 <= n; i += 4) {
+    __m128 g = _mm_mul_ps(_mm_loadu_ps(delta + i), vinv_lr);
+    __m128 s = _mm_add_ps(_mm_loadu_ps(g2 + i), _mm_mul_ps(g, g));
+    _mm_storeu_ps(g2 + i, s);
+    __m128 step = _mm_mul_ps(_mm_mul_ps(vrho, g), Rsqrt(_mm_add_ps(s, veps)));
+    _mm_storeu_ps(w + i, _mm_sub_ps(_mm_loadu_ps(w + i), step));
+  }
+  for (; i < n; ++i) {
+    float g = delta[i] * inv_lr;
+    g2[i] += g * g;
+    w[i] -= rho * g * Rsqrt(g2[i] + eps);
+  }
+}
+#endif
+
+// g = delta / lr, m = beta1 * m + (1 - beta1) * g,
+// v = beta2 * v + (1 - beta2) * g * g, w -= step * m / sqrt(v + eps),
+// where step carries the bias correction
+template <typename T>
+inline void Adam(size_t n, T* w, T* m, T* v, const T* delta, T inv_lr,
+                 T step, T beta1, T beta2, T eps) {
+  for (size_t i = 0; i < n; ++i) {
+    T g = delta[i] * inv_lr;
+    m[i] = beta1 * m[i] + (1 - beta1) * g;
+    v[i] = beta2 * v[i] + (1 - beta2) * g * g;
+    w[i] -= step * m[i] * Rsqrt(v[i] + eps);
+  }
+}
+
+#ifdef MULTIVERSO_USE_SSE
+template <>
+inline void Adam<float>(size_t n, float* w, float* m, float* v,
+                        const float* delta, float inv_lr, float step,
+                        float beta1, float beta2, float eps) {
+  size_t i = 0;
+  __m128 vinv_lr = _mm_set1_ps(inv_lr);
+  __m128 vstep = _mm_set1_ps(step);
+  __m128 vb1 = _mm_set1_ps(beta1), vb1r = _mm_set1_ps(1 - beta1);
+  __m128 vb2 = _mm_set1_ps(beta2), vb2r = _mm_set1_ps(1 - beta2);
+  __m128 veps = _mm_set1_ps(eps);
+  for (; i + 4 <= n; i += 4) {
+    __m128 g = _mm_mul_ps(_mm_loadu_ps(delta + i), vinv_lr);
+    __m128 vm = _mm_add_ps(_mm_mul_ps(vb1, _mm_loadu_ps(m + i)),
+                           _mm_mul_ps(vb1r, g));
+    __m128 vv = _mm_add_ps(_mm_mul_ps(vb2, _mm_loadu_ps(v + i)),
+                           _mm_mul_ps(vb2r, _mm_mul_ps(g, g)));
+    _mm_storeu_ps(m + i, vm);
+    _mm_storeu_ps(v + i, vv);
+    __m128 upd = _mm_mul_ps(_mm_mul_ps(vstep, vm), Rsqrt(_mm_add_ps(vv, veps)));
+    _mm_storeu_ps(w + i, _mm_sub_ps(_mm_loadu_ps(w + i), upd));
+  }
+  for (; i < n; ++i) {
+    float g = delta[i] * inv_lr;
+    m[i] = beta1 * m[i] + (1 - beta1) * g;
+    v[i] = beta2 * v[i] + (1 - beta2) * g * g;
+    w[i] -= step * m[i] * Rsqrt(v[i] + eps);
+  }
+}
+#endif
+
+// FTRL-Proximal, z and s are the per coordinate sums of the algorithm:
+// g = delta / lr, sigma = (sqrt(s + g * g) - sqrt(s)) / alpha,
+// z += g - sigma * w, s += g * g, and w is solved in closed form
+template <typename T>
+inline void Ftrl(size_t n, T* w, T* z, T* s, const T* delta, T inv_lr,
+                 T alpha, T beta, T l1, T l2) {
+  T inv_alpha = 1 / alpha;
+  for (size_t i = 0; i < n; ++i) {
+    T g = delta[i] * inv_lr;
+    T sqrt_s = std::sqrt(s[i]);
+    s[i] += g * g;
+    T sqrt_new = std::sqrt(s[i]);
+    z[i] += g - (sqrt_new - sqrt_s) * inv_alpha * w[i];
+    T abs_z = z[i] < 0 ? -z[i] : z[i];
+    if (abs_z <= l1) {
+      w[i] = 0;
+    } else {
+      T sign = z[i] < 0 ? T(-1) : T(1);
+      w[i] = -(z[i] - sign * l1) / ((beta + sqrt_new) * inv_alpha + l2);
+    }
+  }
+}
+
+}  // namespace updater_kernel
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_UPDATER_KERNELS_H_
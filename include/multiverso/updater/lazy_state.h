@@ -0,0 +1,71 @@
+#ifndef MULTIVERSO_UPDATER_LAZY_STATE_H_
+#define MULTIVERSO_UPDATER_LAZY_STATE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace multiverso {
+
+// Optimizer state of a table, shared by all the workers. The state is
+// allocated by pages on first touch, so sparse Adds to a large table only
+// pay for the rows they update. A page keeps slots values for each of its
+// page_size parameters, slot after slot.
+template <typename T>
+class LazyState {
+public:
+  // page_size is usually the row size of the table, 0 picks a default
+  LazyState(size_t size, size_t page_size, int slots)
+    : page_size_(page_size != 0 ? page_size : size_t(kDefaultPageSize)),
+      slots_(slots), num_allocated_(0) {
+    pages_.resize((size + page_size_ - 1) / page_size_);
+  }
+
+  // Zero initialized state of page index
+  T* page(size_t index) {
+    std::unique_ptr<T[]>& page = pages_[index];
+    if (page == nullptr) {
+      page.reset(new T[page_size_ * slots_]);
+      memset(page.get(), 0, page_size_ * slots_ * sizeof(T));
+      ++num_allocated_;
+    }
+    return page.get();
+  }
+
+  // Calls func(page index, state, begin, count, done) for each page piece
+  // of the parameters [offset, offset + num). state is the page, begin the
+  // position of the piece in it and done the parameters visited before
+  template <typename Func>
+  void ForEach(size_t offset, size_t num, Func func) {
+    size_t done = 0;
+    while (done < num) {
+      size_t index = (offset + done) / page_size_;
+      size_t begin = (offset + done) % page_size_;
+      size_t count = std::min(num - done, page_size_ - begin);
+      func(index, page(index), begin, count, done);
+      done += count;
+    }
+  }
+
+  size_t page_size() const { return page_size_; }
+  size_t num_pages() const { return pages_.size(); }
+  // allocated bytes
+  size_t bytes() const {
+    return num_allocated_ * page_size_ * slots_ * sizeof(T) +
+      pages_.size() * sizeof(std::unique_ptr<T[]>);
+  }
+
+private:
+  static const size_t kDefaultPageSize = 4096;
+
+  size_t page_size_;
+  int slots_;
+  std::atomic<size_t> num_allocated_;
+  std::vector<std::unique_ptr<T[]>> pages_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_UPDATER_LAZY_STATE_H_
@@ -2,31 +2,33 @@
 #define MULTIVERSO_UPDATER_MOMENTUM_UPDATER_H_
 
 #include "updater.h"
-#include <vector>
+#include "kernels.h"
+#include "lazy_state.h"
 
 namespace multiverso {
 
 template <typename T>
 class MomentumUpdater : public Updater<T> {
 public:
-  explicit MomentumUpdater(size_t size) : size_(size) {
+  MomentumUpdater(size_t size, size_t row_size) 
+    : smooth_gradient_(size, row_size, 1), size_(size) {
     Log::Debug("[SmoothGradientUpdater] Init with size = %d. \n", size_);
-    smooth_gradient_.resize(size_);
   }
 
   void Update(size_t num_element, T* data, T* delta, 
               AddOption* option, size_t offset) override {
-    for (size_t index = 0; index < num_element; ++index) {
-      smooth_gradient_[index + offset] = 
-        option->momentum() * smooth_gradient_[index + offset] 
-        + (1 - option->momentum()) * delta[index];
-      data[index + offset] -= smooth_gradient_[index + offset];
-    }
+    T momentum = option->momentum();
+    smooth_gradient_.ForEach(offset, num_element, 
+      [&](size_t, T* state, size_t begin, size_t count, size_t done) {
+      updater_kernel::Momentum(count, data + offset + done, state + begin,
+                               delta + done, momentum);
+    });
   }
 
-  ~MomentumUpdater() { smooth_gradient_.clear(); }
+  size_t state_bytes() const override { return smooth_gradient_.bytes(); }
+
 protected:
-  std::vector<T> smooth_gradient_;
+  LazyState<T> smooth_gradient_;
   size_t size_;
 };
 
@@ -2,6 +2,7 @@
 #define MULTIVERSO_UPDATER_SGD_UPDATER_H_
 
 #include "updater.h"
+#include "kernels.h"
 
 namespace multiverso {
 
@@ -13,9 +14,7 @@ public:
   }
   void Update(size_t num_element, T* data, T* delta,
               AddOption*, size_t offset) override {
-    for (size_t index = 0; index < num_element; ++index) {
-      data[index + offset] -= delta[index];
-    }
+    updater_kernel::Sgd(num_element, data + offset, delta);
   }
 
   void Access(size_t num_element, T* data, T* blob_data,
@@ -23,6 +22,8 @@ public:
     memcpy(blob_data, data + offset, sizeof(T) * num_element);
   }
 
+  bool linear() const override { return true; }
+
   ~SGDUpdater(){}
 };
 
@@ -1,6 +1,8 @@
 #ifndef MULTIVERSO_UPDATER_UPDATER_H_
 #define MULTIVERSO_UPDATER_UPDATER_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <sstream>
 #include <multiverso/multiverso.h>
@@ -74,15 +76,29 @@ public:
   // TODO(qiwye): to make these Option configurable 
   GetOption(){
     data_[0].i = MV_WorkerId();
+    set_version(0);
   }
 
   GetOption(const char* data, size_t size) {
+    set_version(0);  // options of older peers are shorter
     CopyFrom(data, size);
   }
 
   int worker_id() const { return data_[0].i; }
   void set_worker_id(int worker_id) { data_[0].i = worker_id; }
 
+  // table version the worker has seen, see MatrixTableOption::delta_gets
+  int64_t version() const {
+    return static_cast<int64_t>(
+      (static_cast<uint64_t>(static_cast<uint32_t>(data_[2].i)) << 32) |
+      static_cast<uint32_t>(data_[1].i));
+  }
+  void set_version(int64_t version) {
+    data_[1].i = static_cast<int>(static_cast<uint32_t>(version));
+    data_[2].i = static_cast<int>(static_cast<uint32_t>(
+      static_cast<uint64_t>(version) >> 32));
+  }
+
   std::string toString(){
     std::stringstream  ss;
     ss << "AddOption " << worker_id() << std::endl;
@@ -93,10 +109,10 @@ public:
   const char* data() const { return reinterpret_cast<const char*>(&data_[0]); }
   size_t size() const { return kSize * sizeof(InternalType); }
   void CopyFrom(const char* data, size_t size) {
-    memcpy(data_, data, size);
+    memcpy(data_, data, std::min(size, kSize * sizeof(InternalType)));
   }
 private:
-  static const size_t kSize = 1;
+  static const size_t kSize = 3;
   // Option can be either int type or float, 
   // to make it easy to serialize and deserialize
   union InternalType{
@@ -105,6 +121,8 @@ private:
   };
 
   // 0: src worker id
+  // 1: low 32 bits of version
+  // 2: high 32 bits of version
   // ...
   InternalType data_[kSize];
 };
@@ -127,8 +145,23 @@ public:
   //   Get data[offset : offset + num_element) to blob_data[0 : num_element)
   virtual void Access(size_t num_element, T* data, T* blob_data,
                       size_t offset = 0, AddOption* option = nullptr);
+  // Bytes of the optimizer state kept by the updater
+  virtual size_t state_bytes() const { return 0; }
+  // Whether applying a sum of deltas equals applying them one by one, then
+  // servers may sum deltas before the update. Only the updaters which say
+  // so are, stateful ones or ones reading the AddOption are not
+  virtual bool linear() const { return false; }
   // Factory method to get the updater
-  static Updater<T>* GetUpdater(size_t size = 0);
+  // row_size is the parameters of a table row, optimizer state is allocated
+  // by rows when they are first updated
+  static Updater<T>* GetUpdater(size_t size = 0, size_t row_size = 0);
+};
+
+// The default updater, adds the deltas to the data
+template <typename T>
+class DefaultUpdater : public Updater<T> {
+public:
+  bool linear() const override { return true; }
 };
 
 #define MV_INSTANTIATE_CLASS_WITH_REAL_TYPE(classname) \
@@ -109,8 +109,9 @@ private:
       }
 
       buffer_writer_(WritableBuffer(current_task_));
-      ready_waiter_.Notify();
+      // reset before the notify, else the next task may be missed
       new_task_waiter_.Reset(1);
+      ready_waiter_.Notify();
     }
   }
 };
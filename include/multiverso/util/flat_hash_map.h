@@ -0,0 +1,262 @@
+#ifndef MULTIVERSO_UTIL_FLAT_HASH_MAP_H_
+#define MULTIVERSO_UTIL_FLAT_HASH_MAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MULTIVERSO_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace multiverso {
+
+// Open addressing hash map for the KV tables. The slots are split into
+// groups of 16 with one control byte per slot, which holds 7 bits of the
+// hash of a full slot, or kEmpty. A lookup tests a whole group of control
+// bytes at once and only compares the keys of matching slots, then moves to
+// the next group while the group has no empty slot. Keys are never erased.
+//
+// Slots are std::pair<Key, Val> as in std::unordered_map, pointers to them
+// stay valid until the map grows, see reserve.
+template <typename Key, typename Val, typename Hash = std::hash<Key>>
+class FlatHashMap {
+public:
+  typedef std::pair<Key, Val> value_type;
+
+  template <typename Map, typename Value>
+  class Iterator {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Value value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Value* pointer;
+    typedef Value& reference;
+
+    Iterator(Map* map, size_t index) : map_(map), index_(index) { Skip(); }
+    Value& operator*() const { return map_->slots_[index_]; }
+    Value* operator->() const { return &map_->slots_[index_]; }
+    Iterator& operator++() { ++index_; Skip(); return *this; }
+    bool operator==(const Iterator& rhs) const { return index_ == rhs.index_; }
+    bool operator!=(const Iterator& rhs) const { return index_ != rhs.index_; }
+  private:
+    void Skip() {
+      while (index_ < map_->ctrl_.size() && map_->ctrl_[index_] == kEmpty) {
+        ++index_;
+      }
+    }
+    Map* map_;
+    size_t index_;
+  };
+  typedef Iterator<FlatHashMap, value_type> iterator;
+  typedef Iterator<const FlatHashMap, const value_type> const_iterator;
+
+  FlatHashMap() { clear(); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, ctrl_.size()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, ctrl_.size()); }
+
+  void clear() {
+    ctrl_.assign(kGroupSize, int8_t(kEmpty));
+    slots_.assign(kGroupSize, value_type());
+    size_ = 0;
+  }
+
+  // Grows so that count keys fit without moving the slots
+  void reserve(size_t count) {
+    size_t capacity = ctrl_.size();
+    while (count > MaxSize(capacity)) capacity *= 2;
+    if (capacity != ctrl_.size()) Rehash(capacity);
+  }
+
+  // Inserts a value initialized Val if key is missing
+  Val& operator[](const Key& key) {
+    reserve(size_ + 1);
+    return slots_[FindOrInsertSlot(key, HashOf(key))].second;
+  }
+
+  // nullptr if key is missing
+  Val* find(const Key& key) {
+    size_t slot = FindSlot(key, HashOf(key));
+    return slot == kNotFound ? nullptr : &slots_[slot].second;
+  }
+
+  const Val* find(const Key& key) const {
+    size_t slot = FindSlot(key, HashOf(key));
+    return slot == kNotFound ? nullptr : &slots_[slot].second;
+  }
+
+  size_t count(const Key& key) const { return find(key) != nullptr; }
+
+  // Batched lookup, values[i] is the value of keys[i] or nullptr. The hashes
+  // of a batch are computed and their groups prefetched before probing.
+  void Find(const Key* keys, size_t num, const Val** values) const {
+    size_t hashes[kBatch];
+    for (size_t begin = 0; begin < num; begin += kBatch) {
+      size_t batch = num - begin < kBatch ? num - begin : kBatch;
+      Prefetch(keys + begin, batch, hashes);
+      for (size_t i = 0; i < batch; ++i) {
+        size_t slot = FindSlot(keys[begin + i], hashes[i]);
+        values[begin + i] = slot == kNotFound ? nullptr : &slots_[slot].second;
+      }
+    }
+  }
+
+  // Batched insert, values[i] points to the value of keys[i], inserted
+  // value initialized if missing. The pointers are valid until the next
+  // call that inserts.
+  void FindOrInsert(const Key* keys, size_t num, Val** values) {
+    // keys are mostly there already, only grow for the missing ones, counted
+    // when the whole batch doesn't fit
+    if (size_ + num > MaxSize()) reserve(size_ + CountMissing(keys, num));
+    size_t hashes[kBatch];
+    for (size_t begin = 0; begin < num; begin += kBatch) {
+      size_t batch = num - begin < kBatch ? num - begin : kBatch;
+      Prefetch(keys + begin, batch, hashes);
+      for (size_t i = 0; i < batch; ++i) {
+        values[begin + i] =
+          &slots_[FindOrInsertSlot(keys[begin + i], hashes[i])].second;
+      }
+    }
+  }
+
+private:
+  static const int8_t kEmpty = -128;
+  static const size_t kGroupSize = 16;
+  static const size_t kBatch = 16;
+  static const size_t kNotFound = ~size_t(0);
+
+  static size_t HashOf(const Key& key) {
+    // std::hash of integers is the identity, mix the bits for the groups
+    uint64_t h = static_cast<uint64_t>(Hash()(key));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+
+  // keys that fit in capacity slots, at most 7/8 of them are full
+  static size_t MaxSize(size_t capacity) { return capacity / 8 * 7; }
+  size_t MaxSize() const { return MaxSize(ctrl_.size()); }
+
+  // number of keys not in the map, a key repeated in keys counts each time
+  size_t CountMissing(const Key* keys, size_t num) const {
+    size_t hashes[kBatch], missing = 0;
+    for (size_t begin = 0; begin < num; begin += kBatch) {
+      size_t batch = num - begin < kBatch ? num - begin : kBatch;
+      Prefetch(keys + begin, batch, hashes);
+      for (size_t i = 0; i < batch; ++i) {
+        missing += FindSlot(keys[begin + i], hashes[i]) == kNotFound;
+      }
+    }
+    return missing;
+  }
+
+  static int8_t Tag(size_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+
+  size_t FirstGroup(size_t hash) const {
+    return (hash >> 7) & (ctrl_.size() / kGroupSize - 1);
+  }
+
+  // bit i set for the slots of group whose control byte is tag
+  uint32_t Match(size_t group, int8_t tag) const {
+    const int8_t* ctrl = ctrl_.data() + group * kGroupSize;
+#ifdef MULTIVERSO_USE_SSE2
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    return static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(tag))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupSize; ++i) {
+      mask |= static_cast<uint32_t>(ctrl[i] == tag) << i;
+    }
+    return mask;
+#endif
+  }
+
+  static int LowestBit(uint32_t mask) {
+    int i = 0;
+    while (!(mask & 1)) { mask >>= 1; ++i; }
+    return i;
+  }
+
+  size_t FindSlot(const Key& key, size_t hash) const {
+    size_t num_groups = ctrl_.size() / kGroupSize;
+    int8_t tag = Tag(hash);
+    for (size_t group = FirstGroup(hash), step = 0; step < num_groups;
+         group = (group + 1) & (num_groups - 1), ++step) {
+      for (uint32_t mask = Match(group, tag); mask != 0; mask &= mask - 1) {
+        size_t slot = group * kGroupSize + LowestBit(mask);
+        if (slots_[slot].first == key) return slot;
+      }
+      if (Match(group, kEmpty) != 0) return kNotFound;
+    }
+    return kNotFound;
+  }
+
+  // the map must have room for one more key
+  size_t FindOrInsertSlot(const Key& key, size_t hash) {
+    size_t num_groups = ctrl_.size() / kGroupSize;
+    int8_t tag = Tag(hash);
+    for (size_t group = FirstGroup(hash); ;
+         group = (group + 1) & (num_groups - 1)) {
+      for (uint32_t mask = Match(group, tag); mask != 0; mask &= mask - 1) {
+        size_t slot = group * kGroupSize + LowestBit(mask);
+        if (slots_[slot].first == key) return slot;
+      }
+      uint32_t empty = Match(group, kEmpty);
+      if (empty != 0) {
+        // keys are never erased, the key is in no later group
+        size_t slot = group * kGroupSize + LowestBit(empty);
+        ctrl_[slot] = tag;
+        slots_[slot] = value_type(key, Val());
+        ++size_;
+        return slot;
+      }
+    }
+  }
+
+  void Prefetch(const Key* keys, size_t num, size_t* hashes) const {
+    for (size_t i = 0; i < num; ++i) {
+      hashes[i] = HashOf(keys[i]);
+#ifdef MULTIVERSO_USE_SSE2
+      size_t group = FirstGroup(hashes[i]);
+      _mm_prefetch(reinterpret_cast<const char*>(
+        ctrl_.data() + group * kGroupSize), _MM_HINT_T0);
+      _mm_prefetch(reinterpret_cast<const char*>(
+        slots_.data() + group * kGroupSize), _MM_HINT_T0);
+#endif
+    }
+  }
+
+  void Rehash(size_t capacity) {
+    std::vector<int8_t> ctrl(capacity, int8_t(kEmpty));
+    std::vector<value_type> slots(capacity);
+    ctrl_.swap(ctrl);
+    slots_.swap(slots);
+    size_ = 0;
+    for (size_t i = 0; i < ctrl.size(); ++i) {
+      if (ctrl[i] == kEmpty) continue;
+      size_t slot = FindOrInsertSlot(slots[i].first, HashOf(slots[i].first));
+      slots_[slot].second = std::move(slots[i].second);
+    }
+  }
+
+  std::vector<int8_t> ctrl_;
+  std::vector<value_type> slots_;
+  size_t size_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_UTIL_FLAT_HASH_MAP_H_
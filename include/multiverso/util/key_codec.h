@@ -0,0 +1,111 @@
+#ifndef MULTIVERSO_UTIL_KEY_CODEC_H_
+#define MULTIVERSO_UTIL_KEY_CODEC_H_
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "multiverso/blob.h"
+#include "multiverso/table_interface.h"
+#include "multiverso/util/log.h"
+
+namespace multiverso {
+
+// Delta + varint(LEB128) codec for arrays of ids. Sorted arrays store the
+// plain difference to the previous id, unsorted ones store it zigzag encoded,
+// so ids close to each other take one or two bytes instead of four.
+namespace key_codec {
+
+// First slot of an encoded key blob. A plain key blob never starts with a
+// negative id other than -1, which stands for the whole table.
+const integer_t kEncodedTag = -2;
+
+// Upper bound of the encoded bytes of count ids
+template <typename Int>
+inline size_t MaxEncodedSize(size_t count) {
+  return count * ((sizeof(Int) * 8 + 6) / 7);
+}
+
+// \return number of bytes written to out
+template <typename Int>
+size_t Encode(const Int* ids, size_t count, bool sorted, char* out) {
+  typedef typename std::make_unsigned<Int>::type UInt;
+  const int kShift = sizeof(Int) * 8 - 1;
+  uint8_t* p = reinterpret_cast<uint8_t*>(out);
+  UInt prev = 0;
+  for (size_t i = 0; i < count; ++i) {
+    UInt cur = static_cast<UInt>(ids[i]);
+    UInt delta = cur - prev;
+    if (!sorted) {
+      Int diff = static_cast<Int>(delta);
+      delta = (delta << 1) ^ static_cast<UInt>(diff >> kShift);
+    }
+    prev = cur;
+    while (delta >= 0x80) {
+      *p++ = static_cast<uint8_t>(delta | 0x80);
+      delta >>= 7;
+    }
+    *p++ = static_cast<uint8_t>(delta);
+  }
+  return p - reinterpret_cast<uint8_t*>(out);
+}
+
+// \return number of bytes consumed from in
+template <typename Int>
+size_t Decode(const char* in, size_t count, bool sorted, Int* ids) {
+  typedef typename std::make_unsigned<Int>::type UInt;
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(in);
+  UInt prev = 0;
+  for (size_t i = 0; i < count; ++i) {
+    uint8_t byte = *p++;
+    UInt delta = byte & 0x7f;
+    for (int shift = 7; byte & 0x80; shift += 7) {
+      byte = *p++;
+      delta |= static_cast<UInt>(byte & 0x7f) << shift;
+    }
+    if (!sorted) delta = (delta >> 1) ^ (~(delta & 1) + 1);
+    prev += delta;
+    ids[i] = static_cast<Int>(prev);
+  }
+  return p - reinterpret_cast<const uint8_t*>(in);
+}
+
+inline bool IsEncoded(const Blob& blob) {
+  return blob.size() >= 2 * sizeof(integer_t) &&
+    blob.As<integer_t>(0) == kEncodedTag;
+}
+
+// Encode ascending keys into a key blob: tag, count, then the varints
+inline Blob EncodeKeys(const integer_t* keys, size_t count) {
+  static thread_local std::vector<char> buffer;
+  size_t header = 2 * sizeof(integer_t);
+  buffer.resize(header + MaxEncodedSize<integer_t>(count));
+  integer_t* head = reinterpret_cast<integer_t*>(buffer.data());
+  head[0] = kEncodedTag;
+  head[1] = static_cast<integer_t>(count);
+  size_t size = Encode(keys, count, true, buffer.data() + header);
+  return Blob(buffer.data(), header + size);
+}
+
+// Keys of a key blob, decoded into buffer if needed
+// \return pointer to the keys, valid as long as blob and buffer
+inline const integer_t* DecodeKeys(const Blob& blob, size_t* count,
+                                   std::vector<integer_t>* buffer) {
+  if (!IsEncoded(blob)) {
+    *count = blob.size<integer_t>();
+    return reinterpret_cast<const integer_t*>(blob.data());
+  }
+  *count = blob.As<integer_t>(1);
+  buffer->resize(*count);
+  size_t header = 2 * sizeof(integer_t);
+  size_t size = Decode(blob.data() + header, *count, true, buffer->data());
+  CHECK(header + size == blob.size());
+  return buffer->data();
+}
+
+}  // namespace key_codec
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_UTIL_KEY_CODEC_H_
@@ -1,7 +1,9 @@
 #ifndef MULTIVERSO_LOG_H_
 #define MULTIVERSO_LOG_H_
 
+#include <cstdarg>
 #include <fstream>
+#include <memory>
 #include <string>
 
 namespace multiverso {
@@ -17,6 +19,31 @@ namespace multiverso {
   if ((pointer) == nullptr) multiverso::Log::Fatal(#pointer " Can't be NULL\n");
 #endif
 
+// The MV_LOG macros drop the messages below MULTIVERSO_LOG_MIN_LEVEL at
+// compile time, e.g. -DMULTIVERSO_LOG_MIN_LEVEL=1 removes the debug logging
+#ifndef MULTIVERSO_LOG_MIN_LEVEL
+#define MULTIVERSO_LOG_MIN_LEVEL 0
+#endif
+
+// Whether the messages of level (Debug, Info, Error or Fatal) are written
+#define MV_LOG_ENABLED(level)                                          \
+  (static_cast<int>(multiverso::LogLevel::level) >=                    \
+     MULTIVERSO_LOG_MIN_LEVEL &&                                       \
+   multiverso::Log::IsEnabled(multiverso::LogLevel::level))
+
+// Level checked logging, the arguments are not evaluated if the level is
+// disabled. Use these instead of Log::Debug on hot paths.
+#define MV_LOG(level, ...)                                             \
+  do {                                                                 \
+    if (MV_LOG_ENABLED(level)) {                                       \
+      multiverso::Log::Write(multiverso::LogLevel::level, __VA_ARGS__);\
+    }                                                                  \
+  } while (0)
+
+#define MV_LOG_DEBUG(...) MV_LOG(Debug, __VA_ARGS__)
+#define MV_LOG_INFO(...) MV_LOG(Info, __VA_ARGS__)
+#define MV_LOG_ERROR(...) MV_LOG(Error, __VA_ARGS__)
+
 // A enumeration type of log message levels. The values are ordered:
 // Debug < Info < Error < Fatal.
 enum class LogLevel : int {
@@ -71,6 +98,23 @@ public:
   *        error occurs. By defualt the option is false.
   */
   void ResetKillFatal(bool is_kill_fatal) { is_kill_fatal_ = is_kill_fatal; }
+  /*!
+  * \brief Whether the messages of level are written.
+  */
+  bool IsEnabled(LogLevel level) const { return level >= level_; }
+  /*!
+  * \brief Starts a thread writing the messages, which the logging threads
+  *        format and queue in a ring buffer instead of writing them. The
+  *        messages arriving when the buffer is full are dropped and
+  *        counted, Fatal messages are written after the queued ones.
+  *        StartAsync and StopAsync must not race with the logging.
+  * \param capacity The number of messages of the ring buffer.
+  */
+  void StartAsync(size_t capacity);
+  /*!
+  * \brief Writes the queued messages and stops the writing thread.
+  */
+  void StopAsync();
 
   /*!
   * \brief C style formatted method for writing log messages. A message
@@ -86,7 +130,11 @@ public:
   void Fatal(const char *format, ...);
 
 private:
+  class AsyncSink;
+
   void WriteImpl(LogLevel level, const char* format, va_list* val);
+  // Writes a formatted message to STDOUT (or STDERR) and the log file
+  void Output(const std::string& message);
   void CloseLogFile();
   // Returns current system time as a string.
   std::string GetSystemTime();
@@ -96,6 +144,7 @@ private:
   std::FILE *file_;  // A file pointer to the log file.
   LogLevel level_;   // Only the message not less than level_ will be outputted.
   bool is_kill_fatal_;  // If kill the process when fatal error occurs.
+  std::unique_ptr<AsyncSink> async_;  // nullptr when writing synchronously
 
   // No copying allowed
   Logger(const Logger&);
@@ -129,6 +178,16 @@ public:
   *        error occurs. By default the option is false.
   */
   static void ResetKillFatal(bool is_kill_fatal);
+  /*! \brief Whether the messages of level are written. */
+  static bool IsEnabled(LogLevel level) { return logger_.IsEnabled(level); }
+  /*!
+  * \brief See Logger::StartAsync and Logger::StopAsync. The sink is
+  *        shared by the callers in the process, e.g. the zoos of
+  *        MV_RunLocal: the first StartAsync starts it and the StopAsync
+  *        matching the last one stops it. Thread safe.
+  */
+  static void StartAsync(size_t capacity);
+  static void StopAsync();
 
   /*! \brief The C formatted methods of writing the messages. */
   static void Write(LogLevel level, const char* format, ...);
@@ -0,0 +1,50 @@
+#ifndef MULTIVERSO_UTIL_METRICS_REPORTER_H_
+#define MULTIVERSO_UTIL_METRICS_REPORTER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace multiverso {
+
+struct DashboardSnapshot;
+
+// Writes a snapshot of the Dashboard every interval seconds from a
+// background thread, so that long jobs can be watched live. The snapshots
+// are appended to the file as JSON lines, or replace it in the Prometheus
+// text format, for the textfile collector of node exporter. The recording
+// threads never wait for the reporter, see dashboard::ThreadShards.
+class MetricsReporter {
+public:
+  enum Format { kJsonLines, kPrometheus };
+
+  MetricsReporter(const std::string& path, int interval, Format format,
+                  int rank);
+  // Stops the thread after a last snapshot
+  ~MetricsReporter();
+
+  // The reporter of the metrics_* flags for rank, nullptr if disabled
+  static MetricsReporter* FromFlags(int rank);
+
+  // Writes a snapshot now
+  void Report();
+
+private:
+  void Main();
+  std::string ToJson(const DashboardSnapshot& snapshot) const;
+  std::string ToPrometheus(const DashboardSnapshot& snapshot) const;
+
+  std::string path_;
+  int interval_;
+  Format format_;
+  int rank_;
+  std::mutex m_;
+  std::condition_variable cv_;
+  bool stop_;
+  std::thread thread_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_UTIL_METRICS_REPORTER_H_
@@ -4,6 +4,7 @@
 #define MULTIVERSO_MT_QUEUE_H_
 
 #include <atomic>
+#include <chrono>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
@@ -40,6 +41,16 @@ public:
   /*! \brief thread will not be blocked. Return false if queue is empty */
   bool TryPop(T& result);
 
+  /*!
+   * \brief Wait at most timeout_ms milliseconds for the queue to be non
+   *        empty, without popping
+   * \return true if the queue is not empty
+   */
+  bool Wait(int timeout_ms);
+
+  /*! \brief Block until all the elements are popped or the queue is exited */
+  void WaitEmpty();
+
   /*!
    * \brief Get the front element from the queue, if the queue is empty,
    *        threat who call front would be blocked. Not move semantics.
@@ -70,6 +81,8 @@ private:
   std::queue<T> buffer_;
   mutable std::mutex mutex_;
   std::condition_variable empty_condition_;
+  /*! notified when the last element is popped */
+  std::condition_variable drain_condition_;
   /*! whether the queue is still work */
   std::atomic_bool exit_;
   // bool exit_;
@@ -97,6 +110,7 @@ bool MtQueue<T>::Pop(T& result) {
   if (buffer_.empty()) return false;
   result = std::move(buffer_.front());
   buffer_.pop();
+  if (buffer_.empty()) drain_condition_.notify_all();
   return true;
 }
 
@@ -106,9 +120,23 @@ bool MtQueue<T>::TryPop(T& result) {
   if (buffer_.empty()) return false;
   result = std::move(buffer_.front());
   buffer_.pop();
+  if (buffer_.empty()) drain_condition_.notify_all();
   return true;
 }
 
+template<typename T>
+bool MtQueue<T>::Wait(int timeout_ms) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return empty_condition_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+    [this]{ return !buffer_.empty() || exit_; }) && !buffer_.empty();
+}
+
+template<typename T>
+void MtQueue<T>::WaitEmpty() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  drain_condition_.wait(lock, [this]{ return buffer_.empty() || exit_; });
+}
+
 template<typename T>
 bool MtQueue<T>::Front(T& result) {
   std::unique_lock<std::mutex> lock(mutex_);
@@ -136,6 +164,7 @@ void MtQueue<T>::Exit() {
   std::lock_guard<std::mutex> lock(mutex_);
   exit_.store(true);
   empty_condition_.notify_all();
+  drain_condition_.notify_all();
 }
 
 template<typename T>
@@ -0,0 +1,61 @@
+#ifndef MULTIVERSO_UTIL_POLLER_H_
+#define MULTIVERSO_UTIL_POLLER_H_
+
+#include <functional>
+#include <string>
+
+#include "multiverso/util/timer.h"
+
+namespace multiverso {
+
+// Back off of a loop polling for messages. After a round without work the
+// loop spins for a while, then yields the cpu, and at last blocks in a wait
+// function with a timeout. A busy loop never leaves the cpu, an idle one
+// doesn't burn a full core.
+class AdaptivePoller {
+public:
+  // Blocks at most timeout_ms milliseconds for new work
+  typedef std::function<void(int timeout_ms)> WaitFunc;
+
+  AdaptivePoller();
+
+  // Called after each round of the loop, progress tells whether the round
+  // did some work
+  void Poll(bool progress, const WaitFunc& wait);
+
+  long long rounds() const { return rounds_; }
+  long long work_rounds() const { return work_rounds_; }
+  long long waits() const { return waits_; }
+  // share of rounds doing some work
+  double efficiency() const {
+    return rounds_ == 0 ? 0 : static_cast<double>(work_rounds_) / rounds_;
+  }
+  // milliseconds spent idle on the cpu (spin and yield) and blocked
+  double idle_busy_ms() const { return idle_busy_ms_; }
+  double idle_blocked_ms() const { return idle_blocked_ms_; }
+
+  std::string info_string() const;
+
+private:
+  // Ends an idle period, accounting the time spent on the cpu
+  void EndIdle();
+
+  // consecutive rounds without work, up to yield_budget_ + 1
+  int idle_rounds_;
+  int spin_budget_;
+  int yield_budget_;
+  int wait_ms_;
+  long long rounds_;
+  long long work_rounds_;
+  long long waits_;
+  double idle_busy_ms_;
+  double idle_blocked_ms_;
+  // time spent blocked in the current idle period
+  double blocked_ms_;
+  Timer idle_timer_;
+  Timer wait_timer_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_UTIL_POLLER_H_
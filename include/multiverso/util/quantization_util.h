@@ -2,10 +2,21 @@
 #define MULTIVERSO_UTIL_QUANTIZATION_UTIL_H_
 
 #include <multiverso/blob.h>
-#include <vector>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 #include <multiverso/util/log.h>
 
+#if defined(__SSE__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#ifndef MULTIVERSO_USE_SSE
+#define MULTIVERSO_USE_SSE
+#endif
+#include <xmmintrin.h>
+#endif
+
 namespace multiverso {
   class QuantizationFilter {
   public:
@@ -21,19 +32,29 @@ namespace multiverso {
   private:
   };
 
+  // Compresses the blobs with less than half of their values above clip into
+  // the positions and values of these, the others are treated as zeros.
+  //
+  // FilterIn outputs the first blob, a size blob, the data blobs, then the
+  // option blob if skip_last_line. The size blob holds an index_type for each
+  // data blob: -1 if it is sent as is, otherwise its original byte size s,
+  // as s for the version 1 format and as -2 - s for the version 2 format.
+  // - version 1 interleaves index and value pairs in data_type slots
+  // - version 2 stores count values, then count indices
+  // FilterOut reads both formats, FilterIn writes version 2 unless an older
+  // peer needs version 1.
   template<typename data_type, typename index_type>
   class SparseFilter : public QuantizationFilter {
   public:
-    explicit SparseFilter(double clip, bool skip_last_line = false) :
-      clip_value_(clip), skip_option_blob_(skip_last_line){}
+    explicit SparseFilter(double clip, bool skip_last_line = false,
+      int version = 2) :
+      clip_value_(static_cast<data_type>(clip)),
+      skip_option_blob_(skip_last_line), version_(version) {
+      CHECK(version == 1 || version == 2);
+    }
 
     ~SparseFilter() {}
 
-    // Returns compressed blobs given input blobs.
-    // - compressing will generate one more blob in result:
-    //   which contained the original size of compressed row
-    // - if blob compressed, the content of blob will change to:
-    //   col0 ,val0, col1 , val1, ..., coln, valn
     void FilterIn(const std::vector<Blob>& blobs,
       std::vector<Blob>* outputs) override {
       CHECK_NOTNULL(outputs);
@@ -51,9 +72,10 @@ namespace multiverso {
           auto& blob = blobs[i];
           Blob compressed_blob;
           auto compressed = TryCompress(blob, &compressed_blob);
-          // size info (compressed ? size : -1)
-          size_blob.As<index_type>(i - 1) = compressed ? (index_type) blob.size() : -1;
-          outputs->push_back(compressed ? std::move(compressed_blob) : blob);
+          index_type size = static_cast<index_type>(blob.size());
+          size_blob.As<index_type>(i - 1) = !compressed ? -1 :
+            (version_ == 1 ? size : -2 - size);
+          outputs->push_back(compressed ? compressed_blob : blob);
         }
       }
       if (skip_option_blob_){
@@ -75,13 +97,15 @@ namespace multiverso {
       if (data_blobs_size > 1){
         auto& size_blob = blobs[1];
         for (auto i = 2; i < data_blobs_size; i++) {
-          // size info (compressed ? size : -1)
-          auto is_compressed = size_blob.As<index_type>(i - 2) >= 0;
-          auto size = is_compressed ?
-            size_blob.As<index_type>(i - 2) : blobs[i].size();
+          index_type size = size_blob.As<index_type>(i - 2);
           auto& blob = blobs[i];
-          outputs->push_back(is_compressed ?
-            std::move(DeCompress(blob, size)) : blob);
+          if (size == -1) {
+            outputs->push_back(blob);
+          } else if (size >= 0) {
+            outputs->push_back(DeCompressV1(blob, size));
+          } else {
+            outputs->push_back(DeCompress(blob, -2 - size));
+          }
         }
       }
       if (skip_option_blob_){
@@ -91,10 +115,71 @@ namespace multiverso {
     }
 
   protected:
+    bool TryCompress(const Blob& in_blob, Blob* out_blob) {
+      CHECK_NOTNULL(out_blob);
+      if (version_ == 1) return TryCompressV1(in_blob, out_blob);
+      size_t data_count = in_blob.size<data_type>();
+      if (data_count == 0) return false;
+      const data_type* in = reinterpret_cast<const data_type*>(in_blob.data());
+      // compressed while less than half of the values are kept
+      size_t max_count = (data_count - 1) / 2;
+      // Compact writes up to 4 values past the count
+      if (indices_.size() < data_count + 4) {
+        indices_.resize(data_count + 4);
+        values_.resize(data_count + 4);
+      }
+      size_t count = 0;
+      if (!Compact(in, data_count, max_count, &count)) return false;
+      if (count == 0) {
+        // Blob does not support empty content,
+        //  fill the blob with first value
+        indices_[0] = 0;
+        values_[0] = in[0];
+        count = 1;
+      }
+
+      Blob result(count * (sizeof(data_type) + sizeof(index_type)));
+      memcpy(result.data(), values_.data(), count * sizeof(data_type));
+      memcpy(result.data() + count * sizeof(data_type), indices_.data(),
+        count * sizeof(index_type));
+      *out_blob = result;
+      return true;
+    }
+
+    // Appends the position and value of each value above clip to indices_
+    // and values_, stops with false once more than max_count are found.
+    // Every candidate is written, count only moves past the kept ones.
+    bool Compact(const data_type* in, size_t n, size_t max_count,
+      size_t* count) {
+      index_type* indices = indices_.data();
+      data_type* values = values_.data();
+      size_t c = 0;
+      for (size_t i = 0; i < n; ++i) {
+        indices[c] = static_cast<index_type>(i);
+        values[c] = in[i];
+        c += std::abs(in[i]) > clip_value_;
+        if (c > max_count) return false;
+      }
+      *count = c;
+      return true;
+    }
+
+    Blob DeCompress(const Blob& in_blob, size_t size) {
+      CHECK(size % sizeof(data_type) == 0);
+      Blob result(size);
+      memset(result.data(), 0, size);
+      size_t count = in_blob.size() / (sizeof(data_type) + sizeof(index_type));
+      const data_type* values =
+        reinterpret_cast<const data_type*>(in_blob.data());
+      const index_type* indices = reinterpret_cast<const index_type*>(
+        in_blob.data() + count * sizeof(data_type));
+      data_type* out = reinterpret_cast<data_type*>(result.data());
+      for (size_t i = 0; i < count; ++i) out[indices[i]] = values[i];
+      return result;
+    }
 
-    bool TryCompress(const Blob& in_blob,
+    bool TryCompressV1(const Blob& in_blob,
       Blob* out_blob) {
-      CHECK_NOTNULL(out_blob);
       auto data_count = in_blob.size<data_type>();
       auto non_zero_count = 0;
       for (auto i = 0; i < data_count; ++i) {
@@ -107,9 +192,6 @@ namespace multiverso {
         return false;
 
       if (non_zero_count == 0) {
-        // Blob does not support empty content,
-        //  fill the blob with first value
-
         Blob result(2 * sizeof(data_type));
         // set index
         result.As<index_type>(0) = 0;
@@ -136,13 +218,10 @@ namespace multiverso {
       return true;
     }
 
-    Blob DeCompress(const Blob& in_blob, size_t size) {
+    Blob DeCompressV1(const Blob& in_blob, size_t size) {
       CHECK(size % sizeof(data_type) == 0);
-      auto original_data_count = size / sizeof(data_type);
       Blob result(size);
-      for (auto i = 0; i < original_data_count; ++i) {
-        result.As<data_type>(i) = 0;
-      }
+      memset(result.data(), 0, size);
       auto data_count = in_blob.size<data_type>();
       for (auto i = 0; i < data_count; i += 2) {
         auto index = in_blob.As<index_type>(i);
@@ -153,12 +232,342 @@ namespace multiverso {
       return result;
     }
   private:
-    double clip_value_;
+    data_type clip_value_;
+    bool skip_option_blob_;
+    int version_;
+    // compaction buffers, kept across calls
+    std::vector<index_type> indices_;
+    std::vector<data_type> values_;
+  };
+
+#ifdef MULTIVERSO_USE_SSE
+  // Compares 4 values at a time, blocks without any value above clip are
+  // skipped, the others are compacted as in the scalar loop
+  template<>
+  inline bool SparseFilter<float, int32_t>::Compact(const float* in, size_t n,
+    size_t max_count, size_t* count) {
+    int32_t* indices = indices_.data();
+    float* values = values_.data();
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 clip = _mm_set1_ps(clip_value_);
+    size_t c = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+      __m128 v = _mm_loadu_ps(in + i);
+      int mask = _mm_movemask_ps(_mm_cmpgt_ps(_mm_andnot_ps(sign, v), clip));
+      if (mask == 0) continue;
+      for (int j = 0; j < 4; ++j) {
+        values[c] = in[i + j];
+        indices[c] = static_cast<int32_t>(i + j);
+        c += (mask >> j) & 1;
+      }
+      if (c > max_count) return false;
+    }
+    for (; i < n; ++i) {
+      indices[c] = static_cast<int32_t>(i);
+      values[c] = in[i];
+      c += std::abs(in[i]) > clip_value_;
+      if (c > max_count) return false;
+    }
+    *count = c;
+    return true;
+  }
+#endif
+
+  // Encoded blobs of the delta filters start with 4 int32_t: the tag, the
+  // bits per value (0 for top-k), then num_row and row_size for quantized
+  // rows or count and size for top-k
+  const int32_t kDeltaFilterTag = -3;
+  const size_t kDeltaFilterHeader = 4 * sizeof(int32_t);
+
+  // Lossy filters of Add deltas. Encode leaves in the rows what the encoding
+  // lost, so that a worker keeping them as residual adds back the dropped
+  // mass to its next Add of the same rows (error feedback). FilterIn drops
+  // it, as SparseFilter drops the values below its clip.
+  template<typename data_type>
+  class DeltaFilter : public QuantizationFilter {
+  public:
+    explicit DeltaFilter(size_t row_size, bool skip_last_line = false) :
+      row_size_(row_size), skip_option_blob_(skip_last_line) {}
+
+    // Encodes the num_row rows of row_size values, overwriting them with
+    // the part of the values which is lost
+    virtual Blob Encode(data_type* const* rows, size_t num_row) = 0;
+
+    // Number of values of an encoded blob
+    static size_t DecodedSize(const Blob& blob) {
+      CHECK(blob.size() >= kDeltaFilterHeader);
+      CHECK(blob.As<int32_t>(0) == kDeltaFilterTag);
+      return blob.As<int32_t>(1) == 0 ? blob.As<int32_t>(3) :
+        static_cast<size_t>(blob.As<int32_t>(2)) * blob.As<int32_t>(3);
+    }
+
+    // Decodes blob into its DecodedSize values
+    static void Decode(const Blob& blob, data_type* out);
+
+    void FilterIn(const std::vector<Blob>& blobs,
+      std::vector<Blob>* outputs) override {
+      CHECK_NOTNULL(outputs);
+      outputs->clear();
+      outputs->push_back(blobs[0]);
+      size_t data_blobs_size = skip_option_blob_ ? blobs.size() - 1 : blobs.size();
+      std::vector<data_type*> rows;
+      for (size_t i = 1; i < data_blobs_size; ++i) {
+        Blob values(blobs[i].data(), blobs[i].size());  // Encode overwrites
+        CHECK(values.size<data_type>() % row_size_ == 0);
+        rows.resize(values.size<data_type>() / row_size_);
+        for (size_t r = 0; r < rows.size(); ++r) {
+          rows[r] = &values.As<data_type>(r * row_size_);
+        }
+        outputs->push_back(Encode(rows.data(), rows.size()));
+      }
+      if (skip_option_blob_) outputs->push_back(blobs[blobs.size() - 1]);
+    }
+
+    void FilterOut(const std::vector<Blob>& blobs,
+      std::vector<Blob>* outputs) override {
+      CHECK_NOTNULL(outputs);
+      outputs->clear();
+      outputs->push_back(blobs[0]);
+      size_t data_blobs_size = skip_option_blob_ ? blobs.size() - 1 : blobs.size();
+      for (size_t i = 1; i < data_blobs_size; ++i) {
+        Blob values(DecodedSize(blobs[i]) * sizeof(data_type));
+        Decode(blobs[i], reinterpret_cast<data_type*>(values.data()));
+        outputs->push_back(values);
+      }
+      if (skip_option_blob_) outputs->push_back(blobs[blobs.size() - 1]);
+    }
+
+  protected:
+    static Blob NewBlob(int32_t bits, size_t a, size_t b, size_t bytes) {
+      CHECK(a <= INT32_MAX && b <= INT32_MAX);
+      Blob blob(kDeltaFilterHeader + bytes);
+      blob.As<int32_t>(0) = kDeltaFilterTag;
+      blob.As<int32_t>(1) = bits;
+      blob.As<int32_t>(2) = static_cast<int32_t>(a);
+      blob.As<int32_t>(3) = static_cast<int32_t>(b);
+      return blob;
+    }
+
+    size_t row_size_;
     bool skip_option_blob_;
   };
 
-  class OneBitsFilter : public QuantizationFilter{
+  // Keeps the ratio of values with the largest magnitude in each row, or in
+  // the whole blob, as count indices then count values
+  template<typename data_type>
+  class TopKFilter : public DeltaFilter<data_type> {
+  public:
+    TopKFilter(double ratio, size_t row_size, bool per_row,
+      bool skip_last_line = false) :
+      DeltaFilter<data_type>(row_size, skip_last_line),
+      ratio_(ratio), per_row_(per_row) {
+      CHECK(ratio > 0 && ratio <= 1);
+    }
+
+    Blob Encode(data_type* const* rows, size_t num_row) override {
+      size_t row_size = this->row_size_;
+      size_t size = num_row * row_size;
+      auto value = [rows, row_size](size_t i) -> data_type& {
+        return rows[i / row_size][i % row_size];
+      };
+      auto larger = [&value](size_t a, size_t b) {
+        return std::abs(value(a)) > std::abs(value(b));
+      };
+      selected_.clear();
+      if (per_row_) {
+        size_t k = Count(row_size);
+        for (size_t r = 0; r < num_row; ++r) {
+          size_t begin = selected_.size();
+          for (size_t i = 0; i < row_size; ++i) {
+            selected_.push_back(r * row_size + i);
+          }
+          std::nth_element(selected_.begin() + begin,
+            selected_.begin() + begin + k - 1, selected_.end(), larger);
+          selected_.resize(begin + k);
+        }
+      } else if (size > 0) {
+        size_t k = Count(size);
+        selected_.resize(size);
+        for (size_t i = 0; i < size; ++i) selected_[i] = i;
+        std::nth_element(selected_.begin(), selected_.begin() + k - 1,
+          selected_.end(), larger);
+        selected_.resize(k);
+      }
+
+      size_t count = selected_.size();
+      Blob blob = DeltaFilter<data_type>::NewBlob(0, count, size,
+        count * (sizeof(int32_t) + sizeof(data_type)));
+      int32_t* indices = reinterpret_cast<int32_t*>(
+        blob.data() + kDeltaFilterHeader);
+      data_type* values = reinterpret_cast<data_type*>(indices + count);
+      for (size_t i = 0; i < count; ++i) {
+        data_type& v = value(selected_[i]);
+        indices[i] = static_cast<int32_t>(selected_[i]);
+        values[i] = v;
+        v = 0;
+      }
+      return blob;
+    }
+
+  private:
+    size_t Count(size_t size) const {
+      size_t k = static_cast<size_t>(std::ceil(ratio_ * size));
+      return k < 1 ? 1 : (k > size ? size : k);
+    }
+
+    double ratio_;
+    bool per_row_;
+    std::vector<size_t> selected_;
   };
+
+  // 1 or 2 bits quantization of each row. A row stores base and step, its
+  // values are decoded as base + code * step: with 1 bit the codes pick the
+  // mean of the negative or of the non negative values of the row, with 2
+  // bits they are the nearest of 4 levels evenly spread over the row range
+  template<typename data_type>
+  class OneBitsFilter : public DeltaFilter<data_type> {
+  public:
+    explicit OneBitsFilter(size_t row_size, int bits = 1,
+      bool skip_last_line = false) :
+      DeltaFilter<data_type>(row_size, skip_last_line), bits_(bits) {
+      CHECK(bits == 1 || bits == 2);
+    }
+
+    static size_t RowBytes(size_t row_size, int bits) {
+      return (row_size * bits + 7) / 8;
+    }
+
+    Blob Encode(data_type* const* rows, size_t num_row) override {
+      size_t row_size = this->row_size_;
+      size_t row_bytes = RowBytes(row_size, bits_);
+      Blob blob = DeltaFilter<data_type>::NewBlob(bits_, num_row, row_size,
+        num_row * (2 * sizeof(data_type) + row_bytes));
+      data_type* scales = reinterpret_cast<data_type*>(
+        blob.data() + kDeltaFilterHeader);
+      uint8_t* codes = reinterpret_cast<uint8_t*>(scales + 2 * num_row);
+      memset(codes, 0, num_row * row_bytes);
+
+      for (size_t r = 0; r < num_row; ++r) {
+        data_type* row = rows[r];
+        data_type base, step;
+        if (bits_ == 1) {
+          double pos = 0, neg = 0;
+          size_t num_pos = 0;
+          for (size_t i = 0; i < row_size; ++i) {
+            if (row[i] >= 0) { pos += row[i]; ++num_pos; } else { neg += row[i]; }
+          }
+          if (num_pos > 0) pos /= num_pos;
+          if (num_pos < row_size) neg /= row_size - num_pos;
+          base = static_cast<data_type>(neg);
+          step = static_cast<data_type>(pos - neg);
+        } else {
+          data_type range = 0;
+          for (size_t i = 0; i < row_size; ++i) {
+            range = std::max(range, static_cast<data_type>(std::abs(row[i])));
+          }
+          base = -range;
+          step = static_cast<data_type>(range * 2 / 3);
+        }
+        scales[2 * r] = base;
+        scales[2 * r + 1] = step;
+
+        uint8_t* row_codes = codes + r * row_bytes;
+        int max_code = (1 << bits_) - 1;
+        for (size_t i = 0; i < row_size; ++i) {
+          int code;
+          if (bits_ == 1) {
+            code = row[i] >= 0 ? 1 : 0;
+          } else {
+            code = step == 0 ? 0 : static_cast<int>(
+              std::floor((row[i] - base) / static_cast<double>(step) + 0.5));
+            code = std::min(std::max(code, 0), max_code);
+          }
+          size_t bit = i * bits_;
+          row_codes[bit / 8] |= static_cast<uint8_t>(code << (bit % 8));
+          row[i] -= base + code * step;
+        }
+      }
+      return blob;
+    }
+
+    // Decodes the row_size values of a row from its codes
+    static void DecodeRow(const uint8_t* codes, size_t row_size, int bits,
+      data_type base, data_type step, data_type* out) {
+      int mask = (1 << bits) - 1;
+      for (size_t i = 0; i < row_size; ++i) {
+        size_t bit = i * bits;
+        out[i] = base + ((codes[bit / 8] >> (bit % 8)) & mask) * step;
+      }
+    }
+
+  private:
+    int bits_;
+  };
+
+#ifdef MULTIVERSO_USE_SSE
+  // codes of each byte as floats, 8 codes for 1 bit and 4 for 2 bits
+  struct QuantizationCodeTable {
+    QuantizationCodeTable() {
+      for (int bits = 1; bits <= 2; ++bits) {
+        for (int byte = 0; byte < 256; ++byte) {
+          for (int i = 0; i < 8 / bits; ++i) {
+            codes[bits - 1][byte][i] = static_cast<float>(
+              (byte >> (i * bits)) & ((1 << bits) - 1));
+          }
+        }
+      }
+    }
+    float codes[2][256][8];
+  };
+
+  template<>
+  inline void OneBitsFilter<float>::DecodeRow(const uint8_t* codes,
+    size_t row_size, int bits, float base, float step, float* out) {
+    static const QuantizationCodeTable table;
+    __m128 vbase = _mm_set1_ps(base), vstep = _mm_set1_ps(step);
+    size_t per_byte = 8 / bits, i = 0;
+    for (; i + per_byte <= row_size; i += per_byte) {
+      const float* c = table.codes[bits - 1][codes[i / per_byte]];
+      for (size_t j = 0; j < per_byte; j += 4) {
+        _mm_storeu_ps(out + i + j, _mm_add_ps(vbase,
+          _mm_mul_ps(_mm_loadu_ps(c + j), vstep)));
+      }
+    }
+    int mask = (1 << bits) - 1;
+    for (; i < row_size; ++i) {
+      size_t bit = i * bits;
+      out[i] = base + ((codes[bit / 8] >> (bit % 8)) & mask) * step;
+    }
+  }
+#endif
+
+  template<typename data_type>
+  void DeltaFilter<data_type>::Decode(const Blob& blob, data_type* out) {
+    size_t size = DecodedSize(blob);
+    int bits = blob.As<int32_t>(1);
+    const char* payload = blob.data() + kDeltaFilterHeader;
+    if (bits == 0) {
+      size_t count = blob.As<int32_t>(2);
+      CHECK(blob.size() == kDeltaFilterHeader +
+        count * (sizeof(int32_t) + sizeof(data_type)));
+      const int32_t* indices = reinterpret_cast<const int32_t*>(payload);
+      const data_type* values =
+        reinterpret_cast<const data_type*>(indices + count);
+      memset(out, 0, size * sizeof(data_type));
+      for (size_t i = 0; i < count; ++i) out[indices[i]] += values[i];
+      return;
+    }
+    size_t num_row = blob.As<int32_t>(2), row_size = blob.As<int32_t>(3);
+    size_t row_bytes = OneBitsFilter<data_type>::RowBytes(row_size, bits);
+    CHECK(blob.size() == kDeltaFilterHeader +
+      num_row * (2 * sizeof(data_type) + row_bytes));
+    const data_type* scales = reinterpret_cast<const data_type*>(payload);
+    const uint8_t* codes = reinterpret_cast<const uint8_t*>(scales + 2 * num_row);
+    for (size_t r = 0; r < num_row; ++r) {
+      OneBitsFilter<data_type>::DecodeRow(codes + r * row_bytes, row_size,
+        bits, scales[2 * r], scales[2 * r + 1], out + r * row_size);
+    }
+  }
 }  // namespace multiverso
 
 #endif  // MULTIVERSO_UTIL_QUANTIZATION_UTIL_H_
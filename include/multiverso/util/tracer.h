@@ -0,0 +1,64 @@
+#ifndef MULTIVERSO_UTIL_TRACER_H_
+#define MULTIVERSO_UTIL_TRACER_H_
+
+#include <cstdint>
+#include <string>
+
+namespace multiverso {
+
+// Sampled tracing of table requests. One in trace_sample requests gets a
+// trace id, carried by all the messages it causes in the header slot of
+// Message::trace_id, and every stage handling such a message records a span
+// of the thread it runs on: the request until its last reply, actor
+// handlers, communicator sends and receives, server queueing.
+//
+// Each rank dumps its spans at shutdown as Chrome trace events, pid is the
+// rank and timestamps are wall clock microseconds, so the traceEvents arrays
+// of all the ranks can be concatenated into one trace. The spans of a
+// request share a bind_id, which Perfetto draws as flow arrows.
+class Tracer {
+public:
+  // Trace id of a new request, 0 if it is not sampled
+  static int NewTrace();
+
+  static bool enabled();
+
+  // Wall clock microseconds
+  static int64_t Now();
+
+  // Records a span [begin, end) of trace on the calling thread
+  static void Span(int trace, const char* name, int64_t begin, int64_t end);
+  static void Span(int trace, const std::string& name, int64_t begin,
+                   int64_t end) {
+    Span(trace, name.c_str(), begin, end);
+  }
+
+  // Name of the calling thread in the trace
+  static void SetThreadName(const std::string& name);
+
+  // Writes the spans recorded by the threads of rank as a Chrome trace JSON
+  // file, and drops them
+  static void Dump(const std::string& path, int rank);
+};
+
+// Records the span of its scope if trace is not 0
+class TraceScope {
+public:
+  TraceScope(int trace, const std::string& name)
+    : trace_(trace), begin_(trace != 0 ? Tracer::Now() : 0) {
+    if (trace_ != 0) name_ = name;
+  }
+
+  ~TraceScope() {
+    if (trace_ != 0) Tracer::Span(trace_, name_, begin_, Tracer::Now());
+  }
+
+private:
+  int trace_;
+  int64_t begin_;
+  std::string name_;
+};
+
+}  // namespace multiverso
+
+#endif  // MULTIVERSO_UTIL_TRACER_H_
@@ -21,6 +21,12 @@ public:
     cv_.notify_all();
   }
 
+  // Whether all the notifications arrived
+  bool done() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return num_wait_ <= 0;
+  }
+
   void Reset(int num_wait) {
     std::unique_lock<std::mutex> lock(mutex_);
     num_wait_ = num_wait;
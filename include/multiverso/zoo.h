@@ -1,6 +1,7 @@
 #ifndef MULTIVERSO_ZOO_H_
 #define MULTIVERSO_ZOO_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -11,6 +12,7 @@
 
 namespace multiverso {
 
+class MetricsReporter;
 class NetInterface;
 
 //  Zoo Manage all components in the system, include all actors, and network
@@ -19,7 +21,18 @@ class NetInterface;
 class Zoo {
 public:
   ~Zoo();
-  inline static Zoo* Get() { static Zoo zoo; return &zoo; }
+  // The zoo of the calling thread. Threads of a rank running inside this
+  // process with other ranks (see MV_RunLocal) are bound to the zoo of that
+  // rank, all the other threads share the default one
+  inline static Zoo* Get() {
+    return current_ != nullptr ? current_ : Default();
+  }
+
+  // Create a standalone zoo for one of the ranks hosted in this process,
+  // which communicates through the given net
+  static Zoo* CreateLocal(NetInterface* net);
+  // Let Zoo::Get() return this zoo in the calling thread
+  void BindThread() { current_ = this; }
 
   // Start all actors
   void Start(int* argc, char** argv);
@@ -27,6 +40,8 @@ public:
   void Stop(bool finalize_net);
 
   void Barrier();
+  // Starts the snapshots of the server tables of this rank, see MV_Snapshot
+  void Snapshot(const std::string& uri);
 
   void SendTo(const std::string& name, MessagePtr&);
   void Receive(MessagePtr& msg);
@@ -34,6 +49,8 @@ public:
   int rank() const;
   int size() const;
 
+  NetInterface* net_util() const;
+
   inline int worker_rank() const { return nodes_[rank()].worker_id; }
   inline int server_rank() const { return nodes_[rank()].server_id; }
 
@@ -65,6 +82,7 @@ public:
 private:
   // private constructor
   Zoo();
+  static Zoo* Default() { static Zoo zoo; return &zoo; }
   void RegisterNode();
   void FinishTrain();
   void StartPS();
@@ -82,6 +100,14 @@ private:
 
   int num_workers_;
   int num_servers_;
+
+  // whether Start shares the process wide async log sink, see Log::StartAsync
+  bool log_async_;
+
+  // exports the Dashboard, see MetricsReporter::FromFlags
+  std::unique_ptr<MetricsReporter> metrics_;
+
+  static thread_local Zoo* current_;
 };
 
 }  // namespace multiverso
@@ -8,6 +8,7 @@
 #include "multiverso/message.h"
 #include "multiverso/util/log.h"
 #include "multiverso/util/mt_queue.h"
+#include "multiverso/util/tracer.h"
 #include "multiverso/zoo.h"
 
 namespace multiverso {
@@ -21,7 +22,12 @@ Actor::Actor(const std::string& name) : name_(name) {
 Actor::~Actor() {}
 
 void Actor::Start() {
-  thread_.reset(new std::thread(&Actor::Main, this));
+  Zoo* zoo = Zoo::Get();
+  thread_.reset(new std::thread([this, zoo]() {
+    zoo->BindThread();
+    if (Tracer::enabled()) Tracer::SetThreadName(name_);
+    Main();
+  }));
   pthread_setname_np(thread_->native_handle(), name_.c_str());
 
   while (!is_working_) {
@@ -30,7 +36,7 @@ void Actor::Start() {
 }
 
 void Actor::Stop() {
-  while (!mailbox_->Empty()) { ; }
+  mailbox_->WaitEmpty();
   is_working_ = false;
   mailbox_->Exit();
   thread_->join();
@@ -41,14 +47,16 @@ void Actor::Receive(MessagePtr& msg) { mailbox_->Push(msg); }
 void Actor::Main() {
   is_working_ = true;
   MessagePtr msg;
-  while (mailbox_->Pop(msg)) {
-    if (handlers_.find(msg->type()) != handlers_.end()) {
-      handlers_[msg->type()](msg);
-    } else if (handlers_.find(MsgType::Default) != handlers_.end()) {
-      handlers_[MsgType::Default](msg);
-    } else {
-      Log::Fatal("Unexpected msg type\n");
-    }
+  while (mailbox_->Pop(msg)) Dispatch(msg);
+}
+
+void Actor::Dispatch(MessagePtr& msg) {
+  if (handlers_.find(msg->type()) != handlers_.end()) {
+    handlers_[msg->type()](msg);
+  } else if (handlers_.find(MsgType::Default) != handlers_.end()) {
+    handlers_[MsgType::Default](msg);
+  } else {
+    Log::Fatal("Unexpected msg type\n");
   }
 }
 
@@ -40,6 +40,11 @@ void Blob::operator=(const Blob& rhs) {
   if (rhs.size() != 0) {
     Allocator::Get()->Refer(rhs.data_);
   }
+  // release the memory held before, after referring rhs in case of self
+  // assignment
+  if (this->data_ != nullptr) {
+    Allocator::Get()->Free(this->data_);
+  }
   this->data_ = rhs.data_;
   this->size_ = rhs.size_;
 }
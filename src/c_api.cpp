@@ -46,9 +46,19 @@ void MV_AddArrayTable(TableHandler handler, float* data, int size) {
   worker->Add(data, size);
 }
 
-void MV_AddAsyncArrayTable(TableHandler handler, float* data, int size) {
+int MV_GetAsyncArrayTable(TableHandler handler, float* data, int size) {
   auto worker = reinterpret_cast<multiverso::ArrayWorker<float>*>(handler);
-  worker->AddAsync(data, size);
+  return worker->GetAsync(data, size);
+}
+
+int MV_AddAsyncArrayTable(TableHandler handler, float* data, int size) {
+  auto worker = reinterpret_cast<multiverso::ArrayWorker<float>*>(handler);
+  return worker->AddAsync(data, size);
+}
+
+void MV_WaitArrayTable(TableHandler handler, int id) {
+  auto worker = reinterpret_cast<multiverso::ArrayWorker<float>*>(handler);
+  worker->Wait(id);
 }
 
 
@@ -67,9 +77,14 @@ void MV_AddMatrixTableAll(TableHandler handler, float* data, int size) {
   worker->Add(data, size);
 }
 
-void MV_AddAsyncMatrixTableAll(TableHandler handler, float* data, int size) {
+int MV_GetAsyncMatrixTableAll(TableHandler handler, float* data, int size) {
+  auto worker = reinterpret_cast<multiverso::MatrixWorkerTable<float>*>(handler);
+  return worker->GetAsync(data, size);
+}
+
+int MV_AddAsyncMatrixTableAll(TableHandler handler, float* data, int size) {
   auto worker = reinterpret_cast<multiverso::MatrixWorkerTable<float>*>(handler);
-  worker->AddAsync(data, size);
+  return worker->AddAsync(data, size);
 }
 
 void MV_GetMatrixTableByRows(TableHandler handler, float* data, int size,
@@ -84,10 +99,21 @@ void MV_AddMatrixTableByRows(TableHandler handler, float* data, int size,
   worker->Add(data, size, row_ids, row_ids_n);
 }
 
-void MV_AddAsyncMatrixTableByRows(TableHandler handler, float* data, int size,
+int MV_GetAsyncMatrixTableByRows(TableHandler handler, float* data, int size,
+                             int row_ids[], int row_ids_n) {
+  auto worker = reinterpret_cast<multiverso::MatrixWorkerTable<float>*>(handler);
+  return worker->GetAsync(data, size, row_ids, row_ids_n);
+}
+
+int MV_AddAsyncMatrixTableByRows(TableHandler handler, float* data, int size,
                              int row_ids[], int row_ids_n) {
   auto worker = reinterpret_cast<multiverso::MatrixWorkerTable<float>*>(handler);
-  worker->AddAsync(data, size, row_ids, row_ids_n);
+  return worker->AddAsync(data, size, row_ids, row_ids_n);
+}
+
+void MV_WaitMatrixTable(TableHandler handler, int id) {
+  auto worker = reinterpret_cast<multiverso::MatrixWorkerTable<float>*>(handler);
+  worker->Wait(id);
 }
 
 }
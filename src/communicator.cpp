@@ -1,12 +1,18 @@
 #include "multiverso/communicator.h"
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <thread>
+#include <unordered_map>
 
+#include "multiverso/dashboard.h"
 #include "multiverso/zoo.h"
 #include "multiverso/net.h"
 #include "multiverso/util/log.h"
 #include "multiverso/util/mt_queue.h"
+#include "multiverso/util/poller.h"
+#include "multiverso/util/tracer.h"
 
 namespace multiverso {
 
@@ -28,10 +34,40 @@ bool to_controler(MsgType type) {
 
 }  // namespace message
 
+namespace {
+
+// Counter of the messages sent or received with the given type, or for
+// the given table. The counters are cached by each thread to keep the
+// Dashboard lock off the net path.
+Counter* NetCounter(bool sent, bool table, int id) {
+  thread_local std::unordered_map<int64_t, Counter*> counters;
+  int64_t key = (static_cast<int64_t>(sent) << 33) |
+    (static_cast<int64_t>(table) << 32) | static_cast<uint32_t>(id);
+  Counter*& counter = counters[key];
+  if (counter == nullptr) {
+    counter = Dashboard::GetCounter(std::string(sent ? "NET_SEND" : "NET_RECV") +
+      (table ? "[table " + std::to_string(id) + "]" : "[" + MsgTypeName(id) + "]"));
+  }
+  return counter;
+}
+
+// Messages and bytes by type, and by table for table requests and replies
+void CountMessage(bool sent, MessagePtr& msg) {
+  size_t bytes = Message::kHeaderSize;
+  for (auto& blob : msg->data()) bytes += blob.size();
+  int type = static_cast<int>(msg->type());
+  NetCounter(sent, false, type)->Add(bytes);
+  if (type >= MsgType::Reply_Add && type <= MsgType::Request_Add && type != 0) {
+    NetCounter(sent, true, msg->table_id())->Add(bytes);
+  }
+}
+
+}  // namespace
+
 Communicator::Communicator() : Actor(actor::kCommunicator) {
   RegisterHandler(MsgType::Default, std::bind(
     &Communicator::ProcessMessage, this, std::placeholders::_1));
-  net_util_ = NetInterface::Get();
+  net_util_ = Zoo::Get()->net_util();
 }
 
 Communicator::~Communicator() { }
@@ -41,26 +77,40 @@ void Communicator::Main() {
 
   switch (net_util_->thread_level_support()) {
   case NetThreadLevel::THREAD_MULTIPLE: {
-    recv_thread_.reset(new std::thread(&Communicator::Communicate, this));
+    Zoo* zoo = Zoo::Get();
+    recv_thread_.reset(new std::thread([this, zoo]() {
+      zoo->BindThread();
+      if (Tracer::enabled()) Tracer::SetThreadName("communicator recv");
+      Communicate();
+    }));
     Actor::Main();
     recv_thread_->join();
     break;
   }
   case NetThreadLevel::THREAD_SERIALIZED: {
     MessagePtr msg;
+    AdaptivePoller poller;
+    // Only local messages can wake the loop up, the net is polled again
+    // at least every poll_wait_ms milliseconds
+    auto wait = [this](int timeout_ms) { mailbox_->Wait(timeout_ms); };
     while (mailbox_->Alive()) {
+      bool progress = false;
       // Try pop and Send
       if (mailbox_->TryPop(msg)) {
         ProcessMessage(msg);
+        progress = true;
       } 
       // Probe and Recv
-      size_t size = net_util_->Recv(&msg) > 0;
-      if (size > 0) {
+      if (net_util_->Recv(&msg) > 0) {
+        CountMessage(false, msg);
         LocalForward(msg);
+        progress = true;
       }
       CHECK(msg.get() == nullptr);
-      net_util_->Send(msg);
+      if (net_util_->Send(msg) > 0) progress = true;
+      poller.Poll(progress, wait);
     }
+    MV_LOG_DEBUG("Comm poll: %s\n", poller.info_string().c_str());
     break;
   }
   default:
@@ -70,6 +120,8 @@ void Communicator::Main() {
 
 void Communicator::ProcessMessage(MessagePtr& msg) {
   if (msg->dst() != net_util_->rank()) {
+    CountMessage(true, msg);
+    TraceScope trace(msg->trace_id(), "Communicator::Send");
     net_util_->Send(msg);
     return;
   }
@@ -77,23 +129,29 @@ void Communicator::ProcessMessage(MessagePtr& msg) {
 }
 
 void Communicator::Communicate() {
+  AdaptivePoller poller;
+  auto wait = [this](int timeout_ms) { net_util_->Poll(timeout_ms); };
   while (is_working_) {
     MessagePtr msg(new Message());
     int size = net_util_->Recv(&msg);
-    if (size == -1) {
-      continue;
-    }
     if (size > 0) {
       // a message received
       CHECK(msg->dst() == Zoo::Get()->rank());
+      CountMessage(false, msg);
       LocalForward(msg);
     }
+    poller.Poll(size > 0, wait);
   }
-  Log::Debug("Comm recv thread exit\n");
+  Log::Debug("Comm recv thread exit, poll: %s\n",
+             poller.info_string().c_str());
 }
 
 void Communicator::LocalForward(MessagePtr& msg) {
   CHECK(msg->dst() == Zoo::Get()->rank());
+  if (msg->trace_id() != 0 && msg->src() != msg->dst()) {
+    int64_t now = Tracer::Now();
+    Tracer::Span(msg->trace_id(), "Communicator::Recv", now, now);
+  }
   if (message::to_server(msg->type())) {
     SendTo(actor::kServer, msg);
   } else if (message::to_worker(msg->type())) {
@@ -1,5 +1,6 @@
 #include "multiverso/dashboard.h"
 
+#include <cmath>
 #include <map>
 #include <sstream>
 #include <string>
@@ -9,8 +10,17 @@
 namespace multiverso {
 
 std::map<std::string, Monitor*> Dashboard::record_;
+std::map<std::string, std::unique_ptr<Counter>> Dashboard::counters_;
+std::map<std::string, std::unique_ptr<Gauge>> Dashboard::gauges_;
 std::mutex Dashboard::m_;
 
+namespace {
+
+// window of the rates of Display
+const double kDisplayRateSeconds = 60;
+
+}  // namespace
+
 void Dashboard::AddMonitor(const std::string& name, Monitor* monitor) {
   std::lock_guard<std::mutex> l(m_);
   CHECK(record_[name] == nullptr);
@@ -23,29 +33,276 @@ void Dashboard::RemoveMonitor(const std::string& name) {
   record_.erase(name);
 }
 
+Counter* Dashboard::GetCounter(const std::string& name) {
+  std::lock_guard<std::mutex> l(m_);
+  std::unique_ptr<Counter>& counter = counters_[name];
+  if (counter == nullptr) counter.reset(new Counter(name));
+  return counter.get();
+}
+
+Gauge* Dashboard::GetGauge(const std::string& name) {
+  std::lock_guard<std::mutex> l(m_);
+  std::unique_ptr<Gauge>& gauge = gauges_[name];
+  if (gauge == nullptr) gauge.reset(new Gauge(name));
+  return gauge.get();
+}
+
 std::string Dashboard::Watch(const std::string& name) {
   std::lock_guard<std::mutex> l(m_);
   std::string result;
-  if (record_.find(name) == record_.end()) return result;
-  Monitor* monitor = record_[name];
-  CHECK_NOTNULL(monitor);
-  return monitor->info_string();
+  if (record_.find(name) != record_.end()) {
+    Monitor* monitor = record_[name];
+    CHECK_NOTNULL(monitor);
+    return monitor->info_string();
+  }
+  if (counters_.find(name) != counters_.end()) {
+    return counters_[name]->info_string();
+  }
+  if (gauges_.find(name) != gauges_.end()) {
+    return gauges_[name]->info_string();
+  }
+  return result;
 }
 
-std::string Monitor::info_string() const {
-  std::ostringstream oss;
-  oss << "[" << name_ << "] "
-      << " count = " << count_
-      << " elapse = " << elapse_ << "ms"
-      << " average = " << average() << "ms";
-  return oss.str();
+void Dashboard::Sample() {
+  std::lock_guard<std::mutex> l(m_);
+  for (auto& it : record_) it.second->Sample();
+  for (auto& it : counters_) it.second->Sample();
+}
+
+const int DashboardSnapshot::kNumQuantiles;
+const double DashboardSnapshot::kQuantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+void Dashboard::Snapshot(double rate_seconds, DashboardSnapshot* snapshot) {
+  Sample();
+  std::lock_guard<std::mutex> l(m_);
+  snapshot->monitors.clear();
+  for (auto& it : record_) {
+    Histogram latency = it.second->histogram();
+    DashboardSnapshot::MonitorValues values;
+    values.name = it.first;
+    values.count = latency.count();
+    values.elapse = latency.sum() / 1e6;
+    for (int i = 0; i < DashboardSnapshot::kNumQuantiles; ++i) {
+      values.quantiles[i] =
+        latency.Quantile(DashboardSnapshot::kQuantiles[i]) / 1e6;
+    }
+    values.rate = it.second->rate(rate_seconds);
+    snapshot->monitors.push_back(values);
+  }
+  snapshot->counters.clear();
+  for (auto& it : counters_) {
+    DashboardSnapshot::CounterValues values;
+    values.name = it.first;
+    values.count = it.second->count();
+    values.sum = it.second->sum();
+    values.count_rate = it.second->count_rate(rate_seconds);
+    values.sum_rate = it.second->sum_rate(rate_seconds);
+    snapshot->counters.push_back(values);
+  }
+  snapshot->gauges.clear();
+  for (auto& it : gauges_) {
+    snapshot->gauges.push_back(std::make_pair(it.first, it.second->value()));
+  }
 }
 
 void Dashboard::Display() {
+  Sample();
   std::lock_guard<std::mutex> l(m_);
   Log::Info("--------------Show dashboard monitor information--------------\n");
   for (auto& it : record_) Log::Info("%s\n", it.second->info_string().c_str());
+  for (auto& it : counters_) {
+    Log::Info("%s\n", it.second->info_string().c_str());
+  }
+  for (auto& it : gauges_) Log::Info("%s\n", it.second->info_string().c_str());
   Log::Info("--------------------------------------------------------------\n");
 }
 
+const int Histogram::kNumBuckets;
+
+int Histogram::Bucket(uint64_t value) {
+  if (value < 8) return static_cast<int>(value);
+  // exponent = floor(log2(value))
+  int exponent = 0;
+  for (int shift = 32; shift > 0; shift /= 2) {
+    if (value >> (exponent + shift)) exponent += shift;
+  }
+  int bucket = (exponent - 2) * 8 +
+    static_cast<int>((value >> (exponent - 3)) & 7);
+  return bucket < kNumBuckets ? bucket : kNumBuckets - 1;
+}
+
+uint64_t Histogram::Lower(int bucket) {
+  if (bucket < 8) return bucket;
+  return static_cast<uint64_t>(8 + bucket % 8) << (bucket / 8 - 1);
+}
+
+uint64_t Histogram::Upper(int bucket) {
+  if (bucket < 8) return bucket + 1;
+  return static_cast<uint64_t>(9 + bucket % 8) << (bucket / 8 - 1);
+}
+
+double Histogram::Quantile(double q) const {
+  if (count_ == 0) return 0;
+  double rank = std::ceil(q * count_);
+  if (rank < 1) rank = 1;
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < kNumBuckets; ++bucket) {
+    seen += buckets_[bucket];
+    if (seen >= rank) {
+      return bucket < 8 ? static_cast<double>(bucket) :
+        (static_cast<double>(Lower(bucket)) + Upper(bucket)) / 2;
+    }
+  }
+  return static_cast<double>(Lower(kNumBuckets - 1));
+}
+
+const size_t RateWindow::kMaxSamples;
+
+RateWindow::RateWindow() {
+  samples_.push_back(std::make_pair(0.0, 0.0));
+}
+
+void RateWindow::Sample(double total) {
+  samples_.push_back(std::make_pair(timer_.elapse() / 1000, total));
+  if (samples_.size() > kMaxSamples) samples_.pop_front();
+}
+
+double RateWindow::rate(double seconds) const {
+  const std::pair<double, double>& newest = samples_.back();
+  // the newest sample at least seconds older, or the oldest one
+  size_t from = 0;
+  for (size_t i = samples_.size(); i-- > 0; ) {
+    if (samples_[i].first <= newest.first - seconds) {
+      from = i;
+      break;
+    }
+  }
+  const std::pair<double, double>& oldest = samples_[from];
+  if (newest.first <= oldest.first) return 0;
+  return (newest.second - oldest.second) / (newest.first - oldest.first);
+}
+
+namespace dashboard {
+
+void*& LocalShard(int id) {
+  thread_local std::vector<void*> shards;
+  if (static_cast<size_t>(id) >= shards.size()) shards.resize(id + 1, nullptr);
+  return shards[id];
+}
+
+int NewShardsId() {
+  static std::atomic<int> next_id(0);
+  return next_id++;
+}
+
+}  // namespace dashboard
+
+Monitor::Monitor(const std::string& name) : name_(name) {
+  Dashboard::AddMonitor(name_, this);
+}
+
+Histogram Monitor::histogram() const {
+  Histogram result;
+  shards_.ForEach([&result](const Shard& shard) {
+    for (int i = 0; i < Histogram::kNumBuckets; ++i) {
+      uint64_t count = shard.buckets[i].load(std::memory_order_relaxed);
+      if (count != 0) result.Add(i, count);
+    }
+    result.AddSum(shard.sum.load(std::memory_order_relaxed));
+  });
+  return result;
+}
+
+double Monitor::elapse() const {
+  uint64_t sum = 0;
+  shards_.ForEach([&sum](const Shard& shard) {
+    sum += shard.sum.load(std::memory_order_relaxed);
+  });
+  return sum / 1e6;
+}
+
+int Monitor::count() const {
+  uint64_t count = 0;
+  shards_.ForEach([&count](const Shard& shard) {
+    count += shard.count.load(std::memory_order_relaxed);
+  });
+  return static_cast<int>(count);
+}
+
+double Monitor::average() const { return elapse() / count(); }
+
+double Monitor::rate(double seconds) const {
+  std::lock_guard<std::mutex> l(m_);
+  return calls_.rate(seconds);
+}
+
+void Monitor::Sample() {
+  std::lock_guard<std::mutex> l(m_);
+  calls_.Sample(count());
+}
+
+std::string Monitor::info_string() const {
+  Histogram latency = histogram();
+  std::ostringstream oss;
+  oss << "[" << name_ << "] "
+      << " count = " << latency.count()
+      << " elapse = " << latency.sum() / 1e6 << "ms"
+      << " average = " << latency.sum() / 1e6 / latency.count() << "ms"
+      << " p50 = " << latency.Quantile(0.5) / 1e6 << "ms"
+      << " p90 = " << latency.Quantile(0.9) / 1e6 << "ms"
+      << " p99 = " << latency.Quantile(0.99) / 1e6 << "ms"
+      << " p999 = " << latency.Quantile(0.999) / 1e6 << "ms"
+      << " rate = " << rate(kDisplayRateSeconds) << "/s";
+  return oss.str();
+}
+
+uint64_t Counter::count() const {
+  uint64_t count = 0;
+  shards_.ForEach([&count](const Shard& shard) {
+    count += shard.count.load(std::memory_order_relaxed);
+  });
+  return count;
+}
+
+uint64_t Counter::sum() const {
+  uint64_t sum = 0;
+  shards_.ForEach([&sum](const Shard& shard) {
+    sum += shard.sum.load(std::memory_order_relaxed);
+  });
+  return sum;
+}
+
+double Counter::count_rate(double seconds) const {
+  std::lock_guard<std::mutex> l(m_);
+  return counts_.rate(seconds);
+}
+
+double Counter::sum_rate(double seconds) const {
+  std::lock_guard<std::mutex> l(m_);
+  return sums_.rate(seconds);
+}
+
+void Counter::Sample() {
+  std::lock_guard<std::mutex> l(m_);
+  counts_.Sample(static_cast<double>(count()));
+  sums_.Sample(static_cast<double>(sum()));
+}
+
+std::string Counter::info_string() const {
+  std::ostringstream oss;
+  oss << "[" << name_ << "] "
+      << " count = " << count()
+      << " sum = " << sum()
+      << " count rate = " << count_rate(kDisplayRateSeconds) << "/s"
+      << " sum rate = " << sum_rate(kDisplayRateSeconds) << "/s";
+  return oss.str();
+}
+
+std::string Gauge::info_string() const {
+  std::ostringstream oss;
+  oss << "[" << name_ << "] " << " value = " << value();
+  return oss.str();
+}
+
 }  // namespace multiverso
@@ -0,0 +1,107 @@
+#include "multiverso/io/buffered_stream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace multiverso {
+
+BufferedStream::BufferedStream(Stream* stream, size_t block_size, bool async)
+  : stream_(stream), block_size_(block_size), async_(async),
+    current_(&blocks_[0]), pos_(0), end_(false), written_(false) {
+  CHECK_NOTNULL(stream_);
+  CHECK(block_size_ > 0);
+  for (auto& block : blocks_) {
+    block.data.resize(block_size_);
+    block.size = 0;
+  }
+}
+
+BufferedStream::~BufferedStream() {
+  Flush();
+  // stops the read ahead before the stream is gone
+  read_ahead_.reset();
+  delete stream_;
+}
+
+void BufferedStream::Write(const void *buf, size_t size) {
+  const char* in = static_cast<const char*>(buf);
+  written_ = true;
+  while (size > 0) {
+    Block& block = blocks_[0];
+    size_t count = std::min(size, block_size_ - block.size);
+    memcpy(block.data.data() + block.size, in, count);
+    block.size += count;
+    in += count;
+    size -= count;
+    if (block.size == block_size_) WriteBlock();
+  }
+}
+
+size_t BufferedStream::Read(void *buf, size_t size) {
+  char* out = static_cast<char*>(buf);
+  size_t total = 0;
+  while (total < size) {
+    if (pos_ == current_->size && !NextBlock()) break;
+    size_t count = std::min(size - total, current_->size - pos_);
+    memcpy(out + total, current_->data.data() + pos_, count);
+    pos_ += count;
+    total += count;
+  }
+  return total;
+}
+
+bool BufferedStream::Good() { return stream_->Good(); }
+
+void BufferedStream::Flush() {
+  if (!written_) return;
+  if (blocks_[0].size > 0) WriteBlock();
+  WaitWrite();
+}
+
+void BufferedStream::Fill(Block* block) {
+  block->size = 0;
+  while (block->size < block_size_) {
+    size_t read = stream_->Read(block->data.data() + block->size,
+                                block_size_ - block->size);
+    if (read == 0) break;
+    block->size += read;
+  }
+}
+
+bool BufferedStream::NextBlock() {
+  if (end_) return false;
+  if (async_) {
+    if (read_ahead_ == nullptr) {
+      read_ahead_.reset(new ASyncBuffer<Block>(&blocks_[0], &blocks_[1],
+        [this](Block* block) { Fill(block); }));
+    }
+    current_ = read_ahead_->Get();
+  } else {
+    Fill(current_);
+  }
+  pos_ = 0;
+  end_ = current_->size < block_size_;
+  return current_->size > 0;
+}
+
+void BufferedStream::WriteBlock() {
+  if (!async_) {
+    stream_->Write(blocks_[0].data.data(), blocks_[0].size);
+    blocks_[0].size = 0;
+    return;
+  }
+  WaitWrite();
+  std::swap(blocks_[0], blocks_[1]);
+  blocks_[0].size = 0;
+  Block* block = &blocks_[1];
+  write_behind_ = std::async(std::launch::async, [this, block]() {
+    stream_->Write(block->data.data(), block->size);
+  });
+}
+
+void BufferedStream::WaitWrite() {
+  if (write_behind_.valid()) write_behind_.get();
+}
+
+}  // namespace multiverso
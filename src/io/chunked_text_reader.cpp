@@ -0,0 +1,135 @@
+#include "multiverso/io/chunked_text_reader.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "multiverso/util/mt_queue.h"
+
+namespace multiverso {
+
+void TextChunk::Split() {
+  lines_.clear();
+  const char* begin = data_.get();
+  const char* end = begin + size_;
+  while (begin < end) {
+    const char* newline = static_cast<const char*>(
+      memchr(begin, '\n', end - begin));
+    LineView line = { begin, static_cast<size_t>(
+      (newline != nullptr ? newline : end) - begin) };
+    lines_.push_back(line);
+    begin += line.size + 1;
+  }
+}
+
+const size_t ChunkedTextReader::kDefaultChunkSize;
+
+ChunkedTextReader::ChunkedTextReader(const URI& uri, size_t chunk_size)
+  : ChunkedTextReader(StreamFactory::GetStream(uri, FileOpenMode::Read),
+                      chunk_size) {}
+
+ChunkedTextReader::ChunkedTextReader(Stream* stream, size_t chunk_size)
+  : stream_(stream), chunk_size_(chunk_size), num_chunks_(0) {
+  CHECK_NOTNULL(stream_);
+  CHECK(chunk_size_ > 0);
+}
+
+ChunkedTextReader::~ChunkedTextReader() {
+  delete stream_;
+}
+
+std::unique_ptr<TextChunk> ChunkedTextReader::NextChunk() {
+  std::unique_ptr<TextChunk> chunk;
+  if (ReadChunk(&chunk)) chunk->Split();
+  return chunk;
+}
+
+void ChunkedTextReader::ForEachChunk(
+    const std::function<void(const TextChunk&)>& func, int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = std::max(1, static_cast<int>(
+      std::thread::hardware_concurrency()));
+  }
+  const size_t max_pending = 2 * static_cast<size_t>(num_threads);
+  MtQueue<std::unique_ptr<TextChunk>> chunks;
+  std::mutex m;
+  std::condition_variable done;
+  size_t pending = 0;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&]() {
+      std::unique_ptr<TextChunk> chunk;
+      while (chunks.Pop(chunk)) {
+        chunk->Split();
+        func(*chunk);
+        chunk.reset();
+        std::lock_guard<std::mutex> l(m);
+        --pending;
+        done.notify_one();
+      }
+    });
+  }
+  // the chunks are read on this thread while the others parse
+  std::unique_ptr<TextChunk> chunk;
+  while (ReadChunk(&chunk)) {
+    {
+      std::unique_lock<std::mutex> l(m);
+      done.wait(l, [&]() { return pending < max_pending; });
+      ++pending;
+    }
+    chunks.Push(chunk);
+  }
+  chunks.Exit();
+  for (auto& thread : threads) thread.join();
+}
+
+bool ChunkedTextReader::ReadChunk(std::unique_ptr<TextChunk>* chunk) {
+  size_t capacity = carry_.size() + chunk_size_;
+  std::unique_ptr<char[]> data(new char[capacity]);
+  size_t size = carry_.size();
+  if (size > 0) memcpy(data.get(), carry_.data(), size);
+  size_t end = 0;  // after the last '\n'
+  while (true) {
+    size_t want = capacity - size;
+    size_t read = ReadFull(data.get() + size, want);
+    // the bytes before size have no '\n'
+    for (size_t i = size + read; i > size; --i) {
+      if (data[i - 1] == '\n') {
+        end = i;
+        break;
+      }
+    }
+    size += read;
+    if (end > 0 || read < want) break;
+    // a line longer than the buffer
+    capacity *= 2;
+    std::unique_ptr<char[]> larger(new char[capacity]);
+    memcpy(larger.get(), data.get(), size);
+    data.swap(larger);
+  }
+  // the last line of the input may have no '\n'
+  if (end == 0) end = size;
+  if (end == 0) return false;
+  carry_.assign(data.get() + end, data.get() + size);
+
+  chunk->reset(new TextChunk());
+  (*chunk)->index_ = num_chunks_++;
+  (*chunk)->data_ = std::move(data);
+  (*chunk)->size_ = end;
+  return true;
+}
+
+size_t ChunkedTextReader::ReadFull(char* buf, size_t size) {
+  size_t total = 0;
+  while (total < size) {
+    size_t read = stream_->Read(buf + total, size - total);
+    if (read == 0) break;
+    total += read;
+  }
+  return total;
+}
+
+}  // namespace multiverso
@@ -1,23 +1,48 @@
 #include "multiverso/io/io.h"
+#include "multiverso/io/buffered_stream.h"
 #include "multiverso/io/hdfs_stream.h"
 #include "multiverso/io/local_stream.h"
+#include "multiverso/io/mmap_stream.h"
 
 
 namespace multiverso {
 
+namespace {
+
+// size with an optional K, M or G suffix
+size_t ParseSize(const std::string& value) {
+  size_t pos = 0;
+  size_t size = std::stoull(value, &pos);
+  std::string suffix = value.substr(pos);
+  if (suffix == "K" || suffix == "k") return size << 10;
+  if (suffix == "M" || suffix == "m") return size << 20;
+  if (suffix == "G" || suffix == "g") return size << 30;
+  CHECK(suffix.empty());
+  return size;
+}
+
+}  // namespace
+
 Stream* StreamFactory::GetStream(const URI& uri,
   FileOpenMode mode) {
   std::string addr = uri.scheme + "://" + uri.host;
   if (instances_.find(addr) == instances_.end()) {
     if (uri.scheme == std::string("file"))
       instances_[addr] = std::shared_ptr<StreamFactory>(new LocalStreamFactory(uri.host));
+    else if (uri.scheme == std::string("mmap"))
+      instances_[addr] = std::shared_ptr<StreamFactory>(new MmapStreamFactory(uri.host));
 #ifdef MULTIVERSO_USE_HDFS
     else if (uri.scheme == std::string("hdfs"))
       instances_[addr] = std::shared_ptr<StreamFactory>(new HDFSStreamFactory(uri.host));
 #endif
     else Log::Error("Can not support the StreamFactory '%s'\n", uri.scheme.c_str());
   }
-  return instances_[addr]->Open(uri, mode);
+  Stream* stream = instances_[addr]->Open(uri, mode);
+  auto buffer = uri.options.find("buffer");
+  if (buffer == uri.options.end()) return stream;
+  auto async = uri.options.find("async");
+  return new BufferedStream(stream, ParseSize(buffer->second),
+    async == uri.options.end() || async->second != "false");
 }
 
 std::map<std::string, std::shared_ptr<StreamFactory> > StreamFactory::instances_;
@@ -31,21 +56,21 @@ TextReader::TextReader(const URI& uri, size_t buf_size) {
 }
 
 size_t TextReader::GetLine(std::string &line) {
-    line.clear();
-    bool isEnd = false;
-    while (!isEnd) {
-        while(pos_ < length_) {
-            char & c = buf_[pos_++];
-            if (c == '\n') {
-                isEnd = true;
-                break;
-            } else {
-                line += c;
-            }
-        }
-        if (isEnd || LoadBuffer() == 0)  break; 
+  line.clear();
+  while (true) {
+    const char* begin = buf_ + pos_;
+    const char* end = static_cast<const char*>(
+      memchr(begin, '\n', length_ - pos_));
+    if (end != nullptr) {
+      line.append(begin, end);
+      pos_ = end - buf_ + 1;
+      break;
     }
-    return line.size();
+    line.append(begin, length_ - pos_);
+    pos_ = length_;
+    if (LoadBuffer() == 0) break;
+  }
+  return line.size();
 }
 
 size_t TextReader::LoadBuffer() {
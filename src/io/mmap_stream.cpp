@@ -0,0 +1,140 @@
+#include "multiverso/io/mmap_stream.h"
+
+#include <cstring>
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <Windows.h>
+#else
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+#endif
+
+namespace multiverso {
+
+MemoryMap::MemoryMap(const std::string& path, bool is_private)
+  : good_(false), is_private_(is_private), data_(nullptr), size_(0) {
+#ifdef _MSC_VER
+  file_ = mapping_ = nullptr;
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    Log::Error("Failed to open MemoryMap %s\n", path.c_str());
+    return;
+  }
+  file_ = file;
+  LARGE_INTEGER size;
+  GetFileSizeEx(file, &size);
+  size_ = static_cast<size_t>(size.QuadPart);
+  good_ = true;
+  if (size_ == 0) return;
+  mapping_ = CreateFileMappingA(file, nullptr,
+    is_private_ ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_ != nullptr) {
+    data_ = static_cast<char*>(MapViewOfFile(mapping_,
+      is_private_ ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+  }
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    Log::Error("Failed to open MemoryMap %s, errno = %d\n",
+      path.c_str(), errno);
+    return;
+  }
+  struct stat st;
+  fstat(fd, &st);
+  size_ = static_cast<size_t>(st.st_size);
+  good_ = true;
+  if (size_ > 0) {
+    void* data = mmap(nullptr, size_,
+      is_private_ ? PROT_READ | PROT_WRITE : PROT_READ,
+      is_private_ ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    data_ = data == MAP_FAILED ? nullptr : static_cast<char*>(data);
+  }
+  // the mapping keeps the file open
+  close(fd);
+#endif
+  if (size_ > 0 && data_ == nullptr) {
+    good_ = false;
+    Log::Error("Failed to map %s of %zu bytes\n", path.c_str(), size_);
+  }
+}
+
+MemoryMap::~MemoryMap() {
+#ifdef _MSC_VER
+  if (data_ != nullptr) UnmapViewOfFile(data_);
+  if (mapping_ != nullptr) CloseHandle(mapping_);
+  if (file_ != nullptr) CloseHandle(file_);
+#else
+  if (data_ != nullptr) munmap(data_, size_);
+#endif
+}
+
+void MemoryMap::Advise(const std::string& advice, size_t offset,
+                       size_t size) {
+  if (data_ == nullptr || offset >= size_) return;
+#ifndef _MSC_VER
+  int flag = MADV_NORMAL;
+  if (advice == "normal") flag = MADV_NORMAL;
+  else if (advice == "sequential") flag = MADV_SEQUENTIAL;
+  else if (advice == "random") flag = MADV_RANDOM;
+  else if (advice == "willneed") flag = MADV_WILLNEED;
+  else if (advice == "dontneed") flag = MADV_DONTNEED;
+  else Log::Fatal("Unknown madvise advice %s\n", advice.c_str());
+  // madvise takes a page aligned address
+  size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t begin = offset / page * page;
+  size_t end = std::min(size_, offset + std::min(size, size_ - offset));
+  if (madvise(data_ + begin, end - begin, flag) != 0) {
+    Log::Error("madvise %s failed, errno = %d\n", advice.c_str(), errno);
+  }
+#endif
+}
+
+MmapStream::MmapStream(const URI& uri, FileOpenMode mode) : pos_(0) {
+  if (mode != FileOpenMode::Read && mode != FileOpenMode::BinaryRead) {
+    Log::Fatal("MmapStream %s can only be read\n", uri.path.c_str());
+  }
+  auto is_private = uri.options.find("private");
+  map_ = std::make_shared<MemoryMap>(uri.host + uri.name,
+    is_private != uri.options.end() && is_private->second == "true");
+  auto advice = uri.options.find("advice");
+  if (advice != uri.options.end()) {
+    map_->Advise(advice->second, 0, map_->size());
+  }
+}
+
+void MmapStream::Write(const void*, size_t) {
+  Log::Fatal("MmapStream can not be written\n");
+}
+
+size_t MmapStream::Read(void *buf, size_t size) {
+  size = std::min(size, this->size() - pos_);
+  if (size > 0) memcpy(buf, data() + pos_, size);
+  pos_ += size;
+  return size;
+}
+
+bool MmapStream::Good() { return map_->good(); }
+
+void MmapStream::Seek(size_t position) {
+  CHECK(position <= size());
+  pos_ = position;
+}
+
+char* MmapStream::Next(size_t size) {
+  if (size > this->size() - pos_) return nullptr;
+  char* next = data() + pos_;
+  pos_ += size;
+  return next;
+}
+
+Stream* MmapStreamFactory::Open(const URI& uri, FileOpenMode mode) {
+  return new MmapStream(uri, mode);
+}
+
+}  // namespace multiverso
@@ -1,7 +1,11 @@
 #include "multiverso/multiverso.h"
 
+#include <thread>
+#include <vector>
+
 #include "multiverso/dashboard.h"
 #include "multiverso/net.h"
+#include "multiverso/net/local_net.h"
 #include "multiverso/zoo.h"
 #include "multiverso/table_factory.h"
 #include "multiverso/util/configure.h"
@@ -19,6 +23,8 @@ void MV_ShutDown(bool finalize_net) {
 
 void MV_Barrier() { Zoo::Get()->Barrier(); }
 
+void MV_Snapshot(const std::string& uri) { Zoo::Get()->Snapshot(uri); }
+
 int  MV_Rank() { return Zoo::Get()->rank(); }
 
 int  MV_Size() { return Zoo::Get()->size(); }
@@ -56,15 +62,36 @@ void MV_Aggregate(ElemType* data, int size) {
 }
 
 int  MV_NetBind(int rank, char* endpoint) {
-  return NetInterface::Get()->Bind(rank, endpoint);
+  return Zoo::Get()->net_util()->Bind(rank, endpoint);
 }
 
 int  MV_NetConnect(int* ranks, char* endpoints[], int size) {
-  return NetInterface::Get()->Connect(ranks, endpoints, size);
+  return Zoo::Get()->net_util()->Connect(ranks, endpoints, size);
 }
 
 void MV_NetFinalize() {
-  NetInterface::Get()->Finalize();
+  Zoo::Get()->net_util()->Finalize();
+}
+
+void MV_RunLocal(int num_ranks, const std::function<void(int)>& func) {
+  CHECK(num_ranks > 0);
+  LocalNetWrapper::Mailboxes mailboxes;
+  for (int i = 0; i < num_ranks; ++i) {
+    mailboxes.emplace_back(new MtQueue<MessagePtr>());
+  }
+  LocalReducer reducer(num_ranks);
+  std::vector<std::thread> ranks;
+  for (int i = 0; i < num_ranks; ++i) {
+    ranks.emplace_back([&mailboxes, &reducer, &func, i]() {
+      LocalNetWrapper net(i, &mailboxes, &reducer);
+      std::unique_ptr<Zoo> zoo(Zoo::CreateLocal(&net));
+      zoo->BindThread();
+      MV_Init();
+      func(i);
+      MV_ShutDown();
+    });
+  }
+  for (auto& rank : ranks) rank.join();
 }
 
 template void MV_Aggregate<char>(char*, int);
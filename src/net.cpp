@@ -1,31 +1,62 @@
 #include "multiverso/net.h"
 
+#include <chrono>
 #include <limits>
 #include <mutex>
+#include <thread>
 #include "multiverso/message.h"
+#include "multiverso/util/configure.h"
 #include "multiverso/util/log.h"
+#include "multiverso/zoo.h"
 
+#include "multiverso/net/local_net.h"
 #include "multiverso/net/zmq_net.h"
 #include "multiverso/net/mpi_net.h"
+#include "multiverso/net/shm_net.h"
 
 namespace multiverso {
 
+#ifndef _WIN32
+MV_DEFINE_bool(shm_net, false, "exchange messages among ranks on the same "
+                               "host through shared memory");
+MV_DEFINE_int(shm_buffer_size, 4, "size(MB) of each shared memory ring, "
+                                  "one ring per ordered pair of local ranks");
+#endif
+
 NetInterface* NetInterface::Get() {
 #ifdef MULTIVERSO_USE_ZMQ
   static ZMQNetWrapper net_impl;
-  return &net_impl;
 #else
 // #ifdef MULTIVERSO_USE_MPI
   // Use MPI by default
   static MPINetWrapper net_impl;
-  return &net_impl;
 // #endif
 #endif
+#ifndef _WIN32
+  if (MV_CONFIG_shm_net) {
+    static ShmNetWrapper shm_impl(&net_impl, MV_CONFIG_shm_buffer_size);
+    return &shm_impl;
+  }
+#endif
+  return &net_impl;
+}
+
+bool NetInterface::Poll(int timeout_ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+  return true;
 }
 
 namespace net {
 template <typename Typename>
 void Allreduce(Typename* data, size_t elem_count) {
+  // among the ranks of MV_RunLocal, if called from one of them
+  LocalNetWrapper* local =
+    dynamic_cast<LocalNetWrapper*>(Zoo::Get()->net_util());
+  if (local != nullptr) {
+    CHECK(local->active());
+    local->Allreduce(data, elem_count);
+    return;
+  }
 #ifdef MULTIVERSO_USE_MPI
   CHECK(NetInterface::Get()->active());
   MPINetWrapper::Allreduce(data, elem_count);
@@ -1,6 +1,7 @@
 #include "multiverso/server.h"
 
 #include <algorithm>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -8,10 +9,13 @@
 #include "multiverso/actor.h"
 #include "multiverso/dashboard.h"
 #include "multiverso/multiverso.h"
+#include "multiverso/server_scheduler.h"
 #include "multiverso/table_interface.h"
 #include "multiverso/io/io.h"
+#include "multiverso/table/snapshot.h"
 #include "multiverso/util/configure.h"
 #include "multiverso/util/mt_queue.h"
+#include "multiverso/util/tracer.h"
 #include "multiverso/zoo.h"
 
 
@@ -20,12 +24,56 @@ namespace multiverso {
 MV_DEFINE_bool(sync, false, "sync or async");
 MV_DEFINE_int(basync_clock, 3, "max tolerance clock for bounded async server");
 MV_DEFINE_int(backup_worker_ratio, 0, "ratio% of backup workers, set 20 means 20%");
+MV_DEFINE_string(server_schedule, "fifo", "order the server serves queued "
+  "requests: fifo, get_first, weighted or round_robin");
+MV_DEFINE_int(server_get_weight, 4,
+  "gets served for each add when both are queued, for the weighted schedule");
+
+// time the requests are held by the start of a snapshot
+REGISTER_MONITOR(SERVER_SNAPSHOT_STALL)
+
+namespace {
+
+// uri of the snapshot of a table shard, the ids are appended to the path
+std::string SnapshotPath(const std::string& uri, int server_id,
+                         int table_id) {
+  std::size_t query = uri.find('?');
+  std::string path = uri.substr(0, query) + "." + std::to_string(server_id) +
+    "." + std::to_string(table_id);
+  if (query != std::string::npos) path += uri.substr(query);
+  return path;
+}
+
+}  // namespace
 
 Server::Server() : Actor(actor::kServer) {
   RegisterHandler(MsgType::Request_Get, std::bind(
     &Server::ProcessGet, this, std::placeholders::_1));
   RegisterHandler(MsgType::Request_Add, std::bind(
     &Server::ProcessAdd, this, std::placeholders::_1));
+  RegisterHandler(MsgType::Server_Snapshot, std::bind(
+    &Server::ProcessSnapshot, this, std::placeholders::_1));
+  scheduler_.reset(new ServerScheduler(MV_CONFIG_server_schedule,
+    Zoo::Get()->size(), MV_CONFIG_server_get_weight));
+}
+
+Server::~Server() {}
+
+void Server::Main() {
+  is_working_ = true;
+  MessagePtr msg;
+  while (true) {
+    if (scheduler_->Empty()) {
+      if (!mailbox_->Pop(msg)) break;
+      scheduler_->Push(msg);
+    }
+    // Let the scheduler see all the arrived requests before picking one
+    while (mailbox_->TryPop(msg)) scheduler_->Push(msg);
+    CHECK(scheduler_->Pop(&msg));
+    Dispatch(msg);
+  }
+  while (scheduler_->Pop(&msg)) Dispatch(msg);
+  WaitSnapshots();
 }
 
 int Server::RegisterTable(ServerTable* server_table) {
@@ -36,6 +84,7 @@ int Server::RegisterTable(ServerTable* server_table) {
 
 void Server::ProcessGet(MessagePtr& msg) {
   MONITOR_BEGIN(SERVER_PROCESS_GET);
+  TraceScope trace(msg->trace_id(), "Server::ProcessGet");
   if (msg->data().size() != 0) {
     MessagePtr reply(msg->CreateReplyMessage());
     int table_id = msg->table_id();
@@ -48,6 +97,7 @@ void Server::ProcessGet(MessagePtr& msg) {
 
 void Server::ProcessAdd(MessagePtr& msg) {
   MONITOR_BEGIN(SERVER_PROCESS_ADD)
+  TraceScope trace(msg->trace_id(), "Server::ProcessAdd");
   if (msg->data().size() != 0) {
     MessagePtr reply(msg->CreateReplyMessage());
     int table_id = msg->table_id();
@@ -59,6 +109,33 @@ void Server::ProcessAdd(MessagePtr& msg) {
 }
 
 
+void Server::ProcessSnapshot(MessagePtr& msg) {
+  Timer timer;
+  // the previous snapshots are written before the tables are frozen again
+  WaitSnapshots();
+  std::string uri(msg->data()[0].data(), msg->data()[0].size());
+  int server_id = Zoo::Get()->server_rank();
+  for (int i = 0; i < static_cast<int>(store_.size()); ++i) {
+    Stream* stream = StreamFactory::GetStream(
+      URI(SnapshotPath(uri, server_id, i)), FileOpenMode::BinaryWrite);
+    std::shared_ptr<Snapshot> snapshot = store_[i]->StartSnapshot(stream);
+    if (snapshot != nullptr) snapshots_.push_back(snapshot);
+  }
+  double stall = timer.elapse();
+  g_SERVER_SNAPSHOT_STALL_monitor.Record(stall);
+  Log::Info("[Snapshot] Server = %d, %d tables to %s, stalled %.3f ms, "
+    "%d written in the background\n", server_id,
+    static_cast<int>(store_.size()), uri.c_str(), stall,
+    static_cast<int>(snapshots_.size()));
+  MessagePtr reply(msg->CreateReplyMessage());
+  Zoo::Get()->Receive(reply);
+}
+
+void Server::WaitSnapshots() {
+  for (auto& snapshot : snapshots_) snapshot->Wait();
+  snapshots_.clear();
+}
+
 // The Sync Server implement logic to support Sync SGD training
 // The implementation assumes all the workers will call same number
 // of Add and/or Get requests
@@ -278,13 +355,15 @@ private:
   MtQueue<MessagePtr> msg_cache_;
 
   void PrintClock() {
+    // the clocks are only formatted when they are logged
+    if (!MV_LOG_ENABLED(Debug)) return;
     std::string rank = "Rank :" + std::to_string(MV_Rank());
     std::string os = rank + " clock, local: ";
     for (auto i : clocks_) { 
       if (i == std::numeric_limits<int>::max()) os += "-1 ";
       else os += std::to_string(i) + " ";
     }
-    Log::Debug("%s\n", os.c_str());
+    Log::Write(LogLevel::Debug, "%s\n", os.c_str());
   }
 
   void ProcessQueue() {
@@ -0,0 +1,97 @@
+#include "multiverso/server_scheduler.h"
+
+#include <limits>
+
+#include "multiverso/dashboard.h"
+#include "multiverso/util/log.h"
+#include "multiverso/util/tracer.h"
+
+namespace multiverso {
+
+// time requests wait in the server queue
+REGISTER_MONITOR(SERVER_GET_QUEUE_WAIT)
+REGISTER_MONITOR(SERVER_ADD_QUEUE_WAIT)
+
+ServerScheduler::ServerScheduler(const std::string& policy, int num_sources,
+                                 int get_weight)
+  : queues_(num_sources), size_(0), seq_(0), next_(0),
+    get_weight_(get_weight), credit_(get_weight),
+    depth_(Dashboard::GetGauge("SERVER_QUEUE_DEPTH")) {
+  if (policy == "fifo") policy_ = kFifo;
+  else if (policy == "get_first") policy_ = kGetFirst;
+  else if (policy == "weighted") policy_ = kWeighted;
+  else if (policy == "round_robin") policy_ = kRoundRobin;
+  else Log::Fatal("Unknown server schedule %s\n", policy.c_str());
+}
+
+void ServerScheduler::Push(MessagePtr& msg) {
+  int src = msg->src();
+  CHECK(src >= 0 && src < static_cast<int>(queues_.size()));
+  queues_[src].push_back(Entry());
+  Entry& entry = queues_[src].back();
+  entry.msg = std::move(msg);
+  entry.seq = seq_++;
+  if (entry.msg->trace_id() != 0) entry.queued = Tracer::Now();
+  depth_->Set(++size_);
+}
+
+bool ServerScheduler::Pop(MessagePtr* msg) {
+  if (size_ == 0) return false;
+  int src = -1;
+  switch (policy_) {
+  case kFifo: src = Oldest(kAny); break;
+  case kGetFirst:
+    src = Oldest(kGet);
+    if (src < 0) src = Oldest(kAny);
+    break;
+  case kWeighted: {
+    int get = Oldest(kGet), other = Oldest(kOther);
+    if (get >= 0 && (credit_ > 0 || other < 0)) {
+      src = get;
+      --credit_;
+    } else {
+      src = other;
+      credit_ = get_weight_;
+    }
+    break;
+  }
+  case kRoundRobin:
+    while (queues_[next_ % queues_.size()].empty()) ++next_;
+    src = static_cast<int>(next_++ % queues_.size());
+    break;
+  }
+  CHECK(src >= 0);
+  Entry& entry = queues_[src].front();
+  double wait = entry.timer.elapse();
+  if (entry.msg->type() == MsgType::Request_Get) {
+    g_SERVER_GET_QUEUE_WAIT_monitor.Record(wait);
+  } else if (entry.msg->type() == MsgType::Request_Add) {
+    g_SERVER_ADD_QUEUE_WAIT_monitor.Record(wait);
+  }
+  if (entry.msg->trace_id() != 0) {
+    Tracer::Span(entry.msg->trace_id(), "Server::Queue", entry.queued,
+                 Tracer::Now());
+  }
+  *msg = std::move(entry.msg);
+  queues_[src].pop_front();
+  depth_->Set(--size_);
+  return true;
+}
+
+int ServerScheduler::Oldest(Kind kind) const {
+  int src = -1;
+  long long seq = std::numeric_limits<long long>::max();
+  for (int i = 0; i < static_cast<int>(queues_.size()); ++i) {
+    if (queues_[i].empty()) continue;
+    const Entry& head = queues_[i].front();
+    bool is_get = head.msg->type() == MsgType::Request_Get;
+    if ((kind == kGet && !is_get) || (kind == kOther && is_get)) continue;
+    if (head.seq < seq) {
+      seq = head.seq;
+      src = i;
+    }
+  }
+  return src;
+}
+
+}  // namespace multiverso
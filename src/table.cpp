@@ -3,13 +3,19 @@
 #include <mutex>
 
 #include "multiverso/dashboard.h"
+#include "multiverso/io/io.h"
 #include "multiverso/updater/updater.h"
+#include "multiverso/util/configure.h"
 #include "multiverso/util/log.h"
+#include "multiverso/util/tracer.h"
 #include "multiverso/util/waiter.h"
 #include "multiverso/zoo.h"
 
 namespace multiverso {
 
+MV_DEFINE_int(aggregate_adds, 0, "server tables sum the row deltas of up to "
+  "this many Adds before applying them, 0 applies each Add at once");
+
 WorkerTable::WorkerTable() {
   msg_id_ = 0;
   m_ = new std::mutex();
@@ -21,7 +27,13 @@ WorkerTable::~WorkerTable() {
 }
 
 ServerTable::ServerTable() {
-  Zoo::Get()->RegisterTable(this);
+  table_id_ = Zoo::Get()->RegisterTable(this);
+}
+
+std::shared_ptr<Snapshot> ServerTable::StartSnapshot(Stream* s) {
+  Store(s);
+  delete s;
+  return nullptr;
 }
 
 void WorkerTable::Get(Blob keys, 
@@ -40,13 +52,16 @@ void WorkerTable::Add(Blob keys, Blob values,
 
 int WorkerTable::GetAsync(Blob keys,
                           const GetOption* option) {
+  int trace = Tracer::NewTrace();
   m_->lock();
   int id = msg_id_++;
   waitings_.push_back(new Waiter());
+  if (trace != 0) traces_[id] = std::make_pair(trace, Tracer::Now());
   m_->unlock();
   MessagePtr msg(new Message());
   msg->set_src(Zoo::Get()->rank());
   msg->set_type(MsgType::Request_Get);
+  msg->set_trace_id(trace);
   msg->set_msg_id(id);
   msg->set_table_id(table_id_);
   msg->Push(keys);
@@ -61,13 +76,16 @@ int WorkerTable::GetAsync(Blob keys,
 
 int WorkerTable::AddAsync(Blob keys, Blob values,
                           const AddOption* option) {
+  int trace = Tracer::NewTrace();
   m_->lock();
   int id = msg_id_++;
   waitings_.push_back(new Waiter());
+  if (trace != 0) traces_[id] = std::make_pair(trace, Tracer::Now());
   m_->unlock();
   MessagePtr msg(new Message());
   msg->set_src(Zoo::Get()->rank());
   msg->set_type(MsgType::Request_Add);
+  msg->set_trace_id(trace);
   msg->set_msg_id(id);
   msg->set_table_id(table_id_);
   msg->Push(keys);
@@ -107,6 +125,14 @@ void WorkerTable::Notify(int id) {
   m_->lock();
   CHECK_NOTNULL(waitings_[id]);
   waitings_[id]->Notify();
+  auto trace = traces_.find(id);
+  // also ends the traces of the requests which are never waited
+  if (trace != traces_.end() && waitings_[id]->done()) {
+    // from the request to its last reply, on the worker thread
+    Tracer::Span(trace->second.first, "WorkerTable::Request",
+                 trace->second.second, Tracer::Now());
+    traces_.erase(trace);
+  }
   m_->unlock();
 }
 
@@ -2,11 +2,14 @@
 
 #include "multiverso/io/io.h"
 #include "multiverso/multiverso.h"
+#include "multiverso/util/configure.h"
 #include "multiverso/util/log.h"
 #include "multiverso/updater/updater.h"
 
 namespace multiverso {
 
+MV_DECLARE_int(aggregate_adds);
+
 template <typename T>
 ArrayWorker<T>::ArrayWorker(size_t size) : WorkerTable(), size_(size) {
   num_server_ = MV_NumServers();
@@ -17,7 +20,7 @@ ArrayWorker<T>::ArrayWorker(size_t size) : WorkerTable(), size_(size) {
     server_offsets_.push_back(i * length); // may not balance
   }
   server_offsets_.push_back(size_);
-  Log::Debug("worker %d create arrayTable with %d elements.\n", MV_Rank(), size);
+  MV_LOG_DEBUG("worker %d create arrayTable with %d elements.\n", MV_Rank(), size);
 }
 
 template <typename T>
@@ -32,7 +35,7 @@ void ArrayWorker<T>::Get(T* data, size_t size) {
   integer_t all_key = -1;
   Blob whole_table(&all_key, sizeof(integer_t));
   WorkerTable::Get(whole_table);
-  Log::Debug("worker %d getting all parameters.\n", MV_Rank());
+  MV_LOG_DEBUG("worker %d getting all parameters.\n", MV_Rank());
 }
 
 template <typename T>
@@ -52,7 +55,7 @@ void ArrayWorker<T>::Add(T* data, size_t size, const AddOption* option) {
   Blob key(&all_key, sizeof(integer_t));
   Blob val(data, sizeof(T) * size);
   WorkerTable::Add(key, val, option);
-  Log::Debug("worker %d adding parameters with size of %d.\n", MV_Rank(), size);
+  MV_LOG_DEBUG("worker %d adding parameters with size of %d.\n", MV_Rank(), size);
 }
 
 template <typename T>
@@ -103,7 +106,12 @@ ArrayServer<T>::ArrayServer(size_t size) : ServerTable() {
   }
   storage_.resize(size_);
   updater_ = Updater<T>::GetUpdater(size_);
-  Log::Debug("server %d create arrayTable with %d elements of %d elements.\n", 
+  buffered_adds_ = 0;
+  if (MV_CONFIG_aggregate_adds > 0 && updater_->linear()) {
+    delta_buffer_.reset(new DeltaBuffer<T>(1, size_));
+    delta_buffer_->ExportMergeRatio(table_id());
+  }
+  MV_LOG_DEBUG("server %d create arrayTable with %d elements of %d elements.\n", 
              server_id_, size_, size);
 }
 
@@ -122,16 +130,33 @@ void ArrayServer<T>::ProcessAdd(const std::vector<Blob>& data) {
   CHECK(keys.size<integer_t>() == 1 && keys.As<integer_t>() == -1); 
   CHECK(values.size() == size_ * sizeof(T));
   T* pvalues = reinterpret_cast<T*>(values.data());
-  updater_->Update(size_, storage_.data(), pvalues, option);
+  if (delta_buffer_ != nullptr) {
+    delta_buffer_->Add(0, pvalues);
+    if (++buffered_adds_ >= MV_CONFIG_aggregate_adds) Flush();
+  } else {
+    storage_.Touch(0, size_);
+    updater_->Update(size_, storage_.data(), pvalues, option);
+  }
   delete option;
 }
 
+template <typename T>
+void ArrayServer<T>::Flush() {
+  buffered_adds_ = 0;
+  if (delta_buffer_ == nullptr) return;
+  delta_buffer_->FlushAll([this](size_t, T* delta) {
+    storage_.Touch(0, size_);
+    updater_->Update(size_, storage_.data(), delta);
+  });
+}
+
 template <typename T>
 void ArrayServer<T>::ProcessGet(const std::vector<Blob>& data,
   std::vector<Blob>* result) {
   size_t key_size = data[0].size<integer_t>();
   CHECK(key_size == 1 && data[0].As<integer_t>() == -1); 
   // Always request the whole table
+  Flush();
   Blob key(sizeof(integer_t)); key.As<integer_t>() = server_id_;
   Blob values(sizeof(T) * size_);
   T* pvalues = reinterpret_cast<T*>(values.data());
@@ -142,12 +167,20 @@ void ArrayServer<T>::ProcessGet(const std::vector<Blob>& data,
 
 template <typename T>
 void ArrayServer<T>::Store(Stream* s) {
+  Flush();
   s->Write(storage_.data(), storage_.size() * sizeof(T));
 }
 
+template <typename T>
+std::shared_ptr<Snapshot> ArrayServer<T>::StartSnapshot(Stream* s) {
+  Flush();
+  return storage_.StartSnapshot(s);
+}
+
 template <typename T>
 void ArrayServer<T>::Load(Stream* s) {
-  s->Read(storage_.data(), storage_.size() * sizeof(T));
+  Flush();
+  storage_.Load(s);
 }
 
 MV_INSTANTIATE_CLASS_WITH_BASE_TYPE(ArrayWorker);
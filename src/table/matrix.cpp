@@ -46,10 +46,10 @@ WorkerTable(), num_row_(num_row), num_col_(num_col), is_sparse_(is_sparse) {
   // using actual number of servers
   num_server_ = static_cast<int>(server_offsets_.size() - 1);
 
-  Log::Debug("[Init] worker =  %d, type = matrixTable, size =  [ %d x %d ].\n",
+  MV_LOG_DEBUG("[Init] worker =  %d, type = matrixTable, size =  [ %d x %d ].\n",
     MV_Rank(), num_row, num_col);
   if (is_sparse_)
-    Log::Debug("[Init] worker = %d, with sparse updater.\n", MV_Rank());
+    MV_LOG_DEBUG("[Init] worker = %d, with sparse updater.\n", MV_Rank());
   row_index_ = new T*[num_row_ + 1];
 }
 
@@ -89,7 +89,7 @@ void MatrixWorker<T>::Get(integer_t row_id, T* data, size_t size,
   }
 
   WorkerTable::Get(Blob(&row_id, sizeof(integer_t)), option);
-  Log::Debug("[Get] worker = %d, #row = %d\n", MV_Rank(), row_id);
+  MV_LOG_DEBUG("[Get] worker = %d, #row = %d\n", MV_Rank(), row_id);
 
   if (is_option_mine) delete option;
 }
@@ -113,7 +113,7 @@ void MatrixWorker<T>::Get(const std::vector<integer_t>& row_ids,
   }
 
   WorkerTable::Get(Blob(row_ids.data(), sizeof(integer_t)* row_ids.size()), option);
-  Log::Debug("[Get] worker = %d, #rows_set = %d / %d\n",
+  MV_LOG_DEBUG("[Get] worker = %d, #rows_set = %d / %d\n",
     MV_Rank(), row_ids.size(), num_row_);
 
   if (is_option_mine) delete option;
@@ -138,7 +138,7 @@ void MatrixWorker<T>::Get(T* data, size_t size, integer_t* row_ids,
   }
 
   WorkerTable::Get(ids_blob, option);
-  Log::Debug("[Get] worker = %d, #rows_set = %d / %d\n",
+  MV_LOG_DEBUG("[Get] worker = %d, #rows_set = %d / %d\n",
     MV_Rank(), row_ids_size, num_row_);
   if (is_option_mine) delete option;
 }
@@ -170,7 +170,7 @@ void MatrixWorker<T>::Add(T* data, size_t size, const AddOption* option) {
     }
 
     WorkerTable::Add(ids_blob, data_blob, option);
-    Log::Debug("[Add] Sparse: worker = %d, #rows_set = %d / %d\n",
+    MV_LOG_DEBUG("[Add] Sparse: worker = %d, #rows_set = %d / %d\n",
       MV_Rank(), row_ids.size(), num_row_);
     if (is_option_mine) delete option;
 
@@ -196,7 +196,7 @@ void MatrixWorker<T>::Add(integer_t row_id, T* data, size_t size,
   }
 
   WorkerTable::Add(ids_blob, data_blob, option);
-  Log::Debug("[Add] worker = %d, #row = %d\n", MV_Rank(), row_id);
+  MV_LOG_DEBUG("[Add] worker = %d, #row = %d\n", MV_Rank(), row_id);
   if (is_option_mine) delete option;
 }
 
@@ -221,7 +221,7 @@ void MatrixWorker<T>::Add(const std::vector<integer_t>& row_ids,
   }
 
   WorkerTable::Add(ids_blob, data_blob, option);
-  Log::Debug("[Add] worker = %d, #rows_set = %d / %d\n", MV_Rank(), row_ids.size(), num_row_);
+  MV_LOG_DEBUG("[Add] worker = %d, #rows_set = %d / %d\n", MV_Rank(), row_ids.size(), num_row_);
   if (is_option_mine) delete option;
 }
 
@@ -241,7 +241,7 @@ void MatrixWorker<T>::Add(T* data, size_t size, integer_t* row_ids,
   }
 
   WorkerTable::Add(ids_blob, data_blob, option);
-  Log::Debug("[Add] worker = %d, #rows_set = %d / %d\n", MV_Rank(), row_ids_size, num_row_);
+  MV_LOG_DEBUG("[Add] worker = %d, #rows_set = %d / %d\n", MV_Rank(), row_ids_size, num_row_);
   if (is_option_mine) delete option;
 }
 
@@ -400,7 +400,7 @@ MatrixServer<T>::MatrixServer(integer_t num_row, integer_t num_col,
   }
   my_num_row_ = size;
   storage_.resize(my_num_row_ * num_col);
-  updater_ = Updater<T>::GetUpdater(my_num_row_ * num_col);
+  updater_ = Updater<T>::GetUpdater(my_num_row_ * num_col, num_col);
   Log::Info("[Init] Server =  %d, type = matrixTable, size =  [ %d x %d ], total =  [ %d x %d ].\n",
     server_id_, size, num_col, num_row, num_col);
 
@@ -438,7 +438,7 @@ void MatrixServer<T>::ProcessAdd(const std::vector<Blob>& data) {
     size_t ssize = storage_.size();
     CHECK(ssize == data[1].size<T>());
     updater_->Update(ssize, storage_.data(), values, option);
-    Log::Debug("[ProcessAdd] Server = %d, adding all rows offset = %d, #rows = %d\n",
+    MV_LOG_DEBUG("[ProcessAdd] Server = %d, adding all rows offset = %d, #rows = %d\n",
       server_id_, row_offset_, ssize / num_col_);
   }
   else {
@@ -451,7 +451,7 @@ void MatrixServer<T>::ProcessAdd(const std::vector<Blob>& data) {
       updater_->Update(num_col_, storage_.data(), values + offset_v, option, offset_s);
       offset_v += num_col_;
     }
-    Log::Debug("[ProcessAdd] Server = %d, adding #rows = %d\n",
+    MV_LOG_DEBUG("[ProcessAdd] Server = %d, adding #rows = %d\n",
       server_id_, keys_size);
   }
   delete option;
@@ -493,7 +493,7 @@ void MatrixServer<T>::ProcessGet(const std::vector<Blob>& data,
     updater_->Access(storage_.size(), storage_.data(), pvalues);
     result->push_back(value);
     result->push_back(Blob(&server_id_, sizeof(int)));
-    Log::Debug("[ProcessGet] Server = %d, getting all rows offset = %d, #rows = %d\n",
+    MV_LOG_DEBUG("[ProcessGet] Server = %d, getting all rows offset = %d, #rows = %d\n",
       server_id_, row_offset_, storage_.size() / num_col_);
     return;
   }
@@ -507,7 +507,7 @@ void MatrixServer<T>::ProcessGet(const std::vector<Blob>& data,
     updater_->Access(num_col_, storage_.data(), vals + offset_v, offset_s);
     offset_v += num_col_;
   }
-  Log::Debug("[ProcessGet] Server = %d, getting row #rows = %d\n",
+  MV_LOG_DEBUG("[ProcessGet] Server = %d, getting row #rows = %d\n",
     server_id_, keys_size);
 
   delete option;
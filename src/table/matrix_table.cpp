@@ -1,24 +1,53 @@
 #include "multiverso/table/matrix_table.h"
 
+#include <algorithm>
+#include <cinttypes>
+#include <numeric>
+#include <unordered_set>
 #include <vector>
 
 #include "multiverso/io/io.h"
 #include "multiverso/multiverso.h"
+#include "multiverso/util/configure.h"
+#include "multiverso/util/key_codec.h"
 #include "multiverso/util/log.h"
 #include "multiverso/util/quantization_util.h"
 #include "multiverso/updater/updater.h"
 
 namespace multiverso {
 
+MV_DEFINE_int(matrix_parallel_rows, 1024, "matrix servers apply and gather "
+  "the rows of requests with at least this many rows in parallel");
+MV_DEFINE_int(matrix_server_threads, 4,
+  "#threads used by openMP for matrix servers to apply and gather rows");
+MV_DECLARE_int(aggregate_adds);
+
 template <typename T>
 MatrixWorkerTable<T>::MatrixWorkerTable(const MatrixTableOption<T>& option) :
-MatrixWorkerTable(option.num_row, option.num_col) {}
+MatrixWorkerTable(option.num_row, option.num_col) {
+  encode_keys_ = option.encode_keys;
+  delta_gets_ = option.delta_gets;
+  if (option.add_topk > 0) {
+    CHECK(option.add_bits == 0);
+    filter_.reset(new TopKFilter<T>(option.add_topk, num_col_,
+                                    option.add_topk_per_row));
+  } else if (option.add_bits > 0) {
+    filter_.reset(new OneBitsFilter<T>(num_col_, option.add_bits));
+  }
+  if (filter_ != nullptr) {
+    residual_.reset(new LazyState<T>(
+      static_cast<size_t>(num_row_) * num_col_, num_col_, 1));
+  }
+}
 
 template <typename T>
 MatrixWorkerTable<T>::MatrixWorkerTable(integer_t num_row, integer_t num_col) :
   WorkerTable(), num_row_(num_row), num_col_(num_col) {
   row_size_ = num_col * sizeof(T);
   get_reply_count_ = 0;
+  encode_keys_ = false;
+  delta_gets_ = false;
+  delta_buffer_ = nullptr;
 
   num_server_ = MV_NumServers();
   //  compute row offsets in all servers
@@ -43,8 +72,9 @@ MatrixWorkerTable<T>::MatrixWorkerTable(integer_t num_row, integer_t num_col) :
   }
   // using actual number of servers
   num_server_ = static_cast<int>(server_offsets_.size() - 1);
+  server_versions_.assign(num_server_, 0);
 
-  Log::Debug("[Init] worker =  %d, type = matrixTable, size =  [ %d x %d ].\n",
+  MV_LOG_DEBUG("[Init] worker =  %d, type = matrixTable, size =  [ %d x %d ].\n",
     MV_Rank(), num_row, num_col);
   row_index_ = new T*[num_row_ + 1];
 }
@@ -68,11 +98,14 @@ void MatrixWorkerTable<T>::Get(integer_t row_id, T* data, size_t size) {
   for (auto i = 0; i < num_row_ + 1; ++i) row_index_[i] = nullptr;
   if (row_id == -1) {
     row_index_[num_row_] = data;
+    if (delta_gets_) SetDeltaBuffer(data);
   } else {
     row_index_[row_id] = data;  // data_ = data;
   }
-  WorkerTable::Get(Blob(&row_id, sizeof(integer_t)));
-  Log::Debug("[Get] worker = %d, #row = %d\n", MV_Rank(), row_id);
+  GetOption option;
+  WorkerTable::Get(Blob(&row_id, sizeof(integer_t)),
+                   row_id == -1 && delta_gets_ ? &option : nullptr);
+  MV_LOG_DEBUG("[Get] worker = %d, #row = %d\n", MV_Rank(), row_id);
 }
 
 template <typename T>
@@ -86,7 +119,7 @@ void MatrixWorkerTable<T>::Get(const std::vector<integer_t>& row_ids,
     row_index_[row_ids[i]] = data_vec[i];
   }
   WorkerTable::Get(Blob(row_ids.data(), sizeof(integer_t)* row_ids.size()));
-  Log::Debug("[Get] worker = %d, #rows_set = %d\n", MV_Rank(), row_ids.size());
+  MV_LOG_DEBUG("[Get] worker = %d, #rows_set = %d\n", MV_Rank(), row_ids.size());
 }
 
 template <typename T>
@@ -99,7 +132,7 @@ void MatrixWorkerTable<T>::Get(T* data, size_t size, integer_t* row_ids,
   }
   Blob ids_blob(row_ids, sizeof(integer_t) * row_ids_size);
   WorkerTable::Get(ids_blob);
-  Log::Debug("[Get] worker = %d, #rows_set = %d\n", MV_Rank(), row_ids_size);
+  MV_LOG_DEBUG("[Get] worker = %d, #rows_set = %d\n", MV_Rank(), row_ids_size);
 }
 
 template <typename T>
@@ -116,7 +149,7 @@ void MatrixWorkerTable<T>::Add(integer_t row_id, T* data, size_t size,
   Blob ids_blob(&row_id, sizeof(integer_t));
   Blob data_blob(data, size * sizeof(T));
   WorkerTable::Add(ids_blob, data_blob, option);
-  Log::Debug("[Add] worker = %d, #row = %d\n", MV_Rank(), row_id);
+  MV_LOG_DEBUG("[Add] worker = %d, #row = %d\n", MV_Rank(), row_id);
 }
 
 template <typename T>
@@ -132,7 +165,7 @@ void MatrixWorkerTable<T>::Add(const std::vector<integer_t>& row_ids,
     memcpy(data_blob.data() + i * row_size_, data_vec[i], row_size_);
   }
   WorkerTable::Add(ids_blob, data_blob, option);
-  Log::Debug("[Add] worker = %d, #rows_set = %d\n", MV_Rank(), row_ids.size());
+  MV_LOG_DEBUG("[Add] worker = %d, #rows_set = %d\n", MV_Rank(), row_ids.size());
 }
 
 template <typename T>
@@ -143,7 +176,7 @@ void MatrixWorkerTable<T>::Add(T* data, size_t size, integer_t* row_ids,
   Blob ids_blob(row_ids, sizeof(integer_t) * row_ids_size);
   Blob data_blob(data, row_ids_size * row_size_);
   WorkerTable::Add(ids_blob, data_blob, option);
-  Log::Debug("[Add] worker = %d, #rows_set = %d\n", MV_Rank(), row_ids_size);
+  MV_LOG_DEBUG("[Add] worker = %d, #rows_set = %d\n", MV_Rank(), row_ids_size);
 }
 
 template <typename T>
@@ -159,10 +192,13 @@ int MatrixWorkerTable<T>::GetAsync(integer_t row_id, T* data, size_t size) {
   for (auto i = 0; i < num_row_ + 1; ++i) row_index_[i] = nullptr;
   if (row_id == -1) {
     row_index_[num_row_] = data;
+    if (delta_gets_) SetDeltaBuffer(data);
   } else {
     row_index_[row_id] = data;  // data_ = data;
   }
-  return WorkerTable::GetAsync(Blob(&row_id, sizeof(integer_t)));
+  GetOption option;
+  return WorkerTable::GetAsync(Blob(&row_id, sizeof(integer_t)),
+                               row_id == -1 && delta_gets_ ? &option : nullptr);
 }
 
 template <typename T>
@@ -231,9 +267,17 @@ int MatrixWorkerTable<T>::AddAsync(T* data, size_t size, integer_t* row_ids,
   return WorkerTable::AddAsync(ids_blob, data_blob, option);
 }
 
+template <typename T>
+void MatrixWorkerTable<T>::SetDeltaBuffer(T* data) {
+  if (data == delta_buffer_) return;
+  // the rows of the previous buffer aren't there, get all of them again
+  std::fill(server_versions_.begin(), server_versions_.end(), 0);
+  delta_buffer_ = data;
+}
+
 template <typename T>
 int MatrixWorkerTable<T>::Partition(const std::vector<Blob>& kv,
-  MsgType, std::unordered_map<int, std::vector<Blob>>* out) {
+  MsgType partition_type, std::unordered_map<int, std::vector<Blob>>* out) {
   CHECK(kv.size() == 1 || kv.size() == 2 || kv.size() == 3);
   CHECK_NOTNULL(out);
 
@@ -246,19 +290,32 @@ int MatrixWorkerTable<T>::Partition(const std::vector<Blob>& kv,
       int rank = MV_ServerIdToRank(i);
       (*out)[rank].push_back(kv[0]);
     }
-    if (kv.size() >= 2) {  // process add values
+    if (partition_type == MsgType::Request_Get) {
+      if (kv.size() == 2) {  // delta Get, each server gets its version
+        GetOption option(kv[1].data(), kv[1].size());
+        for (auto i = 0; i < num_server_; ++i) {
+          option.set_version(server_versions_[i]);
+          (*out)[MV_ServerIdToRank(i)].push_back(
+            Blob(option.data(), option.size()));
+        }
+      }
+      CHECK(get_reply_count_ == 0);
+      get_reply_count_ = static_cast<int>(out->size());
+    } else if (kv.size() >= 2) {  // process add values
       for (integer_t i = 0; i < num_server_; ++i){
         int rank = MV_ServerIdToRank(i);
         Blob blob(kv[1].data() + server_offsets_[i] * row_size_,
           (server_offsets_[i + 1] - server_offsets_[i]) * row_size_);
+        if (filter_ != nullptr) {
+          std::vector<integer_t> rows(server_offsets_[i + 1] - server_offsets_[i]);
+          std::iota(rows.begin(), rows.end(), server_offsets_[i]);
+          Compress(rows.data(), rows.size(), &blob);
+        }
         (*out)[rank].push_back(blob);
         if (kv.size() == 3) {  // update option blob
           (*out)[rank].push_back(kv[2]);
         }
       }
-    } else {
-      CHECK(get_reply_count_ == 0);
-      get_reply_count_ = static_cast<int>(out->size());
     }
     return static_cast<int>(out->size());
   }
@@ -300,6 +357,13 @@ int MatrixWorkerTable<T>::Partition(const std::vector<Blob>& kv,
   for (int i = 0; i < num_server_; ++i){
     int rank = MV_ServerIdToRank(i);
     if (count[i] != 0) {
+      if (filter_ != nullptr && kv.size() >= 2) {
+        std::vector<Blob>& blobs = (*out)[rank];
+        if (encode_keys_) SortKeys(&blobs);
+        Compress(reinterpret_cast<integer_t*>(blobs[0].data()),
+                 blobs[0].size<integer_t>(), &blobs[1]);
+      }
+      if (encode_keys_) EncodeKeys(&(*out)[rank]);
       if (kv.size() == 3) {// update option blob
         (*out)[rank].push_back(kv[2]);
       }
@@ -313,16 +377,96 @@ int MatrixWorkerTable<T>::Partition(const std::vector<Blob>& kv,
   return static_cast<int>(out->size());
 }
 
+template <typename T>
+void MatrixWorkerTable<T>::EncodeKeys(std::vector<Blob>* blobs) {
+  SortKeys(blobs);
+  Blob keys_blob = (*blobs)[0];
+  (*blobs)[0] = key_codec::EncodeKeys(
+    reinterpret_cast<integer_t*>(keys_blob.data()), keys_blob.size<integer_t>());
+}
+
+template <typename T>
+void MatrixWorkerTable<T>::SortKeys(std::vector<Blob>* blobs) {
+  Blob keys_blob = (*blobs)[0];
+  size_t keys_size = keys_blob.size<integer_t>();
+  integer_t* keys = reinterpret_cast<integer_t*>(keys_blob.data());
+  if (!std::is_sorted(keys, keys + keys_size)) {
+    std::vector<size_t> order(keys_size);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+      [keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+    Blob sorted_keys(keys_blob.size());
+    for (size_t i = 0; i < keys_size; ++i) {
+      sorted_keys.As<integer_t>(i) = keys[order[i]];
+    }
+    if (blobs->size() >= 2) {  // move rows of add values along with keys
+      Blob values = (*blobs)[1];
+      Blob sorted_values(values.size());
+      for (size_t i = 0; i < keys_size; ++i) {
+        memcpy(sorted_values.data() + i * row_size_,
+          values.data() + order[i] * row_size_, row_size_);
+      }
+      (*blobs)[1] = sorted_values;
+    }
+    (*blobs)[0] = sorted_keys;
+  }
+}
+
+template <typename T>
+void MatrixWorkerTable<T>::Compress(const integer_t* rows, size_t num_rows,
+                                    Blob* values) {
+  CHECK(values->size() == num_rows * row_size_);
+  const T* delta = reinterpret_cast<const T*>(values->data());
+  std::vector<T*> residual(num_rows);
+  // a row Added twice sums both deltas in its residual and is sent once,
+  // its other copies send zeros
+  std::unordered_set<integer_t> seen;
+  size_t num_copies = 0;
+  for (size_t i = 0; i < num_rows; ++i) {
+    if (!seen.insert(rows[i]).second) ++num_copies;
+  }
+  std::vector<T> zeros(num_copies * num_col_, T(0));
+  seen.clear();
+  num_copies = 0;
+  for (size_t i = 0; i < num_rows; ++i) {
+    T* row = residual_->page(rows[i]);
+    const T* row_delta = delta + i * num_col_;
+    for (integer_t j = 0; j < num_col_; ++j) row[j] += row_delta[j];
+    residual[i] = seen.insert(rows[i]).second ? row :
+      zeros.data() + num_copies++ * num_col_;
+  }
+  *values = filter_->Encode(residual.data(), num_rows);
+}
+
 template <typename T>
 void MatrixWorkerTable<T>::ProcessReplyGet(std::vector<Blob>& reply_data) {
-  CHECK(reply_data.size() == 2 || reply_data.size() == 3); //3 for get all rows
+  // 3 for get all rows, 2 or 4 for delta get of all rows
+  CHECK(reply_data.size() >= 2 && reply_data.size() <= 4);
 
-  size_t keys_size = reply_data[0].size<integer_t>();
-  integer_t* keys = reinterpret_cast<integer_t*>(reply_data[0].data());
+  size_t keys_size;
+  const integer_t* keys = key_codec::DecodeKeys(reply_data[0], &keys_size,
+                                                &keys_buffer_);
   T* data = reinterpret_cast<T*>(reply_data[1].data());
 
-  //get all rows, only happen in T*
-  if (keys_size == 1 && keys[0] == -1) {
+  bool get_all = keys_size == 1 && keys[0] == -1;
+  if (get_all && reply_data.size() != 3) {
+    // delta get: -1, server id and version, then the changed rows if any
+    CHECK_NOTNULL(row_index_[num_row_]);
+    size_t server_id = static_cast<size_t>(reply_data[1].As<int64_t>(0));
+    CHECK(server_id < server_offsets_.size() - 1);
+    server_versions_[server_id] = reply_data[1].As<int64_t>(1);
+    if (reply_data.size() == 4) {
+      keys = key_codec::DecodeKeys(reply_data[2], &keys_size, &keys_buffer_);
+      data = reinterpret_cast<T*>(reply_data[3].data());
+      CHECK(reply_data[3].size() == keys_size * row_size_);
+      for (size_t i = 0; i < keys_size; ++i) {
+        memcpy(row_index_[num_row_] + static_cast<size_t>(keys[i]) * num_col_,
+          data + i * num_col_, row_size_);
+      }
+    }
+    MV_LOG_DEBUG("[ProcessReplyGet] worker = %d, server = %zu, #changed rows = %zu\n",
+      MV_Rank(), server_id, reply_data.size() == 4 ? keys_size : 0);
+  } else if (get_all) {  //get all rows, only happen in T*
     int server_id = reply_data[2].As<int>();
     CHECK_NOTNULL(row_index_[num_row_]);
     CHECK(server_id < server_offsets_.size() - 1);
@@ -342,7 +486,10 @@ void MatrixWorkerTable<T>::ProcessReplyGet(std::vector<Blob>& reply_data) {
 
 template <typename T>
 MatrixServerTable<T>::MatrixServerTable(const MatrixTableOption<T>& option) :
-MatrixServerTable(option.num_row, option.num_col, option.min_value, option.max_value) {}
+MatrixServerTable(option.num_row, option.num_col, option.min_value, option.max_value) {
+  compressed_adds_ = option.add_topk > 0 || option.add_bits > 0;
+  if (option.delta_gets) row_versions_.assign(my_num_row_, version_);
+}
 
 template <typename T>
 MatrixServerTable<T>::MatrixServerTable(integer_t num_row, integer_t num_col) :
@@ -363,8 +510,20 @@ MatrixServerTable<T>::MatrixServerTable(integer_t num_row, integer_t num_col) :
   }
   my_num_row_ = size;
   storage_.resize(my_num_row_ * num_col);
-  updater_ = Updater<T>::GetUpdater(my_num_row_ * num_col);
-  Log::Debug("[Init] Server =  %d, type = matrixTable, size =  [ %d x %d ], total =  [ %d x %d ].\n",
+  updater_ = Updater<T>::GetUpdater(my_num_row_ * num_col, num_col);
+  buffered_adds_ = 0;
+  compressed_adds_ = false;
+  version_ = 1;
+  if (MV_CONFIG_aggregate_adds > 0) {
+    if (updater_->linear()) {
+      delta_buffer_.reset(new DeltaBuffer<T>(my_num_row_, num_col));
+      delta_buffer_->ExportMergeRatio(table_id());
+    } else {
+      Log::Info("[Init] Server = %d, updater is not linear, Adds are not "
+        "aggregated\n", server_id_);
+    }
+  }
+  MV_LOG_DEBUG("[Init] Server =  %d, type = matrixTable, size =  [ %d x %d ], total =  [ %d x %d ].\n",
     server_id_, size, num_col, num_row, num_col);
 }
 
@@ -386,55 +545,137 @@ MatrixServerTable<T>::MatrixServerTable(num_row, num_col) {
 template <typename T>
 void MatrixServerTable<T>::ProcessAdd(const std::vector<Blob>& data) {
   CHECK(data.size() == 2 || data.size() == 3);
-  size_t keys_size = data[0].size<integer_t>();
-  integer_t* keys = reinterpret_cast<integer_t*>(data[0].data());
+  size_t keys_size;
+  const integer_t* keys = key_codec::DecodeKeys(data[0], &keys_size,
+                                                &keys_buffer_);
   T *values = reinterpret_cast<T*>(data[1].data());
+  size_t num_values = data[1].size<T>();
+  if (compressed_adds_) {
+    num_values = DeltaFilter<T>::DecodedSize(data[1]);
+    decoded_.resize(num_values);
+    DeltaFilter<T>::Decode(data[1], decoded_.data());
+    values = decoded_.data();
+  }
   AddOption* option = nullptr;
   if (data.size() == 3) {
     option = new AddOption(data[2].data(), data[2].size());
   }
+  if (!row_versions_.empty()) {
+    ++version_;
+    if (keys_size == 1 && keys[0] == -1) {
+      std::fill(row_versions_.begin(), row_versions_.end(), version_);
+    } else {
+      for (size_t i = 0; i < keys_size; ++i) {
+        CHECK(keys[i] >= row_offset_ && keys[i] < row_offset_ + my_num_row_);
+        row_versions_[keys[i] - row_offset_] = version_;
+      }
+    }
+  }
   // add all values
   if (keys_size == 1 && keys[0] == -1){
     size_t ssize = storage_.size();
-    CHECK(ssize == data[1].size<T>());
+    CHECK(ssize == num_values);
+    storage_.Touch(0, ssize);
     updater_->Update(ssize, storage_.data(), values, option);
-    Log::Debug("[ProcessAdd] Server = %d, adding all rows offset = %d, #rows = %d\n",
+    MV_LOG_DEBUG("[ProcessAdd] Server = %d, adding all rows offset = %d, #rows = %d\n",
       server_id_, row_offset_, ssize / num_col_);
   } else {
-    CHECK(data[1].size() == keys_size * sizeof(T) * num_col_);
+    CHECK(num_values == keys_size * num_col_);
 
-    integer_t offset_v = 0;
-    CHECK(storage_.size() >= keys_size * num_col_);
-    for (auto i = 0; i < keys_size; ++i) {
-      integer_t offset_s = (keys[i] - row_offset_) * num_col_;
-      updater_->Update(num_col_, storage_.data(), values + offset_v, option, offset_s);
-      offset_v += num_col_;
+    if (delta_buffer_ != nullptr) {
+      for (size_t i = 0; i < keys_size; ++i) {
+        CHECK(keys[i] >= row_offset_ && keys[i] < row_offset_ + my_num_row_);
+        delta_buffer_->Add(keys[i] - row_offset_, values + i * num_col_);
+      }
+      if (++buffered_adds_ >= MV_CONFIG_aggregate_adds) FlushAll();
+    } else if (keys_size <
+               static_cast<size_t>(MV_CONFIG_matrix_parallel_rows)) {
+      for (size_t i = 0; i < keys_size; ++i) {
+        UpdateRow(keys[i], values + i * num_col_, option);
+      }
+    } else {
+      // Each thread takes the rows with row % num_threads equal to its
+      // index in request order, duplicated rows are applied as serially
+      int num_threads = MV_CONFIG_matrix_server_threads;
+      thread_keys_.resize(num_threads);
+      for (auto& thread_keys : thread_keys_) thread_keys.clear();
+      for (size_t i = 0; i < keys_size; ++i) {
+        CHECK(keys[i] >= row_offset_ && keys[i] < row_offset_ + my_num_row_);
+        thread_keys_[keys[i] % num_threads].push_back(i);
+      }
+      #pragma omp parallel for schedule(static, 1) num_threads(num_threads)
+      for (int t = 0; t < num_threads; ++t) {
+        for (size_t i : thread_keys_[t]) {
+          UpdateRow(keys[i], values + i * num_col_, option);
+        }
+      }
     }
-    Log::Debug("[ProcessAdd] Server = %d, adding #rows = %d\n",
+    MV_LOG_DEBUG("[ProcessAdd] Server = %d, adding #rows = %d\n",
       server_id_, keys_size);
   }
   delete option;
 }
 
+template <typename T>
+void MatrixServerTable<T>::UpdateRow(integer_t row, T* delta,
+                                     AddOption* option) {
+  CHECK(row >= row_offset_ && row < row_offset_ + my_num_row_);
+  size_t offset_s = static_cast<size_t>(row - row_offset_) * num_col_;
+  storage_.Touch(offset_s, num_col_);
+  updater_->Update(num_col_, storage_.data(), delta, option, offset_s);
+}
+
+template <typename T>
+void MatrixServerTable<T>::FlushRow(integer_t row) {
+  CHECK(row >= row_offset_ && row < row_offset_ + my_num_row_);
+  delta_buffer_->Flush(row - row_offset_, [this](size_t local, T* delta) {
+    UpdateRow(static_cast<integer_t>(local) + row_offset_, delta, nullptr);
+  });
+}
+
+template <typename T>
+void MatrixServerTable<T>::FlushAll() {
+  buffered_adds_ = 0;
+  if (delta_buffer_ == nullptr || delta_buffer_->empty()) return;
+  delta_buffer_->FlushAll([this](size_t local, T* delta) {
+    UpdateRow(static_cast<integer_t>(local) + row_offset_, delta, nullptr);
+  });
+  MV_LOG_DEBUG("[FlushAll] Server = %d, merge ratio = %f\n", server_id_,
+    delta_buffer_->merge_ratio());
+}
+
+template <typename T>
+double MatrixServerTable<T>::merge_ratio() const {
+  return delta_buffer_ == nullptr ? 1.0 : delta_buffer_->merge_ratio();
+}
+
 template <typename T>
 void MatrixServerTable<T>::ProcessGet(const std::vector<Blob>& data,
   std::vector<Blob>* result) {
-  CHECK(data.size() == 1);
+  CHECK(data.size() == 1 || data.size() == 2);  // 2 for delta get
   CHECK_NOTNULL(result);
 
   result->push_back(data[0]); // also push the key
 
-  size_t keys_size = data[0].size<integer_t>();
-  integer_t* keys = reinterpret_cast<integer_t*>(data[0].data());
+  size_t keys_size;
+  const integer_t* keys = key_codec::DecodeKeys(data[0], &keys_size,
+                                                &keys_buffer_);
+  if (data.size() == 2) {
+    CHECK(keys_size == 1 && keys[0] == -1);
+    CHECK(!row_versions_.empty());
+    ProcessDeltaGet(GetOption(data[1].data(), data[1].size()), result);
+    return;
+  }
 
   //get all rows
   if (keys_size == 1 && keys[0] == -1){
+    FlushAll();
     Blob value(sizeof(T) * storage_.size());
     T* pvalues = reinterpret_cast<T*>(value.data());
     updater_->Access(storage_.size(), storage_.data(), pvalues);
     result->push_back(value);
     result->push_back(Blob(&server_id_, sizeof(int)));
-    Log::Debug("[ProcessGet] Server = %d, getting all rows offset = %d, #rows = %d\n",
+    MV_LOG_DEBUG("[ProcessGet] Server = %d, getting all rows offset = %d, #rows = %d\n",
       server_id_, row_offset_, storage_.size() / num_col_);
     return;
   }
@@ -442,25 +683,69 @@ void MatrixServerTable<T>::ProcessGet(const std::vector<Blob>& data,
   integer_t row_size = sizeof(T)* num_col_;
   result->push_back(Blob(keys_size * row_size));
   T* vals = reinterpret_cast<T*>((*result)[1].data());
-  integer_t offset_v = 0;
-  for (auto i = 0; i < keys_size; ++i) {
-    integer_t offset_s = (keys[i] - row_offset_) * num_col_;
-    updater_->Access(num_col_, storage_.data(), vals + offset_v, offset_s);
-    offset_v += num_col_;
+  if (delta_buffer_ != nullptr) {
+    for (size_t i = 0; i < keys_size; ++i) FlushRow(keys[i]);
+  }
+  int num_keys = static_cast<int>(keys_size);
+  #pragma omp parallel for schedule(static) \
+    num_threads(MV_CONFIG_matrix_server_threads) \
+    if (num_keys >= MV_CONFIG_matrix_parallel_rows)
+  for (int i = 0; i < num_keys; ++i) {
+    size_t offset_s = static_cast<size_t>(keys[i] - row_offset_) * num_col_;
+    updater_->Access(num_col_, storage_.data(), vals + i * num_col_, offset_s);
   }
-  Log::Debug("[ProcessGet] Server = %d, getting row #rows = %d\n",
+  MV_LOG_DEBUG("[ProcessGet] Server = %d, getting row #rows = %d\n",
     server_id_, keys_size);
   return;
 }
 
+template <typename T>
+void MatrixServerTable<T>::ProcessDeltaGet(const GetOption& option,
+                                           std::vector<Blob>* result) {
+  FlushAll();
+  std::vector<integer_t> changed;
+  for (integer_t i = 0; i < my_num_row_; ++i) {
+    if (row_versions_[i] > option.version()) changed.push_back(i + row_offset_);
+  }
+  Blob meta(2 * sizeof(int64_t));
+  meta.As<int64_t>(0) = server_id_;
+  meta.As<int64_t>(1) = version_;
+  result->push_back(meta);
+  if (!changed.empty()) {
+    Blob value(changed.size() * num_col_ * sizeof(T));
+    T* pvalues = reinterpret_cast<T*>(value.data());
+    for (size_t i = 0; i < changed.size(); ++i) {
+      size_t offset_s = static_cast<size_t>(changed[i] - row_offset_) * num_col_;
+      updater_->Access(num_col_, storage_.data(), pvalues + i * num_col_,
+                       offset_s);
+    }
+    result->push_back(key_codec::EncodeKeys(changed.data(), changed.size()));
+    result->push_back(value);
+  }
+  MV_LOG_DEBUG("[ProcessGet] Server = %d, delta get since version %" PRId64
+    ", #changed rows = %zu / %d\n", server_id_, option.version(),
+    changed.size(), my_num_row_);
+}
+
 template <typename T>
 void MatrixServerTable<T>::Store(Stream* s) {
+  FlushAll();
   s->Write(storage_.data(), storage_.size() * sizeof(T));
 }
 
+template <typename T>
+std::shared_ptr<Snapshot> MatrixServerTable<T>::StartSnapshot(Stream* s) {
+  FlushAll();
+  return storage_.StartSnapshot(s);
+}
+
 template <typename T>
 void MatrixServerTable<T>::Load(Stream* s) {
-  s->Read(storage_.data(), storage_.size() * sizeof(T));
+  FlushAll();
+  storage_.Load(s);
+  if (!row_versions_.empty()) {
+    std::fill(row_versions_.begin(), row_versions_.end(), ++version_);
+  }
 }
 
 MV_INSTANTIATE_CLASS_WITH_BASE_TYPE(MatrixWorkerTable);
@@ -0,0 +1,84 @@
+#include "multiverso/table/snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "multiverso/dashboard.h"
+#include "multiverso/io/io.h"
+#include "multiverso/util/log.h"
+#include "multiverso/util/timer.h"
+
+namespace multiverso {
+
+// time to write snapshots in the background
+REGISTER_MONITOR(SNAPSHOT_WRITE)
+
+const size_t Snapshot::kBlockSize;
+
+Snapshot::Snapshot(const void* data, size_t size, Stream* stream,
+                   size_t block_size)
+  : data_(static_cast<const char*>(data)), size_(size), stream_(stream),
+    block_size_(block_size), copied_(0), write_ms_(0), done_(false) {
+  CHECK_NOTNULL(stream_);
+  CHECK(block_size_ > 0);
+  size_t num_blocks = (size_ + block_size_ - 1) / block_size_;
+  states_.resize(num_blocks, kPending);
+  copies_.resize(num_blocks);
+  thread_ = std::thread(&Snapshot::Run, this);
+}
+
+Snapshot::~Snapshot() { Wait(); }
+
+void Snapshot::Wait() {
+  if (thread_.joinable()) thread_.join();
+}
+
+size_t Snapshot::copied() const {
+  std::lock_guard<std::mutex> lock(m_);
+  return copied_;
+}
+
+void Snapshot::CopyBlocks(size_t offset, size_t size) {
+  if (size == 0) return;
+  CHECK(offset + size <= size_);
+  std::lock_guard<std::mutex> lock(m_);
+  for (size_t block = offset / block_size_;
+       block <= (offset + size - 1) / block_size_; ++block) {
+    if (states_[block] != kPending) continue;
+    size_t begin = block * block_size_;
+    size_t end = std::min(size_, begin + block_size_);
+    copies_[block].assign(data_ + begin, data_ + end);
+    states_[block] = kCopied;
+    copied_ += end - begin;
+  }
+}
+
+void Snapshot::Run() {
+  Timer timer;
+  std::vector<char> buffer;
+  for (size_t block = 0; block < states_.size(); ++block) {
+    size_t begin = block * block_size_;
+    size_t end = std::min(size_, begin + block_size_);
+    {
+      std::lock_guard<std::mutex> lock(m_);
+      if (states_[block] == kCopied) {
+        buffer.swap(copies_[block]);
+      } else {
+        buffer.assign(data_ + begin, data_ + end);
+      }
+      std::vector<char>().swap(copies_[block]);
+      states_[block] = kWritten;
+    }
+    stream_->Write(buffer.data(), buffer.size());
+  }
+  delete stream_;
+  stream_ = nullptr;
+  write_ms_ = timer.elapse();
+  g_SNAPSHOT_WRITE_monitor.Record(write_ms_);
+  Dashboard::GetCounter("SNAPSHOT_BYTES")->Add(size_);
+  Log::Info("[Snapshot] %zu bytes written in %.3f ms, %zu copied on "
+    "write\n", size_, write_ms_, copied());
+  done_.store(true, std::memory_order_release);
+}
+
+}  // namespace multiverso
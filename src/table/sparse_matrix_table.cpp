@@ -7,9 +7,18 @@
 #include "multiverso/util/log.h"
 #include "multiverso/util/quantization_util.h"
 #include "multiverso/updater/updater.h"
+#include "multiverso/util/configure.h"
 
 namespace multiverso {
 
+MV_DEFINE_int(sparse_format, 2, "wire format of the compressed sparse matrix "
+  "Adds, 1 for servers of older builds which only decode that one");
+
+template <typename T>
+SparseMatrixWorkerTable<T>::SparseMatrixWorkerTable(integer_t num_row,
+  integer_t num_col) : MatrixWorkerTable<T>(num_row, num_col),
+  sparse_filter_(0, true, MV_CONFIG_sparse_format) { }
+
 // get whole table, data is user-allocated memory
 template <typename T>
 void SparseMatrixWorkerTable<T>::Get(T* data, size_t size,
@@ -39,7 +48,7 @@ void SparseMatrixWorkerTable<T>::Get(integer_t row_id, T* data, size_t size,
   }
 
   WorkerTable::Get(keys, option);
-  Log::Debug("[Get] worker = %d, #row = %d\n", MV_Rank(), row_id);
+  MV_LOG_DEBUG("[Get] worker = %d, #row = %d\n", MV_Rank(), row_id);
   if (is_option_mine) delete option;
 }
 
@@ -62,7 +71,7 @@ void SparseMatrixWorkerTable<T>::Get(const std::vector<integer_t>& row_ids,
   }
 
   WorkerTable::Get(keys, option);
-  Log::Debug("[Get] worker = %d, #rows_set = %d\n", MV_Rank(),
+  MV_LOG_DEBUG("[Get] worker = %d, #rows_set = %d\n", MV_Rank(),
     row_ids.size());
   if (is_option_mine) delete option;
 }
@@ -145,10 +154,9 @@ int SparseMatrixWorkerTable<T>::Partition(const std::vector<Blob>& kv,
   }
 
    // only have effect when adding elements
-  SparseFilter<T, int32_t>  filter(0, true);
   for (auto& pair : *out) {
     std::vector<Blob> compressed_blobs;
-    filter.FilterIn(pair.second, &compressed_blobs);
+    sparse_filter_.FilterIn(pair.second, &compressed_blobs);
     pair.second.swap(compressed_blobs);
   }
 
@@ -161,7 +169,7 @@ void SparseMatrixWorkerTable<T>::ProcessReplyGet(
   // replace row_index when original key == -1
   if (this->row_index_[this->num_row_] != nullptr) {
     size_t keys_size = reply_data[0].size<integer_t>();
-    Log::Debug("[SparseMatrixWorkerTable:ProcessReplyGet] worker = %d, #keys_size = %d\n", MV_Rank(),
+    MV_LOG_DEBUG("[SparseMatrixWorkerTable:ProcessReplyGet] worker = %d, #keys_size = %d\n", MV_Rank(),
       keys_size);
     integer_t* keys = reinterpret_cast<integer_t*>(reply_data[0].data());
     for (auto i = 0; i < keys_size; ++i) {
@@ -172,28 +180,16 @@ void SparseMatrixWorkerTable<T>::ProcessReplyGet(
   MatrixWorkerTable<T>::ProcessReplyGet(reply_data);
 }
 
-template <typename T>
-SparseMatrixServerTable<T>::~SparseMatrixServerTable() {
-  for (auto i = 0; i < workers_nums_; ++i) {
-    delete[]up_to_date_[i];
-  }
-  delete[]up_to_date_;
-}
-
 template <typename T>
 SparseMatrixServerTable<T>::SparseMatrixServerTable(integer_t num_row, integer_t num_col,
-  bool using_pipeline) : MatrixServerTable<T>(num_row, num_col) {
+  bool using_pipeline) : MatrixServerTable<T>(num_row, num_col),
+  sparse_filter_(0, true) {
    workers_nums_ = multiverso::MV_NumWorkers();
   if (using_pipeline) {
     workers_nums_ *= 2;
   }
-        
-  up_to_date_ = new bool*[workers_nums_];
-  for (auto i = 0; i < workers_nums_; ++i) {
-    up_to_date_[i] = new bool[this->my_num_row_];
-    memset(up_to_date_[i], 0, sizeof(bool) * this->my_num_row_);
-  }
-  Log::Debug("[SparseMatrixServerTable] workers_nums_= %d .\n", workers_nums_);
+  stale_rows_.reset(new StaleRows(this->my_num_row_, workers_nums_));
+  MV_LOG_DEBUG("[SparseMatrixServerTable] workers_nums_= %d .\n", workers_nums_);
 }
 
 template <typename T>
@@ -203,21 +199,10 @@ void SparseMatrixServerTable<T>::UpdateAddState(int worker_id,
   integer_t* keys = reinterpret_cast<integer_t*>(keys_blob.data());
   // add all values
   if (keys_size == 1 && keys[0] == -1) {
-    for (auto id = 0; id < workers_nums_; ++id) {
-      if (id == worker_id) continue;
-      for (auto local_row_id = 0; local_row_id < this->my_num_row_; ++local_row_id) {
-        // if other worker doesn't update the row, we can marked it as the updated.
-        up_to_date_[id][local_row_id] = false;
-      }
-    }
+    stale_rows_->AddedAll(worker_id);
   } else {
-    for (auto id = 0; id < workers_nums_; ++id) {
-      if (id == worker_id) continue;
-      for (auto i = 0; i < keys_size; ++i) {
-        // if other worker doesn't update the row, we can marked it as the updated.
-        auto local_row_id = GetPhysicalRow(keys[i]);
-        up_to_date_[id][local_row_id] = false;
-      }
+    for (size_t i = 0; i < keys_size; ++i) {
+      stale_rows_->Added(GetPhysicalRow(keys[i]), worker_id);
     }
   }
 }
@@ -235,17 +220,15 @@ void SparseMatrixServerTable<T>::UpdateGetState(int worker_id, integer_t* keys,
 
   if (key_size == 1 && keys[0] == -1) {
     for (auto local_row_id = 0; local_row_id < this->my_num_row_; ++local_row_id)  {
-      if (!up_to_date_[worker_id][local_row_id]) {
+      if (stale_rows_->Fetch(local_row_id, worker_id)) {
         out_rows->push_back(GetLogicalRow(local_row_id));
-        up_to_date_[worker_id][local_row_id] = true;
       }
     }
   } else {
     for (auto i = 0; i < key_size; ++i)  {
       auto global_row_id = keys[i];
       auto local_row_id = GetPhysicalRow(global_row_id);
-      if (!up_to_date_[worker_id][local_row_id]) {
-        up_to_date_[worker_id][local_row_id] = true;
+      if (stale_rows_->Fetch(local_row_id, worker_id)) {
         out_rows->push_back(global_row_id);
       }
     }
@@ -262,8 +245,7 @@ void SparseMatrixServerTable<T>::ProcessAdd(
   const std::vector<Blob>& compressed_data) {
   if (compressed_data.size() == 0) return;
   std::vector<Blob> data;
-  SparseFilter<T, int32_t> filter(0, true);
-  filter.FilterOut(compressed_data, &data);
+  sparse_filter_.FilterOut(compressed_data, &data);
 
   // the AddOption option is needed for the sparse update
   CHECK(data.size() == 3);
@@ -281,8 +263,7 @@ void SparseMatrixServerTable<T>::ProcessGet(
   std::vector<Blob>* result) {
   if (compressed_data.size() == 0) return;
   std::vector<Blob> data;
-  SparseFilter<T, int32_t> filter(0, true);
-  filter.FilterOut(compressed_data, &data);
+  sparse_filter_.FilterOut(compressed_data, &data);
 
   // the GetOption is needed for the sparse update
   CHECK(data.size() == 2);
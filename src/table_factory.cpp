@@ -1,22 +1,30 @@
 #include "multiverso/table_factory.h"
 
+#include <mutex>
+#include <unordered_map>
+
 #include "multiverso/table/array_table.h"
 #include "multiverso/table/matrix_table.h"
 
 namespace multiverso {
 
 namespace table_factory {
-std::vector<ServerTable*> server_tables;
+// server tables of each zoo, several zoos live in one process when ranks
+// run locally
+std::unordered_map<Zoo*, std::vector<ServerTable*>> server_tables;
+std::mutex server_tables_mutex;
 
 void FreeServerTables() {
-  for (auto table : server_tables) {
+  std::lock_guard<std::mutex> lock(server_tables_mutex);
+  for (auto table : server_tables[Zoo::Get()]) {
     delete table;
   }
-  server_tables.clear();
+  server_tables.erase(Zoo::Get());
 }
 
 void PushServerTable(ServerTable*table) {
-  server_tables.push_back(table);
+  std::lock_guard<std::mutex> lock(server_tables_mutex);
+  server_tables[Zoo::Get()].push_back(table);
 }
 
 } // namespace table_factory
@@ -3,6 +3,8 @@
 //#define ENABLE_DCASGD
 
 #include "multiverso/updater/adagrad_updater.h"
+#include "multiverso/updater/adam_updater.h"
+#include "multiverso/updater/ftrl_updater.h"
 #include "multiverso/updater/momentum_updater.h"
 #ifdef ENABLE_DCASGD
 #include "multiverso/updater/dcasgd/dcasgd_updater.h"
@@ -16,6 +18,11 @@ namespace multiverso {
 
 MV_DEFINE_string(updater_type, "default", "multiverso server updater type");
 MV_DEFINE_int(omp_threads, 4 , "#theads used by openMP for updater");
+MV_DEFINE_double(adam_beta1, 0.9, "decay of the first moment of adam updater");
+MV_DEFINE_double(adam_beta2, 0.999, "decay of the second moment of adam updater");
+MV_DEFINE_double(adam_epsilon, 1e-8, "epsilon of adam updater");
+MV_DEFINE_double(ftrl_beta, 1.0, "beta of ftrl updater learning rate");
+MV_DEFINE_double(ftrl_l2, 0.0, "l2 regularization of ftrl updater");
 #ifdef ENABLE_DCASGD
 MV_DEFINE_bool(is_pipelined, false, "Only used for CNTK - DCASGD");
 #endif
@@ -23,8 +30,9 @@ MV_DEFINE_bool(is_pipelined, false, "Only used for CNTK - DCASGD");
 template <typename T>
 void Updater<T>::Update(size_t num_element, T* data, T* delta,
                         AddOption*, size_t offset) {
-  // parallelism with openMP
-  #pragma omp parallel for schedule(static) num_threads(MV_CONFIG_omp_threads)
+  // parallelism with openMP, single rows are not worth the thread wake ups
+  #pragma omp parallel for schedule(static) num_threads(MV_CONFIG_omp_threads) \
+    if (num_element >= 4096)
   for (int i = 0; i < num_element; ++i) {
     data[i + offset] += delta[i];
   }
@@ -40,21 +48,25 @@ void Updater<T>::Access(size_t num_element, T* data, T* blob_data,
 // Gradient-based updater in only for numerical table
 // For simple int table, just using simple updater
 template<>
-Updater<int>* Updater<int>::GetUpdater(size_t) {
-  return new Updater<int>();
+Updater<int>* Updater<int>::GetUpdater(size_t, size_t) {
+  return new DefaultUpdater<int>();
 }
 
 template <typename T>
-Updater<T>* Updater<T>::GetUpdater(size_t size) {
+Updater<T>* Updater<T>::GetUpdater(size_t size, size_t row_size) {
   std::string type = MV_CONFIG_updater_type;
   if (type == "sgd") return new SGDUpdater<T>(size);
-  if (type == "adagrad") return new AdaGradUpdater<T>(size);
-  if (type == "momentum_sgd") return new MomentumUpdater<T>(size);
+  if (type == "adagrad") return new AdaGradUpdater<T>(size, row_size);
+  if (type == "momentum_sgd") return new MomentumUpdater<T>(size, row_size);
+  if (type == "adam") return new AdamUpdater<T>(size, row_size,
+    MV_CONFIG_adam_beta1, MV_CONFIG_adam_beta2, MV_CONFIG_adam_epsilon);
+  if (type == "ftrl") return new FTRLUpdater<T>(size, row_size,
+    MV_CONFIG_ftrl_beta, MV_CONFIG_ftrl_l2);
 #ifdef ENABLE_DCASGD
   if (type == "dcasgd") return new DCASGDUpdater<T>(size, MV_CONFIG_is_pipelined);
 #endif
   // Default: simple updater
-  return new Updater<T>();
+  return new DefaultUpdater<T>();
 }
 
 MV_INSTANTIATE_CLASS_WITH_BASE_TYPE(Updater);
@@ -2,13 +2,93 @@
 
 #include <time.h>
 #include <stdarg.h>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "multiverso/util/configure.h"
 
 namespace multiverso {
 
 MV_DEFINE_bool(logtostderr, false, "whether output log to stderr");
+MV_DEFINE_int(log_async_buffer, 0, "messages queued for the log writing "
+              "thread, 0 to write the log in the logging threads");
+
+// Ring buffer of formatted messages and the thread writing them
+class Logger::AsyncSink {
+public:
+  AsyncSink(Logger* logger, size_t capacity)
+    : logger_(logger), buffer_(capacity), head_(0), size_(0), dropped_(0),
+      writing_(false), stop_(false), thread_(&AsyncSink::Main, this) {}
+
+  ~AsyncSink() {
+    {
+      std::lock_guard<std::mutex> l(m_);
+      stop_ = true;
+    }
+    ready_.notify_one();
+    thread_.join();
+  }
+
+  void Push(std::string&& message) {
+    std::lock_guard<std::mutex> l(m_);
+    if (size_ == buffer_.size()) {
+      ++dropped_;
+      return;
+    }
+    buffer_[(head_ + size_) % buffer_.size()] = std::move(message);
+    if (size_++ == 0) ready_.notify_one();
+  }
+
+  // Waits until the queued messages are written
+  void Flush() {
+    std::unique_lock<std::mutex> l(m_);
+    drained_.wait(l, [this] { return size_ == 0 && !writing_; });
+  }
+
+private:
+  void Main() {
+    std::vector<std::string> batch;
+    std::unique_lock<std::mutex> l(m_);
+    while (true) {
+      ready_.wait(l, [this] { return size_ > 0 || stop_; });
+      if (size_ == 0) break;
+      for (; size_ > 0; --size_) {
+        batch.push_back(std::move(buffer_[head_]));
+        head_ = (head_ + 1) % buffer_.size();
+      }
+      size_t dropped = dropped_;
+      dropped_ = 0;
+      writing_ = true;
+      l.unlock();
+      if (dropped > 0) {
+        logger_->Output("[" + logger_->GetLevelStr(LogLevel::Error) + "] [" +
+          logger_->GetSystemTime() + "] Log buffer full, dropped " +
+          std::to_string(dropped) + " messages\n");
+      }
+      for (auto& message : batch) logger_->Output(message);
+      batch.clear();
+      l.lock();
+      writing_ = false;
+      drained_.notify_all();
+    }
+  }
+
+  Logger* logger_;
+  std::mutex m_;
+  std::condition_variable ready_;
+  std::condition_variable drained_;
+  std::vector<std::string> buffer_;
+  size_t head_;
+  size_t size_;
+  size_t dropped_;
+  bool writing_;
+  bool stop_;
+  std::thread thread_;
+};
 
 // Creates a Logger instance writing messages into STDOUT.
 Logger::Logger(LogLevel level) {
@@ -25,9 +105,20 @@ Logger::Logger(std::string filename, LogLevel level) {
 }
 
 Logger::~Logger() {
+  StopAsync();
   CloseLogFile();
 }
 
+void Logger::StartAsync(size_t capacity) {
+  CHECK(capacity > 0);
+  StopAsync();
+  async_.reset(new AsyncSink(this, capacity));
+}
+
+void Logger::StopAsync() {
+  async_.reset();
+}
+
 int Logger::ResetLogFile(std::string filename) {
   CloseLogFile();
   if (filename.size() > 0) {  // try to open the log file if it is specified
@@ -81,32 +172,46 @@ void Logger::Fatal(const char *format, ...) {
 
 inline void Logger::WriteImpl(LogLevel level,
     const char *format, va_list* val) {
-  if (level >= level_) {  // omit the message with low level
-    std::string level_str = GetLevelStr(level);
-    std::string time_str = GetSystemTime();
-    va_list val_copy;
-    va_copy(val_copy, *val);
-    // write to STDOUT
-    if (MV_CONFIG_logtostderr) {
-      fprintf(stderr, "[%s] [%s] ", level_str.c_str(), time_str.c_str());
-      vfprintf(stderr, format, *val);
-    } else {
-      printf("[%s] [%s] ", level_str.c_str(), time_str.c_str());
-      vprintf(format, *val);
-      fflush(stdout);
-    }
-    // write to log file
-    if (file_ != nullptr) {
-      fprintf(file_, "[%s] [%s] ", level_str.c_str(), time_str.c_str());
-      vfprintf(file_, format, val_copy);
-      fflush(file_);
+  if (level < level_) return;  // omit the message with low level
+  std::string message = "[" + GetLevelStr(level) + "] [" +
+    GetSystemTime() + "] ";
+  va_list val_copy;
+  va_copy(val_copy, *val);
+  int size = vsnprintf(nullptr, 0, format, val_copy);
+  va_end(val_copy);
+  if (size > 0) {
+    size_t prefix = message.size();
+    message.resize(prefix + size + 1);
+    vsnprintf(&message[prefix], size + 1, format, *val);
+    message.resize(prefix + size);
+  }
+  if (async_ != nullptr) {
+    if (level != LogLevel::Fatal) {
+      async_->Push(std::move(message));
+      return;
     }
-    va_end(val_copy);
+    async_->Flush();
+  }
+  Output(message);
 
-    if (is_kill_fatal_ && level == LogLevel::Fatal) {
-      CloseLogFile();
-      exit(1);
-    }
+  if (is_kill_fatal_ && level == LogLevel::Fatal) {
+    CloseLogFile();
+    exit(1);
+  }
+}
+
+void Logger::Output(const std::string& message) {
+  // write to STDOUT
+  if (MV_CONFIG_logtostderr) {
+    fputs(message.c_str(), stderr);
+  } else {
+    fputs(message.c_str(), stdout);
+    fflush(stdout);
+  }
+  // write to log file
+  if (file_ != nullptr) {
+    fputs(message.c_str(), file_);
+    fflush(file_);
   }
 }
 
@@ -156,6 +261,25 @@ void Log::ResetKillFatal(bool is_kill_fatal) {
   logger_.ResetKillFatal(is_kill_fatal);
 }
 
+namespace {
+
+std::mutex g_async_mutex;
+// StartAsync calls not matched by a StopAsync yet
+int g_async_refs = 0;
+
+}  // namespace
+
+void Log::StartAsync(size_t capacity) {
+  std::lock_guard<std::mutex> lock(g_async_mutex);
+  if (g_async_refs++ == 0) logger_.StartAsync(capacity);
+}
+
+void Log::StopAsync() {
+  std::lock_guard<std::mutex> lock(g_async_mutex);
+  CHECK(g_async_refs > 0);
+  if (--g_async_refs == 0) logger_.StopAsync();
+}
+
 void Log::Write(LogLevel level, const char *format, ...) {
   va_list val;
   va_start(val, format);
@@ -0,0 +1,185 @@
+#include "multiverso/util/metrics_reporter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+#include "multiverso/dashboard.h"
+#include "multiverso/util/configure.h"
+#include "multiverso/util/log.h"
+
+namespace multiverso {
+
+MV_DEFINE_int(metrics_interval, 0,
+  "seconds between two exports of the dashboard metrics, 0 disables them");
+MV_DEFINE_string(metrics_file, "multiverso_metrics",
+  "file of the metrics exports, the rank is appended");
+MV_DEFINE_string(metrics_format, "json", "json (lines) / prometheus");
+
+namespace {
+
+// JSON string of name, which may hold any character
+std::string Quote(const std::string& name) {
+  std::string result = "\"";
+  for (char c : name) {
+    if (c == '"' || c == '\\') result += '\\';
+    result += c;
+  }
+  return result + "\"";
+}
+
+const char* kQuantileNames[] = { "p50", "p90", "p99", "p999" };
+
+}  // namespace
+
+MetricsReporter::MetricsReporter(const std::string& path, int interval,
+                                 Format format, int rank)
+  : path_(path), interval_(interval), format_(format), rank_(rank),
+    stop_(false) {
+  CHECK(interval_ > 0);
+  if (format_ == kJsonLines) {
+    // start a new file for this run
+    FILE* file = fopen(path_.c_str(), "w");
+    if (file == nullptr) Log::Fatal("Cannot open %s\n", path_.c_str());
+    fclose(file);
+  }
+  thread_ = std::thread(&MetricsReporter::Main, this);
+}
+
+MetricsReporter::~MetricsReporter() {
+  {
+    std::lock_guard<std::mutex> l(m_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  Report();
+}
+
+MetricsReporter* MetricsReporter::FromFlags(int rank) {
+  if (MV_CONFIG_metrics_interval <= 0) return nullptr;
+  Format format = kJsonLines;
+  if (MV_CONFIG_metrics_format == "prometheus") {
+    format = kPrometheus;
+  } else if (MV_CONFIG_metrics_format != "json") {
+    Log::Fatal("Unknown metrics format %s\n", MV_CONFIG_metrics_format.c_str());
+  }
+  return new MetricsReporter(MV_CONFIG_metrics_file + "." +
+    std::to_string(rank), MV_CONFIG_metrics_interval, format, rank);
+}
+
+void MetricsReporter::Main() {
+  std::unique_lock<std::mutex> l(m_);
+  while (!cv_.wait_for(l, std::chrono::seconds(interval_),
+                       [this] { return stop_; })) {
+    l.unlock();
+    Report();
+    l.lock();
+  }
+}
+
+void MetricsReporter::Report() {
+  DashboardSnapshot snapshot;
+  // rates over the last interval
+  Dashboard::Snapshot(interval_, &snapshot);
+  if (format_ == kJsonLines) {
+    FILE* file = fopen(path_.c_str(), "a");
+    if (file == nullptr) {
+      Log::Error("Cannot open %s\n", path_.c_str());
+      return;
+    }
+    std::string line = ToJson(snapshot);
+    fwrite(line.data(), 1, line.size(), file);
+    fclose(file);
+    return;
+  }
+  // readers never see a partial file
+  std::string temp = path_ + ".tmp";
+  FILE* file = fopen(temp.c_str(), "w");
+  if (file == nullptr) {
+    Log::Error("Cannot open %s\n", temp.c_str());
+    return;
+  }
+  std::string text = ToPrometheus(snapshot);
+  fwrite(text.data(), 1, text.size(), file);
+  fclose(file);
+#ifdef _MSC_VER
+  // rename doesn't replace an existing file on Windows, elsewhere it does
+  // atomically and the file never goes missing
+  std::remove(path_.c_str());
+#endif
+  if (std::rename(temp.c_str(), path_.c_str()) != 0) {
+    Log::Error("Cannot rename %s to %s\n", temp.c_str(), path_.c_str());
+  }
+}
+
+std::string MetricsReporter::ToJson(const DashboardSnapshot& snapshot) const {
+  double now = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count() / 1000.0;
+  std::ostringstream oss;
+  oss.precision(9);
+  oss << "{\"time\":" << std::to_string(now) << ",\"rank\":" << rank_
+      << ",\"monitors\":{";
+  for (size_t i = 0; i < snapshot.monitors.size(); ++i) {
+    const DashboardSnapshot::MonitorValues& monitor = snapshot.monitors[i];
+    oss << (i > 0 ? "," : "") << Quote(monitor.name)
+        << ":{\"count\":" << monitor.count
+        << ",\"elapse_ms\":" << monitor.elapse;
+    for (int q = 0; q < DashboardSnapshot::kNumQuantiles; ++q) {
+      oss << ",\"" << kQuantileNames[q] << "_ms\":" << monitor.quantiles[q];
+    }
+    oss << ",\"rate\":" << monitor.rate << "}";
+  }
+  oss << "},\"counters\":{";
+  for (size_t i = 0; i < snapshot.counters.size(); ++i) {
+    const DashboardSnapshot::CounterValues& counter = snapshot.counters[i];
+    oss << (i > 0 ? "," : "") << Quote(counter.name)
+        << ":{\"count\":" << counter.count << ",\"sum\":" << counter.sum
+        << ",\"count_rate\":" << counter.count_rate
+        << ",\"sum_rate\":" << counter.sum_rate << "}";
+  }
+  oss << "},\"gauges\":{";
+  for (size_t i = 0; i < snapshot.gauges.size(); ++i) {
+    oss << (i > 0 ? "," : "") << Quote(snapshot.gauges[i].first) << ":"
+        << snapshot.gauges[i].second;
+  }
+  oss << "}}\n";
+  return oss.str();
+}
+
+std::string MetricsReporter::ToPrometheus(
+  const DashboardSnapshot& snapshot) const {
+  std::ostringstream oss;
+  oss.precision(9);
+  std::string rank = "rank=\"" + std::to_string(rank_) + "\"";
+  oss << "# TYPE multiverso_latency_ms summary\n";
+  for (auto& monitor : snapshot.monitors) {
+    std::string labels = "{monitor=" + Quote(monitor.name) + "," + rank;
+    for (int q = 0; q < DashboardSnapshot::kNumQuantiles; ++q) {
+      oss << "multiverso_latency_ms" << labels << ",quantile=\""
+          << DashboardSnapshot::kQuantiles[q] << "\"} "
+          << monitor.quantiles[q] << "\n";
+    }
+    oss << "multiverso_latency_ms_sum" << labels << "} " << monitor.elapse
+        << "\nmultiverso_latency_ms_count" << labels << "} " << monitor.count
+        << "\n";
+  }
+  oss << "# TYPE multiverso_events_total counter\n";
+  for (auto& counter : snapshot.counters) {
+    oss << "multiverso_events_total{counter=" << Quote(counter.name) << ","
+        << rank << "} " << counter.count << "\n";
+  }
+  oss << "# TYPE multiverso_events_size_total counter\n";
+  for (auto& counter : snapshot.counters) {
+    oss << "multiverso_events_size_total{counter=" << Quote(counter.name)
+        << "," << rank << "} " << counter.sum << "\n";
+  }
+  oss << "# TYPE multiverso_gauge gauge\n";
+  for (auto& gauge : snapshot.gauges) {
+    oss << "multiverso_gauge{gauge=" << Quote(gauge.first) << "," << rank
+        << "} " << gauge.second << "\n";
+  }
+  return oss.str();
+}
+
+}  // namespace multiverso
@@ -0,0 +1,72 @@
+#include "multiverso/util/poller.h"
+
+#include <sstream>
+#include <thread>
+
+#include "multiverso/dashboard.h"
+#include "multiverso/util/configure.h"
+
+namespace multiverso {
+
+MV_DEFINE_int(poll_spin_count, 2000,
+  "idle rounds a polling loop spins before yielding the cpu");
+MV_DEFINE_int(poll_yield_count, 200,
+  "idle rounds a polling loop yields before blocking");
+MV_DEFINE_int(poll_wait_ms, 1,
+  "milliseconds an idle polling loop blocks at most in each wait");
+
+// cpu time burnt by idle polling loops and time they spent blocked
+REGISTER_MONITOR(POLL_IDLE_BUSY)
+REGISTER_MONITOR(POLL_IDLE_BLOCKED)
+
+AdaptivePoller::AdaptivePoller()
+  : idle_rounds_(0), spin_budget_(MV_CONFIG_poll_spin_count),
+    yield_budget_(MV_CONFIG_poll_spin_count + MV_CONFIG_poll_yield_count),
+    wait_ms_(MV_CONFIG_poll_wait_ms), rounds_(0), work_rounds_(0),
+    waits_(0), idle_busy_ms_(0), idle_blocked_ms_(0), blocked_ms_(0) {}
+
+void AdaptivePoller::Poll(bool progress, const WaitFunc& wait) {
+  ++rounds_;
+  if (progress) {
+    ++work_rounds_;
+    if (idle_rounds_ > 0) EndIdle();
+    return;
+  }
+  if (idle_rounds_ == 0) {
+    idle_timer_.Start();
+    blocked_ms_ = 0;
+  }
+  // stops counting once past the budgets, long idle loops don't overflow it
+  if (idle_rounds_ <= yield_budget_) ++idle_rounds_;
+  if (idle_rounds_ <= spin_budget_) return;
+  if (idle_rounds_ <= yield_budget_) {
+    std::this_thread::yield();
+    return;
+  }
+  ++waits_;
+  wait_timer_.Start();
+  wait(wait_ms_);
+  double elapse = wait_timer_.elapse();
+  blocked_ms_ += elapse;
+  idle_blocked_ms_ += elapse;
+  g_POLL_IDLE_BLOCKED_monitor.Record(elapse);
+}
+
+void AdaptivePoller::EndIdle() {
+  double busy = idle_timer_.elapse() - blocked_ms_;
+  idle_busy_ms_ += busy;
+  g_POLL_IDLE_BUSY_monitor.Record(busy);
+  idle_rounds_ = 0;
+}
+
+std::string AdaptivePoller::info_string() const {
+  std::ostringstream oss;
+  oss << "rounds = " << rounds_
+      << " efficiency = " << efficiency() * 100 << "%"
+      << " waits = " << waits_
+      << " idle busy = " << idle_busy_ms_ << "ms"
+      << " idle blocked = " << idle_blocked_ms_ << "ms";
+  return oss.str();
+}
+
+}  // namespace multiverso
@@ -0,0 +1,160 @@
+#include "multiverso/util/tracer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "multiverso/util/configure.h"
+#include "multiverso/util/log.h"
+#include "multiverso/zoo.h"
+
+namespace multiverso {
+
+MV_DEFINE_int(trace_sample, 0,
+  "trace one in trace_sample table requests, 0 disables the tracing");
+MV_DEFINE_string(trace_file, "multiverso_trace",
+  "file of the traces, the rank and .json are appended");
+
+namespace {
+
+// spans kept at most, the later ones are dropped
+const size_t kMaxSpans = 1 << 20;
+
+struct TraceSpan {
+  int trace;
+  // rank of the zoo of the recording thread, ranks of MV_RunLocal share
+  // the store
+  int rank;
+  int thread;
+  const char* name;
+  int64_t begin;
+  int64_t end;
+};
+
+struct TraceStore {
+  std::mutex m;
+  std::vector<TraceSpan> spans;
+  // spans dropped by rank
+  std::map<int, size_t> dropped;
+  // span names, kept alive until the dump
+  std::vector<std::unique_ptr<std::string>> names;
+  std::vector<std::string> threads;
+};
+
+TraceStore& Store() {
+  static TraceStore store;
+  return store;
+}
+
+// Index of the calling thread in TraceStore::threads, added on its first
+// span or name. Call with the store lock held.
+int ThreadIndex(TraceStore* store) {
+  thread_local int thread = -1;
+  if (thread < 0) {
+    thread = static_cast<int>(store->threads.size());
+    store->threads.push_back("thread " + std::to_string(thread));
+  }
+  return thread;
+}
+
+std::string Escape(const std::string& text) {
+  std::string result;
+  for (char c : text) {
+    if (c == '"' || c == '\\') result += '\\';
+    result += c;
+  }
+  return result;
+}
+
+}  // namespace
+
+bool Tracer::enabled() { return MV_CONFIG_trace_sample > 0; }
+
+int Tracer::NewTrace() {
+  if (!enabled()) return 0;
+  static std::atomic<int> requests(0);
+  int request = requests++;
+  if (request % MV_CONFIG_trace_sample != 0) return 0;
+  // unique among the ranks and never 0
+  int sequence = (request / MV_CONFIG_trace_sample) % ((1 << 20) - 1) + 1;
+  return (Zoo::Get()->rank() << 20) | sequence;
+}
+
+int64_t Tracer::Now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::Span(int trace, const char* name, int64_t begin, int64_t end) {
+  int rank = Zoo::Get()->rank();
+  TraceStore& store = Store();
+  std::lock_guard<std::mutex> l(store.m);
+  if (store.spans.size() >= kMaxSpans) {
+    ++store.dropped[rank];
+    return;
+  }
+  // names are few, keep one copy of each
+  const char* kept = nullptr;
+  for (auto& known : store.names) {
+    if (*known == name) { kept = known->c_str(); break; }
+  }
+  if (kept == nullptr) {
+    store.names.emplace_back(new std::string(name));
+    kept = store.names.back()->c_str();
+  }
+  TraceSpan span = { trace, rank, ThreadIndex(&store), kept, begin, end };
+  store.spans.push_back(span);
+}
+
+void Tracer::SetThreadName(const std::string& name) {
+  TraceStore& store = Store();
+  std::lock_guard<std::mutex> l(store.m);
+  store.threads[ThreadIndex(&store)] = name;
+}
+
+void Tracer::Dump(const std::string& path, int rank) {
+  TraceStore& store = Store();
+  std::lock_guard<std::mutex> l(store.m);
+  FILE* file = fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    Log::Error("Cannot open %s\n", path.c_str());
+    return;
+  }
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  fprintf(file, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,"
+    "\"args\":{\"name\":\"rank %d\"}}", rank, rank);
+  // the spans of the other ranks are kept for their dumps
+  std::vector<TraceSpan> spans, others;
+  std::vector<bool> threads(store.threads.size());
+  for (auto& span : store.spans) {
+    (span.rank == rank ? spans : others).push_back(span);
+    if (span.rank == rank) threads[span.thread] = true;
+  }
+  store.spans.swap(others);
+  for (size_t i = 0; i < store.threads.size(); ++i) {
+    if (!threads[i]) continue;
+    fprintf(file, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,"
+      "\"tid\":%d,\"args\":{\"name\":\"%s\"}}", rank, static_cast<int>(i),
+      Escape(store.threads[i]).c_str());
+  }
+  for (auto& span : spans) {
+    fprintf(file, ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,"
+      "\"ts\":%lld,\"dur\":%lld,\"bind_id\":\"0x%x\",\"flow_in\":true,"
+      "\"flow_out\":true,\"args\":{\"trace\":%d}}",
+      Escape(span.name).c_str(), rank, span.thread,
+      static_cast<long long>(span.begin),
+      static_cast<long long>(span.end - span.begin), span.trace, span.trace);
+  }
+  fprintf(file, "\n]}\n");
+  fclose(file);
+  Log::Info("Rank %d: dumped %d spans to %s, %d dropped\n", rank,
+    static_cast<int>(spans.size()), path.c_str(),
+    static_cast<int>(store.dropped[rank]));
+  store.dropped.erase(rank);
+}
+
+}  // namespace multiverso
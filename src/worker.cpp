@@ -5,6 +5,7 @@
 #include "multiverso/dashboard.h"
 #include "multiverso/util/mt_queue.h"
 #include "multiverso/util/log.h"
+#include "multiverso/util/tracer.h"
 #include "multiverso/zoo.h"
 
 namespace multiverso {
@@ -29,6 +30,7 @@ int Worker::RegisterTable(WorkerTable* worker_table) {
 
 void Worker::ProcessGet(MessagePtr& msg) {
   MONITOR_BEGIN(WORKER_PROCESS_GET)
+  TraceScope trace(msg->trace_id(), "Worker::ProcessGet");
   int table_id = msg->table_id();
   int msg_id = msg->msg_id();
   std::unordered_map<int, std::vector<Blob>> partitioned_key;
@@ -44,6 +46,7 @@ void Worker::ProcessGet(MessagePtr& msg) {
     new_msg->set_type(MsgType::Request_Get);
     new_msg->set_msg_id(msg_id);
     new_msg->set_table_id(table_id);
+    new_msg->set_trace_id(msg->trace_id());
     new_msg->set_data(it.second);
     SendTo(actor::kCommunicator, new_msg);
   }
@@ -52,6 +55,7 @@ void Worker::ProcessGet(MessagePtr& msg) {
 
 void Worker::ProcessAdd(MessagePtr& msg) {
   MONITOR_BEGIN(WORKER_PROCESS_ADD)
+  TraceScope trace(msg->trace_id(), "Worker::ProcessAdd");
   int table_id = msg->table_id();
   int msg_id = msg->msg_id();
   std::unordered_map<int, std::vector<Blob>> partitioned_kv;
@@ -69,6 +73,7 @@ void Worker::ProcessAdd(MessagePtr& msg) {
 	kv_msg->set_type(MsgType::Request_Add);
 	kv_msg->set_msg_id(msg_id);
 	kv_msg->set_table_id(table_id);
+	kv_msg->set_trace_id(msg->trace_id());
 	kv_msg->set_data(it.second);
     SendTo(actor::kCommunicator, kv_msg);
   }
@@ -77,6 +82,7 @@ void Worker::ProcessAdd(MessagePtr& msg) {
 
 void Worker::ProcessReplyGet(MessagePtr& msg) {
   MONITOR_BEGIN(WORKER_PROCESS_REPLY_GET)
+  TraceScope trace(msg->trace_id(), "Worker::ProcessReplyGet");
   int table_id = msg->table_id();
   cache_[table_id]->ProcessReplyGet(msg->data());
   cache_[table_id]->Notify(msg->msg_id());
@@ -84,6 +90,7 @@ void Worker::ProcessReplyGet(MessagePtr& msg) {
 }
 
 void Worker::ProcessReplyAdd(MessagePtr& msg) {
+  TraceScope trace(msg->trace_id(), "Worker::ProcessReplyAdd");
   cache_[msg->table_id()]->Notify(msg->msg_id());
 }
 
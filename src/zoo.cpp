@@ -11,18 +11,30 @@
 #include "multiverso/server.h"
 #include "multiverso/util/configure.h"
 #include "multiverso/util/log.h"
+#include "multiverso/util/metrics_reporter.h"
 #include "multiverso/util/mt_queue.h"
+#include "multiverso/util/tracer.h"
 #include "multiverso/worker.h"
 
 namespace multiverso {
 
-Zoo::Zoo() {}
+thread_local Zoo* Zoo::current_ = nullptr;
+
+Zoo::Zoo() : net_util_(nullptr), log_async_(false) {}
 
 Zoo::~Zoo() {}
 
+Zoo* Zoo::CreateLocal(NetInterface* net) {
+  Zoo* zoo = new Zoo();
+  zoo->net_util_ = net;
+  return zoo;
+}
+
 MV_DEFINE_string(ps_role, "default", "none / worker / server / default");
 MV_DEFINE_bool(ma, false, "model average, will not start server if true");
 MV_DECLARE_bool(sync);
+MV_DECLARE_string(trace_file);
+MV_DECLARE_int(log_async_buffer);
 
 namespace {
 
@@ -41,10 +53,15 @@ const int kController = 0;
 void Zoo::Start(int* argc, char** argv) {
   Log::Debug("Zoo started\n");
   ParseCMDFlags(argc, argv);
+  if (MV_CONFIG_log_async_buffer > 0 && !log_async_) {
+    Log::StartAsync(MV_CONFIG_log_async_buffer);
+    log_async_ = true;
+  }
 
   // Init the network
-  net_util_ = NetInterface::Get();
+  if (net_util_ == nullptr) net_util_ = NetInterface::Get();
   net_util_->Init(argc, argv);
+  metrics_.reset(MetricsReporter::FromFlags(rank()));
 
   if (!MV_CONFIG_ma) { StartPS(); }
 }
@@ -52,15 +69,28 @@ void Zoo::Start(int* argc, char** argv) {
 void Zoo::Stop(bool finalize_net) {
   // Stop the system
   if (!MV_CONFIG_ma) { StopPS(); }
+  metrics_.reset();
+  if (Tracer::enabled()) {
+    Tracer::Dump(MV_CONFIG_trace_file + "." + std::to_string(rank()) + ".json",
+                 rank());
+  }
   // Stop the network
   if (finalize_net) net_util_->Finalize();
   for (auto actor : zoo_) delete actor.second;
   zoo_.clear();
   Log::Info("Multiverso Shutdown successfully\n");
+  if (log_async_) {
+    log_async_ = false;
+    Log::StopAsync();
+  }
 }
 
-int Zoo::rank() const { return NetInterface::Get()->rank(); }
-int Zoo::size() const { return NetInterface::Get()->size(); }
+int Zoo::rank() const { return net_util()->rank(); }
+int Zoo::size() const { return net_util()->size(); }
+
+NetInterface* Zoo::net_util() const {
+  return net_util_ != nullptr ? net_util_ : NetInterface::Get();
+}
 
 void Zoo::SendTo(const std::string& name, MessagePtr& msg) {
   CHECK(zoo_.find(name) != zoo_.end());
@@ -175,6 +205,21 @@ void Zoo::Barrier() {
   Log::Debug("rank %d reached barrier\n", rank());
 }
 
+void Zoo::Snapshot(const std::string& uri) {
+  // no server runs in model average mode
+  if (MV_CONFIG_ma || nodes_.empty() || server_rank() < 0) return;
+  MessagePtr msg(new Message());
+  msg->set_src(rank());
+  msg->set_dst(rank());
+  msg->set_type(MsgType::Server_Snapshot);
+  msg->Push(Blob(uri.data(), uri.size()));
+  SendTo(actor::kServer, msg);
+
+  // wait for the tables to be frozen
+  mailbox_->Pop(msg);
+  CHECK(msg->type() == MsgType::Reply_Snapshot);
+}
+
 int Zoo::RegisterTable(WorkerTable* worker_table) {
   return dynamic_cast<Worker*>(zoo_[actor::kWorker])
     ->RegisterTable(worker_table);